@@ -51,11 +51,22 @@
 #include <wx/progdlg.h>
 #include <wx/xrc/xmlres.h>
 #include "clFilesCollector.h"
+#include "wxmd5.h"
+#include <map>
+#include <mutex>
 #include <thread>
+#include <wx/thread.h>
 
 static int ID_TOOL_SOURCE_CODE_FORMATTER = ::wxNewId();
 FormatOptions CodeFormatter::m_options;
 
+// the maximum number of files passed to a single clang-format process
+static const size_t MAX_FILES_PER_CLANG_FORMAT = 50;
+// keep the clang-format command line well below the Windows limit (32K)
+static const size_t MAX_CLANG_FORMAT_COMMAND_LENGTH = 8000;
+// AStyle keeps some of its state in globals, calls to AStyleMain must not overlap
+static std::mutex s_astyleMutex;
+
 extern "C" char* STDCALL AStyleMain(const char* pSourceIn, const char* pOptions,
                                     void(STDCALL* fpError)(int, const char*), char*(STDCALL* fpAlloc)(unsigned long));
 
@@ -101,6 +112,7 @@ CL_PLUGIN_API int GetPluginInterfaceVersion() { return PLUGIN_INTERFACE_VERSION;
 
 CodeFormatter::CodeFormatter(IManager* manager)
     : IPlugin(manager)
+    , m_batchCancelled(false)
 {
     m_longName = _("Source Code Formatter");
     m_shortName = _("Source Code Formatter");
@@ -445,6 +457,14 @@ void CodeFormatter::DoFormatWithClang(wxString& content, const wxFileName& fileN
 }
 
 void CodeFormatter::DoFormatWithAstyle(wxString& content, const bool& appendEOL)
+{
+    FormatWithAstyle(content, DoGetAstyleOptions());
+    if(content.IsEmpty() || !appendEOL) { return; }
+
+    content << DoGetGlobalEOLString();
+}
+
+wxString CodeFormatter::DoGetAstyleOptions() const
 {
     wxString options = m_options.AstyleOptionsAsString();
 
@@ -453,17 +473,23 @@ void CodeFormatter::DoFormatWithAstyle(wxString& content, const bool& appendEOL)
     int tabWidth = m_mgr->GetEditorSettings()->GetTabWidth();
     int indentWidth = m_mgr->GetEditorSettings()->GetIndentWidth();
     options << (useTabs && tabWidth == indentWidth ? wxT(" -t") : wxT(" -s")) << indentWidth;
+    return options;
+}
 
-    char* textOut = AStyleMain(_C(content), _C(options), ASErrorHandler, ASMemoryAlloc);
+bool CodeFormatter::FormatWithAstyle(wxString& content, const wxString& options)
+{
+    char* textOut = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(s_astyleMutex);
+        textOut = AStyleMain(_C(content), _C(options), ASErrorHandler, ASMemoryAlloc);
+    }
     content.clear();
     if(textOut) {
         content = _U(textOut);
         content.Trim();
         delete[] textOut;
     }
-    if(content.IsEmpty() || !appendEOL) { return; }
-
-    content << DoGetGlobalEOLString();
+    return !content.IsEmpty();
 }
 
 void CodeFormatter::DoFormatFileAsString(const wxFileName& fileName, const FormatterEngine& engine)
@@ -585,6 +611,7 @@ void CodeFormatter::UnPlug()
                                  this);
     EventNotifier::Get()->Unbind(wxEVT_PHP_SETTINGS_CHANGED, &CodeFormatter::OnPhpSettingsChanged, this);
     EventNotifier::Get()->Unbind(wxEVT_CONTEXT_MENU_FOLDER, &CodeFormatter::OnContextMenu, this);
+    DoStopBatch();
 }
 
 IManager* CodeFormatter::GetManager() { return m_mgr; }
@@ -638,13 +665,14 @@ wxString CodeFormatter::DoGetGlobalEOLString() const
 void CodeFormatter::OnFormatFile(clSourceFormatEvent& e)
 {
     wxFileName fn = e.GetFileName();
-    std::vector<wxFileName> filesToFormat;
     FormatterEngine engine = FindFormatter(fn);
-    if(engine != kFormatEngineNone) {
-        // TODO skip files based on size, 4.5MB as the default
-        filesToFormat.push_back(fn);
-    }
-    BatchFormat(filesToFormat, true);
+    if(engine == kFormatEngineNone) { return; }
+
+    // TODO skip files based on size, 4.5MB as the default
+    // The caller expects the file to be formatted once the event is processed, so don't use the batch here
+    wxString checksum = wxMD5::GetDigest(fn);
+    DoFormatFile(fn, engine);
+    if(wxMD5::GetDigest(fn) != checksum) { EventNotifier::Get()->PostReloadExternallyModifiedEvent(false); }
 }
 
 void CodeFormatter::OnFormatFiles(wxCommandEvent& event)
@@ -700,26 +728,264 @@ void CodeFormatter::BatchFormat(const std::vector<wxFileName>& files, bool silen
         return;
     }
 
-    wxProgressDialog* dlg = nullptr;
+    if(m_batchThread) {
+        if(!silent) { ::wxMessageBox(_("Source Code Formatter is already formatting files")); }
+        return;
+    }
+
     if(!silent) {
         wxString msg;
         msg << _("You are about to beautify ") << files.size() << _(" files\nContinue?");
         if(wxYES != ::wxMessageBox(msg, _("Source Code Formatter"), wxYES_NO | wxCANCEL | wxCENTER)) { return; }
 
-        dlg = new wxProgressDialog(_("Source Code Formatter"), _("Formatting files..."), (int)files.size(),
-                                   m_mgr->GetTheApp()->GetTopWindow());
+        m_batchProgress =
+            new wxProgressDialog(_("Source Code Formatter"), _("Formatting files..."), (int)files.size(),
+                                 m_mgr->GetTheApp()->GetTopWindow(), wxPD_APP_MODAL | wxPD_AUTO_HIDE | wxPD_CAN_ABORT);
     }
+
+    CodeFormatterBatch::Ptr_t batch(new CodeFormatterBatch());
+    DoPrepareBatch(batch, files);
+    OnBatchProgress(batch->processed.load());
+
+    m_batchCancelled.store(false);
+    m_batchThread = new std::thread(&CodeFormatter::DoRunBatch, this, batch);
+}
+
+wxString CodeFormatter::GetBatchChecksum(const wxString& checksum, const wxString& digest)
+{
+    return wxMD5::GetDigest(checksum + digest);
+}
+
+// Return the digest of the .clang-format file that applies to a given folder
+static wxString GetClangFormatFileDigest(const wxString& folder)
+{
+    wxFileName configFile(folder, ".clang-format");
+    while(configFile.GetDirCount()) {
+        if(configFile.FileExists()) { return wxMD5::GetDigest(configFile); }
+        configFile.RemoveLastDir();
+    }
+    return wxEmptyString;
+}
+
+void CodeFormatter::DoPrepareBatch(CodeFormatterBatch::Ptr_t batch, const std::vector<wxFileName>& files)
+{
+    batch->clangFormatExe = m_options.GetClangFormatExe();
+    batch->eol = DoGetGlobalEOLString();
+    batch->formattedFiles = m_formattedFiles;
+    wxString astyleOptions = DoGetAstyleOptions();
+
+    // The clang-format style depends only on the file folder and its extension
+    // so compute it once per folder/extension
+    std::unordered_map<wxString, std::pair<wxString, wxString> > clangStyles;
+    // Files sharing the same style are passed to the same clang-format process
+    std::map<wxString, std::vector<size_t> > clangGroups;
+
+    for(const wxFileName& fn : files) {
+        CodeFormatterBatch::File file;
+        file.path = fn.GetFullPath();
+        file.engine = FindFormatter(fn);
+
+        if(file.engine == kFormatEngineClangFormat) {
+            if(batch->clangFormatExe.IsEmpty()) {
+                clWARNING() << "CodeFormatter: Missing clang_format exec" << clEndl;
+                continue;
+            }
+            wxString key = fn.GetPath() + "/" + fn.GetExt();
+            auto iter = clangStyles.find(key);
+            if(iter == clangStyles.end()) {
+                wxString style = m_options.GetClangFormatStyleAsString(fn);
+                wxString digest = style;
+                if(style == "file") { digest << GetClangFormatFileDigest(fn.GetPath()); }
+                iter = clangStyles.insert({ key, { style, digest } }).first;
+            }
+            file.settings = iter->second.first;
+            file.digest = iter->second.second;
+            clangGroups[file.settings].push_back(batch->files.size());
+
+        } else if(file.engine == kFormatEngineAStyle) {
+            file.settings = astyleOptions;
+            file.digest = astyleOptions;
+
+        } else if(file.engine == kFormatEnginePhpCsFixer) {
+            if(!m_options.GetPhpFixerCommand(fn, file.settings)) { continue; }
+            file.digest = file.settings;
+
+        } else if(file.engine == kFormatEnginePhpcbf) {
+            if(!m_options.GetPhpcbfCommand(fn, file.settings)) { continue; }
+            file.digest = file.settings;
+
+        } else {
+            // The remaining formatters are not thread safe, format the file here
+            wxString checksum = wxMD5::GetDigest(fn);
+            DoFormatFile(fn, file.engine);
+            file.checksum = wxMD5::GetDigest(fn);
+            file.changed = (file.checksum != checksum);
+            batch->files.push_back(file);
+            batch->processed++;
+            continue;
+        }
+
+        if(file.engine != kFormatEngineClangFormat) {
+            CodeFormatterBatch::Job job;
+            job.engine = file.engine;
+            job.files.push_back(batch->files.size());
+            batch->jobs.push_back(job);
+        }
+        batch->files.push_back(file);
+    }
+
+    // Split the clang-format groups into jobs
+    for(const auto& vt : clangGroups) {
+        CodeFormatterBatch::Job job;
+        job.engine = kFormatEngineClangFormat;
+        size_t commandLength = batch->clangFormatExe.length() + vt.first.length();
+        for(size_t index : vt.second) {
+            const wxString& path = batch->files[index].path;
+            if(!job.files.empty() && (job.files.size() == MAX_FILES_PER_CLANG_FORMAT ||
+                                      (commandLength + path.length()) > MAX_CLANG_FORMAT_COMMAND_LENGTH)) {
+                batch->jobs.push_back(job);
+                job.files.clear();
+                commandLength = batch->clangFormatExe.length() + vt.first.length();
+            }
+            job.files.push_back(index);
+            commandLength += path.length() + 3;
+        }
+        if(!job.files.empty()) { batch->jobs.push_back(job); }
+    }
+}
+
+void CodeFormatter::DoRunBatch(CodeFormatterBatch::Ptr_t batch)
+{
+    std::atomic_size_t nextJob(0);
+    size_t workersCount = std::max(1, wxThread::GetCPUCount());
+    workersCount = std::min(workersCount, batch->jobs.size());
+
+    std::vector<std::thread> workers;
+    for(size_t i = 0; i < workersCount; ++i) {
+        workers.push_back(std::thread([&]() {
+            size_t jobIndex = nextJob++;
+            while(jobIndex < batch->jobs.size() && !m_batchCancelled.load()) {
+                DoRunBatchJob(batch, batch->jobs[jobIndex]);
+                CallAfter(&CodeFormatter::OnBatchProgress, batch->processed.load());
+                jobIndex = nextJob++;
+            }
+        }));
+    }
+    for(std::thread& worker : workers) {
+        worker.join();
+    }
+    CallAfter(&CodeFormatter::OnBatchCompleted, batch);
+}
+
+void CodeFormatter::DoRunBatchJob(CodeFormatterBatch::Ptr_t batch, const CodeFormatterBatch::Job& job)
+{
+    // Skip the files that were not modified since we last formatted them
+    std::vector<size_t> files;
+    std::vector<wxString> contents;
+    std::vector<wxString> checksums;
+    for(size_t index : job.files) {
+        CodeFormatterBatch::File& file = batch->files[index];
+        wxString content;
+        if(!FileUtils::ReadFileContent(file.path, content)) {
+            clWARNING() << "CodeFormatter: Failed to load file: " << file.path << clEndl;
+            continue;
+        }
+
+        wxString checksum = wxMD5::GetDigest(content);
+        auto iter = batch->formattedFiles.find(file.path);
+        if(iter != batch->formattedFiles.end() && iter->second == GetBatchChecksum(checksum, file.digest)) {
+            file.checksum = checksum;
+            continue;
+        }
+        files.push_back(index);
+        contents.push_back(content);
+        checksums.push_back(checksum);
+    }
+
+    if(job.engine == kFormatEngineClangFormat && !files.empty()) {
+        // All the files in the job share the same style
+        wxString command = batch->clangFormatExe;
+        ::WrapWithQuotes(command);
+        command << " -i -style=" << batch->files[files[0]].settings;
+        for(size_t index : files) {
+            wxString path = batch->files[index].path;
+            ::WrapWithQuotes(path);
+            command << " " << path;
+        }
+        RunCommand(command);
+
+    } else if(job.engine == kFormatEngineAStyle) {
+        for(size_t i = 0; i < files.size(); ++i) {
+            const CodeFormatterBatch::File& file = batch->files[files[i]];
+            wxString content = contents[i];
+            if(!FormatWithAstyle(content, file.settings)) { continue; }
+            content << batch->eol;
+            if(content == contents[i]) { continue; }
+            if(!FileUtils::WriteFileContent(file.path, content)) {
+                clWARNING() << "CodeFormatter: Failed to save file: " << file.path << clEndl;
+            }
+        }
+
+    } else if(job.engine == kFormatEnginePhpCsFixer || job.engine == kFormatEnginePhpcbf) {
+        for(size_t index : files) {
+            RunCommand(batch->files[index].settings);
+        }
+    }
+
     for(size_t i = 0; i < files.size(); ++i) {
-        wxString msg;
-        msg << "[ " << i << " / " << files.size() << " ] " << files.at(i).GetFullName();
-        if(dlg) { dlg->Update(i, msg); }
+        CodeFormatterBatch::File& file = batch->files[files[i]];
+        file.checksum = wxMD5::GetDigest(wxFileName(file.path));
+        file.changed = (file.checksum != checksums[i]);
+    }
+    batch->processed += job.files.size();
+}
 
-        FormatterEngine engine = FindFormatter(files.at(i).GetFullPath());
-        DoFormatFile(files.at(i).GetFullPath(), engine);
+void CodeFormatter::DoStopBatch()
+{
+    m_batchCancelled.store(true);
+    if(m_batchThread) {
+        m_batchThread->join();
+        wxDELETE(m_batchThread);
     }
+    if(m_batchProgress) {
+        m_batchProgress->Destroy();
+        m_batchProgress = nullptr;
+    }
+}
+
+void CodeFormatter::OnBatchProgress(size_t processed)
+{
+    if(!m_batchProgress) { return; }
+
+    int range = m_batchProgress->GetRange();
+    wxString msg;
+    msg << "[ " << processed << " / " << range << " ] " << _("Formatting files...");
+    if(!m_batchProgress->Update(std::min((int)processed, range), msg)) { m_batchCancelled.store(true); }
+}
+
+void CodeFormatter::OnBatchCompleted(CodeFormatterBatch::Ptr_t batch)
+{
+    bool cancelled = m_batchCancelled.load();
+    DoStopBatch();
+
+    size_t changedCount = 0;
+    bool reloadEditors = false;
+    for(const CodeFormatterBatch::File& file : batch->files) {
+        if(file.checksum.IsEmpty()) { continue; }
+        if(!file.digest.IsEmpty()) { m_formattedFiles[file.path] = GetBatchChecksum(file.checksum, file.digest); }
+        if(!file.changed) { continue; }
+        ++changedCount;
+        // Only editors that display a modified file need to be reloaded
+        if(m_mgr->FindEditor(file.path)) { reloadEditors = true; }
+    }
+
+    wxString msg;
+    msg << _("Code Formatter: ") << changedCount << _(" files modified");
+    if(cancelled) { msg << _(" (cancelled)"); }
+    m_mgr->SetStatusMessage(msg);
+    clDEBUG() << msg << clEndl;
 
-    if(dlg) { dlg->Destroy(); }
-    EventNotifier::Get()->PostReloadExternallyModifiedEvent(false);
+    if(reloadEditors) { EventNotifier::Get()->PostReloadExternallyModifiedEvent(false); }
 }
 
 void CodeFormatter::OnBeforeFileSave(clCommandEvent& e)
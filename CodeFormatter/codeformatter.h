@@ -29,6 +29,11 @@
 #include "fileextmanager.h"
 #include "formatoptions.h"
 #include "plugin.h"
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <wx/sharedptr.h>
 
 enum FormatterEngine {
     kFormatEngineNone,
@@ -40,10 +45,59 @@ enum FormatterEngine {
     kFormatEngineWxXmlDocument,
 };
 
+class wxProgressDialog;
+
+/**
+ * @class CodeFormatterBatch
+ * @brief the state of a batch formatting job. Everything that the workers need
+ * (commands, styles, options) is computed on the main thread before the job starts
+ */
+struct CodeFormatterBatch {
+    typedef wxSharedPtr<CodeFormatterBatch> Ptr_t;
+
+    struct File {
+        wxString path;
+        FormatterEngine engine = kFormatEngineNone;
+        // the formatter settings used for this file: clang-format style, astyle options or
+        // the command line of an external formatter
+        wxString settings;
+        // digest of everything that affects the formatting result (settings, .clang-format content etc)
+        // files with an empty digest are never skipped
+        wxString digest;
+        // checksum of the file once formatted, empty if the file was not processed
+        wxString checksum;
+        bool changed = false;
+    };
+
+    // a unit of work: a list of files formatted together
+    struct Job {
+        FormatterEngine engine = kFormatEngineNone;
+        std::vector<size_t> files;
+    };
+
+    std::vector<File> files;
+    std::vector<Job> jobs;
+    // checksums of files formatted by a previous batch (see CodeFormatter::m_formattedFiles)
+    std::unordered_map<wxString, wxString> formattedFiles;
+    wxString clangFormatExe;
+    wxString eol;
+    std::atomic_size_t processed;
+
+    CodeFormatterBatch()
+        : processed(0)
+    {
+    }
+};
+
 class CodeFormatter : public IPlugin
 {
     static FormatOptions m_options;
     PhpOptions m_optionsPhp;
+    std::thread* m_batchThread = nullptr;
+    std::atomic_bool m_batchCancelled;
+    wxProgressDialog* m_batchProgress = nullptr;
+    // file -> checksum of its content right after we formatted it (+ the settings used)
+    std::unordered_map<wxString, wxString> m_formattedFiles;
 
 protected:
     wxString m_selectedFolder;
@@ -74,8 +128,19 @@ private:
     void DoFormatWithClang(wxString& content, const wxFileName& fileName, int& cursorPosition,
                            const int& selStart = wxNOT_FOUND, const int& selEnd = wxNOT_FOUND);
     void DoFormatWithAstyle(wxString& content, const bool& appendEOL = true);
+    wxString DoGetAstyleOptions() const;
+    static bool FormatWithAstyle(wxString& content, const wxString& options);
     void DoFormatWithWxXmlDocument(const wxFileName& fileName);
 
+    // batch formatting
+    static wxString GetBatchChecksum(const wxString& checksum, const wxString& digest);
+    void DoPrepareBatch(CodeFormatterBatch::Ptr_t batch, const std::vector<wxFileName>& files);
+    void DoRunBatch(CodeFormatterBatch::Ptr_t batch);
+    void DoRunBatchJob(CodeFormatterBatch::Ptr_t batch, const CodeFormatterBatch::Job& job);
+    void DoStopBatch();
+    void OnBatchProgress(size_t processed);
+    void OnBatchCompleted(CodeFormatterBatch::Ptr_t batch);
+
     void OnPhpSettingsChanged(clCommandEvent& event);
     void OnScanFilesCompleted(const std::vector<wxFileName>& files);
 
@@ -83,7 +148,8 @@ public:
     wxString RunCommand(const wxString& command);
 
     /**
-     * @brief format list of files
+     * @brief format list of files. clang-format, AStyle and the external PHP formatters
+     * run on a pool of worker threads, the other formatters run on the main thread
      */
     void BatchFormat(const std::vector<wxFileName>& files, bool silent = true);
     void OnContextMenu(clContextMenuEvent& event);
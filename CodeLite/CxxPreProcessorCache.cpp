@@ -1,42 +1,107 @@
 #include "CxxPreProcessorCache.h"
 #include "CxxLexerAPI.h"
 #include "CxxScannerTokens.h"
+#include "file_logger.h"
+#include "fileutils.h"
+#include <algorithm>
+#include <wx/dir.h>
+#include <wx/ffile.h>
+#include <wx/tokenzr.h>
+#include <wx/utils.h>
 
-CxxPreProcessorCache::CxxPreProcessorCache() {}
+// Bump this whenever the format (or the way macros are collected) changes
+#define PP_CACHE_VERSION 3
+#define PP_CACHE_MAGIC "CLPP"
+// Maximum number of entries kept in memory and on disk
+#define PP_CACHE_MAX_ENTRIES 200
+
+namespace
+{
+// FNV-1a
+wxUint64 HashString(const wxString& str, wxUint64 hash = wxULL(14695981039346656037))
+{
+    const wxCharBuffer cb = str.mb_str(wxConvUTF8);
+    for(size_t i = 0; i < cb.length(); ++i) {
+        hash ^= (wxUint64)(unsigned char)cb.data()[i];
+        hash *= wxULL(1099511628211);
+    }
+    return hash;
+}
+
+struct PreProcessorCacheHeader {
+    char magic[4];
+    wxUint32 version;
+    wxUint32 filesCount;
+    wxUint32 searchPathsCount;
+    wxUint32 unresolvedCount;
+    wxUint32 length;
+};
+} // namespace
+
+CxxPreProcessorCache::CxxPreProcessorCache()
+    : m_hits(0)
+    , m_misses(0)
+{
+}
 
 CxxPreProcessorCache::~CxxPreProcessorCache() {}
 
-bool CxxPreProcessorCache::Find(const wxString& filename,
-                                const wxString& project,
-                                const wxString& config,
-                                wxArrayString& definitions)
+wxString CxxPreProcessorCache::GetKey(const wxString& filename, const wxArrayString& includePaths,
+                                      const wxArrayString& definitions) const
+{
+    // Relative include statements are resolved from the file's folder first, so it is part of the key
+    wxString str;
+    str << wxFileName(filename).GetPath() << "\n" << GetPreamble(filename) << "\n";
+    for(const wxString& path : includePaths) {
+        str << "-I" << path << "\n";
+    }
+    for(const wxString& def : definitions) {
+        str << "-D" << def << "\n";
+    }
+    return wxString::Format("%016llx", (unsigned long long)HashString(str));
+}
+
+bool CxxPreProcessorCache::IsValid(const CacheEntry& entry) const
+{
+    for(const auto& p : entry.files) {
+        if(FileUtils::GetFileModificationTime(p.first) != p.second) { return false; }
+    }
+
+    // An include statement that can be resolved now (e.g. a generated header) changes the closure
+    for(const wxString& includeName : entry.unresolved) {
+        for(const wxString& path : entry.searchPaths) {
+            if(wxFileName::FileExists(path + wxFileName::GetPathSeparator() + includeName)) { return false; }
+        }
+    }
+    return true;
+}
+
+bool CxxPreProcessorCache::Find(const wxString& key, wxArrayString& definitions)
 {
-    wxString key;
-    key << project << "|" << config << "|" << filename;
     CxxPreProcessorCache::Map_t::iterator iter = m_impl.find(key);
-    if(iter == m_impl.end()) return false;
-
-    if(wxFileName(filename).GetModificationTime().GetTicks() > iter->second.lastUpdated) {
-        // the file file was saved since we last cached it
-        // Next:
-        // Check if the cached entry preabmle is the same as the current file
-        wxString currentPreamble = GetPreamble(filename);
-        wxString cachedPreamble = iter->second.preamble;
-        if(cachedPreamble == currentPreamble) {
-            // no change was done to the preamble
+    if(iter != m_impl.end()) {
+        if(IsValid(iter->second)) {
+            ++m_hits;
             definitions = iter->second.definitions;
             return true;
-        } else {
-            // preamble was modified - we need to re-cache it
-            // remove the current cache and return false
-            m_impl.erase(iter);
-            return false;
         }
-    } else {
-        // the file was not saved since we cached it
-        definitions = iter->second.definitions;
+        // one of the included files was modified
+        m_impl.erase(iter);
+        ++m_misses;
         return false;
     }
+
+    // Try the disk
+    CacheEntry entry;
+    if(ReadEntry(key, entry) && IsValid(entry)) {
+        ++m_hits;
+        definitions = entry.definitions;
+        if(m_impl.size() >= PP_CACHE_MAX_ENTRIES) { m_impl.clear(); }
+        m_impl.insert(std::make_pair(key, entry));
+        return true;
+    }
+    ++m_misses;
+    return false;
 }
 
 void CxxPreProcessorCache::Clear() { m_impl.clear(); }
@@ -46,38 +111,188 @@ wxString CxxPreProcessorCache::GetPreamble(const wxString& filename) const
     Scanner_t scanner = ::LexerNew(filename, 0);
     if(!scanner) return { "" };
 
+    // Every preprocessor directive up to the last include statement: a #define or an #undef before an include
+    // changes what the included files define
     CxxLexerToken token;
     wxString preamble;
+    wxString line;
+    size_t preambleLength = 0;
+    bool isInclude = false;
+    bool isDirective = false;
+    auto AddLine = [&]() {
+        if(!line.IsEmpty()) {
+            preamble << line << "\n";
+            if(isInclude) { preambleLength = preamble.length(); }
+        }
+        line.clear();
+        isInclude = false;
+        isDirective = false;
+    };
+
     while(::LexerNext(scanner, token)) {
-        if(token.GetType() == T_PP_INCLUDE_FILENAME) {
-            preamble << token.GetText() << "\n";
+        int type = token.GetType();
+        if(type == T_PP_STATE_EXIT) {
+            AddLine();
+        } else if(type == T_PP_INCLUDE_FILENAME) {
+            line << "include " << token.GetText();
+            isInclude = true;
+            isDirective = true;
+        } else {
+            // The directive name comes first, the rest of the line is collected with it
+            if(type >= T_PP_DEFINE && type <= T_PP_LTEQ) { isDirective = true; }
+            if(isDirective) { line << token.GetText() << " "; }
         }
     }
+    AddLine();
     ::LexerDestroy(&scanner);
 
+    preamble.Truncate(preambleLength);
     preamble.Trim();
     return preamble;
 }
 
-bool CxxPreProcessorCache::Insert(const wxString& filename,
-                                  const wxString& project,
-                                  const wxString& config,
-                                  const wxArrayString& definitions)
+void CxxPreProcessorCache::Insert(const wxString& key, const wxArrayString& definitions, const wxString& filename,
+                                  const wxArrayString& includePaths, const std::map<wxString, wxString>& fileMapping)
 {
-    wxString key;
-    key << project << "|" << config << "|" << filename;
-
-    // remove old entry
-    CxxPreProcessorCache::Map_t::iterator iter = m_impl.find(key);
-    if(iter != m_impl.end()) m_impl.erase(iter);
-    
     CacheEntry entry;
-    entry.config = config;
     entry.definitions = definitions;
-    entry.lastUpdated = time(NULL); // Now
-    entry.filename = filename;
-    entry.project = project;
-    entry.preamble = GetPreamble(filename);
-    m_impl.insert(std::make_pair(key, entry));
+    wxStringSet_t searchPaths;
+    auto AddSearchPath = [&](const wxString& path) {
+        if(searchPaths.insert(path).second) { entry.searchPaths.Add(path); }
+    };
+    // Same order as CxxPreProcessor::ExpandInclude(): the including file's folder and then the include paths
+    AddSearchPath(wxFileName(filename).GetPath());
+    for(const auto& p : fileMapping) {
+        if(!p.second.IsEmpty()) { AddSearchPath(wxFileName(p.second).GetPath()); }
+    }
+    for(const wxString& path : includePaths) {
+        AddSearchPath(path);
+    }
+
+    for(const auto& p : fileMapping) {
+        // Include statements that could not be resolved are mapped to an empty string
+        if(p.second.IsEmpty()) {
+            wxString includeName = p.first;
+            includeName.Replace("\"", "");
+            includeName.Replace("<", "");
+            includeName.Replace(">", "");
+            entry.unresolved.Add(includeName);
+            continue;
+        }
+        entry.files.push_back(std::make_pair(p.second, FileUtils::GetFileModificationTime(p.second)));
+    }
+    // Without unresolved statements the search paths are not needed
+    if(entry.unresolved.IsEmpty()) { entry.searchPaths.Clear(); }
+
+    if(m_impl.size() >= PP_CACHE_MAX_ENTRIES) { m_impl.clear(); }
+    m_impl[key] = entry;
+    WriteEntry(key, entry);
+}
+
+wxFileName CxxPreProcessorCache::GetCacheFile(const wxString& key) const
+{
+    return wxFileName(m_cacheFolder, key + ".macros");
+}
+
+bool CxxPreProcessorCache::ReadEntry(const wxString& key, CacheEntry& entry) const
+{
+    if(m_cacheFolder.IsEmpty()) { return false; }
+    wxFileName cacheFile = GetCacheFile(key);
+    if(!cacheFile.FileExists()) { return false; }
+    wxFFile fp(cacheFile.GetFullPath(), "rb");
+    if(!fp.IsOpened()) { return false; }
+
+    PreProcessorCacheHeader header;
+    if(fp.Read(&header, sizeof(header)) != sizeof(header)) { return false; }
+    if(memcmp(header.magic, PP_CACHE_MAGIC, sizeof(header.magic)) != 0 || header.version != PP_CACHE_VERSION) {
+        return false;
+    }
+
+    // Don't trust the length read from the disk, it must match the rest of the file
+    wxFileOffset fileSize = fp.Length();
+    wxFileOffset headerSize = sizeof(header);
+    if(fileSize < headerSize || (wxFileOffset)header.length != (fileSize - headerSize)) { return false; }
+
+    wxCharBuffer cb(header.length);
+    if(fp.Read(cb.data(), header.length) != header.length) { return false; }
+    wxArrayString lines = ::wxStringTokenize(wxString(cb.data(), wxConvUTF8, header.length), "\n", wxTOKEN_STRTOK);
+    size_t headerLines = (size_t)header.filesCount + header.searchPathsCount + header.unresolvedCount;
+    if(lines.size() < headerLines) { return false; }
+
+    // The include closure comes first ("<modified>\t<path>"), followed by the search paths, the unresolved include
+    // statements and the definitions
+    size_t i = 0;
+    for(; i < header.filesCount; ++i) {
+        long long modified = 0;
+        if(!lines.Item(i).BeforeFirst('\t').ToLongLong(&modified)) { return false; }
+        entry.files.push_back(std::make_pair(lines.Item(i).AfterFirst('\t'), (time_t)modified));
+    }
+    entry.searchPaths.insert(entry.searchPaths.end(), lines.begin() + i, lines.begin() + i + header.searchPathsCount);
+    i += header.searchPathsCount;
+    entry.unresolved.insert(entry.unresolved.end(), lines.begin() + i, lines.begin() + i + header.unresolvedCount);
+    i += header.unresolvedCount;
+    entry.definitions.insert(entry.definitions.end(), lines.begin() + i, lines.end());
     return true;
 }
+
+void CxxPreProcessorCache::WriteEntry(const wxString& key, const CacheEntry& entry) const
+{
+    if(m_cacheFolder.IsEmpty()) { return; }
+
+    wxString content;
+    for(const auto& p : entry.files) {
+        content << wxString::Format("%lld", (long long)p.second) << "\t" << p.first << "\n";
+    }
+    for(const wxString& path : entry.searchPaths) {
+        content << path << "\n";
+    }
+    for(const wxString& includeName : entry.unresolved) {
+        content << includeName << "\n";
+    }
+    for(const wxString& def : entry.definitions) {
+        content << def << "\n";
+    }
+
+    const wxCharBuffer cb = content.mb_str(wxConvUTF8);
+    PreProcessorCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PP_CACHE_MAGIC, sizeof(header.magic));
+    header.version = PP_CACHE_VERSION;
+    header.filesCount = entry.files.size();
+    header.searchPathsCount = entry.searchPaths.size();
+    header.unresolvedCount = entry.unresolved.size();
+    header.length = cb.length();
+
+    // Write to a temporary file first so a concurrent CodeLite instance never reads a partial entry
+    wxFileName cacheFile = GetCacheFile(key);
+    wxString tmpfile = cacheFile.GetFullPath() + wxString::Format(".%lu", wxGetProcessId());
+    {
+        wxFFile fp(tmpfile, "wb");
+        if(!fp.IsOpened()) { return; }
+        if(fp.Write(&header, sizeof(header)) != sizeof(header) || fp.Write(cb.data(), cb.length()) != cb.length()) {
+            fp.Close();
+            ::wxRemoveFile(tmpfile);
+            return;
+        }
+    }
+    if(!::wxRenameFile(tmpfile, cacheFile.GetFullPath(), true)) { ::wxRemoveFile(tmpfile); }
+    PruneDiskCache();
+}
+
+void CxxPreProcessorCache::PruneDiskCache() const
+{
+    wxArrayString files;
+    wxDir::GetAllFiles(m_cacheFolder, &files, "*.macros", wxDIR_FILES);
+    if(files.size() <= PP_CACHE_MAX_ENTRIES) { return; }
+
+    // Remove the least recently written entries
+    std::vector<std::pair<time_t, wxString> > entries;
+    entries.reserve(files.size());
+    for(const wxString& file : files) {
+        entries.push_back(std::make_pair(FileUtils::GetFileModificationTime(file), file));
+    }
+    std::sort(entries.begin(), entries.end());
+    for(size_t i = 0; i < entries.size() - PP_CACHE_MAX_ENTRIES; ++i) {
+        ::wxRemoveFile(entries[i].second);
+    }
+}
@@ -27,26 +27,42 @@
 #define CXXPREPROCESSORCACHE_H
 
 #include "codelite_exports.h"
-#include <wx/arrstr.h>
+#include "wxStringHash.h"
 #include <map>
+#include <unordered_map>
+#include <vector>
+#include <wx/arrstr.h>
+#include <wx/filename.h>
 
+/**
+ * @class CxxPreProcessorCache
+ * @brief cache the macros collected from a file's include closure. Entries are keyed by the file preamble and the
+ * settings used to parse it, so files with identical preambles share the same entry. Entries are also kept on disk
+ * and are valid as long as none of the files in the include closure was modified
+ */
 class WXDLLIMPEXP_CL CxxPreProcessorCache
 {
     struct CacheEntry {
-        wxString filename;
-        wxString project;
-        wxString config;
-        wxString preamble;
         wxArrayString definitions;
-        time_t lastUpdated;
-        CacheEntry()
-            : lastUpdated(0)
-        {
-        }
+        // The include closure and the modification time of each file
+        std::vector<std::pair<wxString, time_t> > files;
+        // Include statements that could not be resolved and the folders where they were searched
+        wxArrayString unresolved;
+        wxArrayString searchPaths;
     };
 
-    typedef std::map<wxString, CacheEntry> Map_t;
+    typedef std::unordered_map<wxString, CacheEntry> Map_t;
     CxxPreProcessorCache::Map_t m_impl;
+    wxString m_cacheFolder;
+    size_t m_hits;
+    size_t m_misses;
+
+protected:
+    bool IsValid(const CacheEntry& entry) const;
+    wxFileName GetCacheFile(const wxString& key) const;
+    bool ReadEntry(const wxString& key, CacheEntry& entry) const;
+    void WriteEntry(const wxString& key, const CacheEntry& entry) const;
+    void PruneDiskCache() const;
 
 public:
     CxxPreProcessorCache();
@@ -54,26 +70,43 @@ public:
 
     /**
      * @brief return the preamble for a give file
-     * A Preamble of a file is a list of all include statements
-     * used in the file
+     * A Preamble of a file is the list of all preprocessor directives
+     * up to (and including) its last include statement
      */
     wxString GetPreamble(const wxString& filename) const;
 
     /**
-     * @brief clear the cache content
+     * @brief set the folder where the entries are persisted. An empty folder disables the disk cache
+     */
+    void SetCacheFolder(const wxString& cacheFolder) { this->m_cacheFolder = cacheFolder; }
+
+    /**
+     * @brief clear the cache content (in memory only)
      */
     void Clear();
 
     /**
-     * @brief locate Pre Processors for a given file in a specific configuraion and project
+     * @brief return the cache key for a file parsed with the given include paths and definitions
      */
-    bool Find(const wxString& filename, const wxString& project, const wxString& config, wxArrayString& definitions);
+    wxString GetKey(const wxString& filename, const wxArrayString& includePaths,
+                    const wxArrayString& definitions) const;
+
+    /**
+     * @brief locate the macros for a given key
+     */
+    bool Find(const wxString& key, wxArrayString& definitions);
 
     /**
      * @brief insert item to the cache
+     * @param filename the parsed file
+     * @param includePaths the include paths used while parsing
+     * @param fileMapping the include statements resolved while parsing, as returned by CxxPreProcessor
      */
-    bool
-    Insert(const wxString& filename, const wxString& project, const wxString& config, const wxArrayString& definitions);
+    void Insert(const wxString& key, const wxArrayString& definitions, const wxString& filename,
+                const wxArrayString& includePaths, const std::map<wxString, wxString>& fileMapping);
+
+    size_t GetHits() const { return m_hits; }
+    size_t GetMisses() const { return m_misses; }
 };
 
 #endif // CXXPREPROCESSORCACHE_H
@@ -9,9 +9,15 @@
 #include "fileextmanager.h"
 #include "fileutils.h"
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <thread>
 #include <wx/filename.h>
 #include <wx/log.h>
 #include <wx/stopwatch.h>
+#include <wx/thread.h>
 #include <wx/tokenzr.h>
 #include "clFilesCollector.h"
 
@@ -19,7 +25,7 @@ wxDEFINE_EVENT(wxPHP_PARSE_STARTED, clParseEvent);
 wxDEFINE_EVENT(wxPHP_PARSE_ENDED, clParseEvent);
 wxDEFINE_EVENT(wxPHP_PARSE_PROGRESS, clParseEvent);
 
-static wxString PHP_SCHEMA_VERSION = "9.3.0.1";
+static wxString PHP_SCHEMA_VERSION = "9.3.0.2";
 
 //------------------------------------------------
 // Metadata table
@@ -154,7 +160,8 @@ const static wxString CREATE_PHPDOC_VAR_TABLE_SQL_IDX2 =
 const static wxString CREATE_FILES_TABLE_SQL =
     "CREATE TABLE IF NOT EXISTS FILES_TABLE(ID INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT, "
     "FILE_NAME TEXT, "                        // for global variable or class member this will be the scope_id parent id
-    "LAST_UPDATED INTEGER NOT NULL DEFAULT 0" // for function argument
+    "LAST_UPDATED INTEGER NOT NULL DEFAULT 0, " // for function argument
+    "CONTENT_HASH TEXT"                         // hash of the file content when it was last parsed
     ")";
 const static wxString CREATE_FILES_TABLE_SQL_IDX1 =
     "CREATE UNIQUE INDEX IF NOT EXISTS FILES_TABLE_IDX_1 ON FILES_TABLE(FILE_NAME)";
@@ -816,7 +823,10 @@ void PHPLookupTable::Close()
     try {
         if(m_db.IsOpen()) { m_db.Close(); }
         m_filename.Clear();
-        m_allClasses.clear();
+        {
+            std::lock_guard<std::mutex> lock(m_allClassesMutex);
+            m_allClasses.clear();
+        }
 
     } catch(wxSQLite3Exception& e) {
         CL_WARNING("PHPLookupTable::Close: %s", e.GetMessage());
@@ -958,6 +968,44 @@ void PHPLookupTable::UpdateFileLastParsedTimestamp(const wxFileName& filename)
     }
 }
 
+void PHPLookupTable::LoadFilesContentHash(std::unordered_map<wxString, wxString>& hashes)
+{
+    try {
+        wxSQLite3ResultSet res =
+            m_db.ExecuteQuery("SELECT FILE_NAME, CONTENT_HASH FROM FILES_TABLE WHERE CONTENT_HASH IS NOT NULL");
+        while(res.NextRow()) {
+            hashes.insert({ res.GetString("FILE_NAME"), res.GetString("CONTENT_HASH") });
+        }
+    } catch(wxSQLite3Exception& e) {
+        CL_WARNING("PHPLookupTable::LoadFilesContentHash: %s", e.GetMessage());
+    }
+}
+
+void PHPLookupTable::UpdateFileContentHash(const wxFileName& filename, const wxString& contentHash)
+{
+    try {
+        wxSQLite3Statement st =
+            m_db.PrepareStatement("UPDATE FILES_TABLE SET CONTENT_HASH=:CONTENT_HASH WHERE FILE_NAME=:FILE_NAME");
+        st.Bind(st.GetParamIndex(":CONTENT_HASH"), contentHash);
+        st.Bind(st.GetParamIndex(":FILE_NAME"), filename.GetFullPath());
+        st.ExecuteUpdate();
+
+    } catch(wxSQLite3Exception& e) {
+        CL_WARNING("PHPLookupTable::UpdateFileContentHash: %s", e.GetMessage());
+    }
+}
+
+wxString PHPLookupTable::GetContentHash(const wxString& content)
+{
+    // FNV-1a. The content is read using wxConvISO8859_1 so each character is a single byte of the file
+    wxUint64 hash = wxULL(14695981039346656037);
+    for(wxString::const_iterator iter = content.begin(); iter != content.end(); ++iter) {
+        hash ^= (wxUint64)(wxUint32)(*iter).GetValue();
+        hash *= wxULL(1099511628211);
+    }
+    return wxString::Format("%016llx", (unsigned long long)hash);
+}
+
 void PHPLookupTable::ClearAll(bool autoCommit)
 {
     try {
@@ -1296,16 +1344,24 @@ void PHPLookupTable::DoFixVarsDocComment(PHPEntityBase::List_t& matches, wxLongL
 
 void PHPLookupTable::UpdateClassCache(const wxString& classname)
 {
+    std::lock_guard<std::mutex> lock(m_allClassesMutex);
     if(m_allClasses.count(classname) == 0) { m_allClasses.insert(classname); }
 }
 
-bool PHPLookupTable::ClassExists(const wxString& classname) const { return m_allClasses.count(classname) != 0; }
+bool PHPLookupTable::ClassExists(const wxString& classname) const
+{
+    std::lock_guard<std::mutex> lock(m_allClassesMutex);
+    return m_allClasses.count(classname) != 0;
+}
 
 void PHPLookupTable::RebuildClassCache()
 {
     // locate the scope
     clDEBUG() << "Rebuilding PHP class cache..." << clEndl;
-    m_allClasses.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_allClassesMutex);
+        m_allClasses.clear();
+    }
     size_t count = 0;
     try {
         wxString sql;
@@ -1424,3 +1480,292 @@ void PHPLookupTable::ParseFolder(const wxString& folder, const wxString& filemas
         }
     });
 }
+
+namespace
+{
+// Files parsed by a worker thread, waiting to be stored by the writer
+struct PHPParsedFilesBatch {
+    std::vector<std::pair<std::unique_ptr<PHPSourceFile>, wxString> > files; // the parsed file + its content hash
+    size_t processed = 0; // number of files handled by the worker (parsed or skipped)
+    wxString lastFile;
+};
+
+// A bounded queue between the parser threads and the writer
+class PHPParsedFilesQueue
+{
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<PHPParsedFilesBatch> m_batches;
+    size_t m_maxBatches;
+    size_t m_producers;
+    bool m_stopped = false;
+
+public:
+    PHPParsedFilesQueue(size_t producers, size_t maxBatches)
+        : m_maxBatches(maxBatches)
+        , m_producers(producers)
+    {
+    }
+
+    void Push(PHPParsedFilesBatch&& batch)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [&]() { return m_stopped || m_batches.size() < m_maxBatches; });
+        if(m_stopped) { return; }
+        m_batches.push_back(std::move(batch));
+        m_cv.notify_all();
+    }
+
+    void ProducerDone()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        --m_producers;
+        m_cv.notify_all();
+    }
+
+    /**
+     * @brief pop the next batch. Return false when all the producers are done and the queue is empty
+     */
+    bool Pop(PHPParsedFilesBatch& batch)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [&]() { return !m_batches.empty() || m_producers == 0; });
+        if(m_batches.empty()) { return false; }
+        batch = std::move(m_batches.front());
+        m_batches.pop_front();
+        m_cv.notify_all();
+        return true;
+    }
+
+    /**
+     * @brief discard the queued batches and release the blocked producers
+     */
+    void Stop()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopped = true;
+        m_batches.clear();
+        m_cv.notify_all();
+    }
+};
+
+const size_t PHP_PARSED_FILES_BATCH_SIZE = 50;
+const size_t PHP_FILES_PER_TRANSACTION = 2000;
+
+/**
+ * @brief collect the full names of the classes, interfaces and traits declared in a file, named the way
+ * PHPSourceFile names them (the namespace is taken from the first 'namespace' statement)
+ */
+void CollectClassNames(const wxString& content, std::unordered_set<wxString>& classes)
+{
+    PHPScanner_t scanner = ::phpLexerNew(content);
+    if(!scanner) { return; }
+
+    wxString ns = "\\";
+    bool nsFound = false;
+    phpLexerToken token;
+    while(::phpLexerNext(scanner, token)) {
+        if(token.type == kPHP_T_NAMESPACE && !nsFound) {
+            nsFound = true;
+            wxString path;
+            while(::phpLexerNext(scanner, token) && token.type != ';') {
+                if(path.IsEmpty() && token.type != kPHP_T_NS_SEPARATOR) { path << "\\"; }
+                path << token.Text();
+            }
+            ns = path;
+            if(!ns.EndsWith("\\")) { ns << "\\"; }
+
+        } else if(token.type == kPHP_T_CLASS || token.type == kPHP_T_INTERFACE || token.type == kPHP_T_TRAIT) {
+            // Skip "Foo::class" and anonymous classes
+            if(::phpLexerNext(scanner, token) && token.type == kPHP_T_IDENTIFIER) { classes.insert(ns + token.Text()); }
+        }
+    }
+    ::phpLexerDestroy(&scanner);
+}
+} // namespace
+
+void PHPLookupTable::DoRecreateSymbolsDatabase(const wxArrayString& files, eUpdateMode updateMode,
+                                               const std::function<bool()>& goingDown, bool parseFuncBodies)
+{
+    {
+        clParseEvent event(wxPHP_PARSE_STARTED);
+        event.SetTotalFiles(files.GetCount());
+        event.SetCurfileIndex(0);
+        EventNotifier::Get()->AddPendingEvent(event);
+    }
+
+    wxStopWatch sw;
+    sw.Start();
+
+    // In fast mode, only files whose content was changed since they were last parsed are parsed again
+    std::unordered_map<wxString, wxString> hashes;
+    if(updateMode == kUpdateMode_Fast) {
+        LoadFilesContentHash(hashes);
+        // The classes of the files that are not parsed again
+        RebuildClassCache();
+    } else {
+        std::lock_guard<std::mutex> lock(m_allClassesMutex);
+        m_allClasses.clear(); // clear the cache
+    }
+
+    size_t workersCount = std::max(1, wxThread::GetCPUCount());
+    std::atomic_bool stop(false);
+
+    // First pass: find the files that need to be parsed and collect the classes they declare. The parser resolves
+    // type hints with ClassExists(), so the class cache is completed before the parsing starts and does not change
+    // while the files are parsed. Otherwise the result would depend on the order in which the threads run
+    std::vector<wxString> contentHashes(files.GetCount()); // empty for files that are not parsed
+    {
+        std::atomic_size_t nextFile(0);
+        std::vector<std::unordered_set<wxString> > classes(workersCount);
+        auto scanner = [&](size_t worker) {
+            size_t index = nextFile++;
+            while(index < files.GetCount() && !stop.load()) {
+                // Parse only valid PHP files
+                wxFileName fnSourceFile(files.Item(index));
+                if(FileExtManager::GetType(fnSourceFile.GetFullName()) == FileExtManager::TypePhp &&
+                   fnSourceFile.Exists()) {
+                    wxString content;
+                    if(!FileUtils::ReadFileContent(fnSourceFile, content, wxConvISO8859_1)) {
+                        clWARNING() << "PHP: Failed to read file:" << fnSourceFile << "for parsing" << clEndl;
+                    } else {
+                        wxString contentHash = GetContentHash(content);
+                        auto iter = hashes.find(fnSourceFile.GetFullPath());
+                        if(iter == hashes.end() || iter->second != contentHash) {
+                            contentHashes[index] = contentHash;
+                            CollectClassNames(content, classes[worker]);
+                        }
+                    }
+                }
+                // Only the calling thread may check whether we are going down
+                if(worker == 0 && goingDown()) { stop.store(true); }
+                index = nextFile++;
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for(size_t i = 1; i < workersCount; ++i) {
+            workers.push_back(std::thread(scanner, i));
+        }
+        scanner(0);
+        for(std::thread& worker : workers) {
+            worker.join();
+        }
+
+        std::lock_guard<std::mutex> lock(m_allClassesMutex);
+        for(const std::unordered_set<wxString>& workerClasses : classes) {
+            m_allClasses.insert(workerClasses.begin(), workerClasses.end());
+        }
+    }
+
+    std::vector<size_t> filesToParse;
+    for(size_t i = 0; i < contentHashes.size(); ++i) {
+        if(!contentHashes[i].IsEmpty()) { filesToParse.push_back(i); }
+    }
+
+    // Second pass: the parsing is done by a pool of threads, while this thread is the only one writing to the
+    // database
+    PHPParsedFilesQueue queue(workersCount, workersCount * 2);
+    std::atomic_size_t nextFile(0);
+
+    std::vector<std::thread> workers;
+    for(size_t i = 0; i < workersCount && !stop.load(); ++i) {
+        workers.push_back(std::thread([&]() {
+            PHPParsedFilesBatch batch;
+            size_t index = nextFile++;
+            while(index < filesToParse.size() && !stop.load()) {
+                const wxString& file = files.Item(filesToParse[index]);
+                const wxString& contentHash = contentHashes[filesToParse[index]];
+                index = nextFile++;
+                batch.processed++;
+                batch.lastFile = file;
+
+                // For performance reaons, load the file into memory and then parse it
+                wxFileName fnSourceFile(file);
+                wxString content;
+                if(!FileUtils::ReadFileContent(fnSourceFile, content, wxConvISO8859_1)) {
+                    clWARNING() << "PHP: Failed to read file:" << fnSourceFile << "for parsing" << clEndl;
+                } else {
+                    std::unique_ptr<PHPSourceFile> sourceFile(new PHPSourceFile(content, this));
+                    sourceFile->SetFilename(fnSourceFile);
+                    sourceFile->SetParseFunctionBody(parseFuncBodies);
+                    sourceFile->Parse();
+                    batch.files.push_back({ std::move(sourceFile), contentHash });
+                }
+
+                if(batch.processed == PHP_PARSED_FILES_BATCH_SIZE) {
+                    queue.Push(std::move(batch));
+                    batch = PHPParsedFilesBatch();
+                }
+            }
+            if(batch.processed) { queue.Push(std::move(batch)); }
+            queue.ProducerDone();
+        }));
+    }
+    // Release the writer loop below if no worker was started
+    for(size_t i = workers.size(); i < workersCount; ++i) {
+        queue.ProducerDone();
+    }
+
+    // The files that did not need parsing are done already
+    size_t processed = files.GetCount() - filesToParse.size();
+    try {
+        m_db.Begin();
+        size_t uncommitted = 0;
+        PHPParsedFilesBatch batch;
+        while(queue.Pop(batch)) {
+            if(goingDown()) {
+                stop.store(true);
+                queue.Stop();
+                break;
+            }
+
+            for(auto& parsed : batch.files) {
+                UpdateSourceFile(*parsed.first, false);
+                UpdateFileContentHash(parsed.first->GetFilename(), parsed.second);
+            }
+
+            // Commit in large chunks so the symbols become available while the parsing continues
+            uncommitted += batch.files.size();
+            if(uncommitted >= PHP_FILES_PER_TRANSACTION) {
+                m_db.Commit();
+                m_db.Begin();
+                uncommitted = 0;
+            }
+
+            processed += batch.processed;
+            clParseEvent event(wxPHP_PARSE_PROGRESS);
+            event.SetTotalFiles(files.GetCount());
+            event.SetCurfileIndex(processed);
+            event.SetFileName(batch.lastFile);
+            EventNotifier::Get()->AddPendingEvent(event);
+        }
+        m_db.Commit();
+
+    } catch(wxSQLite3Exception& e) {
+        try {
+            m_db.Rollback();
+
+        } catch(...) {
+        }
+        clWARNING() << "PHPLookupTable::UpdateSourceFiles:" << e.GetMessage() << clEndl;
+    }
+
+    // Make sure that the workers are not blocked on a full queue
+    stop.store(true);
+    queue.Stop();
+    for(std::thread& worker : workers) {
+        worker.join();
+    }
+
+    long elapsedMs = sw.Time();
+    clDEBUG1() << _("PHP: parsed ") << files.GetCount() << " in " << elapsedMs << " milliseconds" << clEndl;
+
+    {
+        // always make sure that the end event is sent
+        clParseEvent event(wxPHP_PARSE_ENDED);
+        event.SetTotalFiles(files.GetCount());
+        event.SetCurfileIndex(files.GetCount());
+        EventNotifier::Get()->AddPendingEvent(event);
+    }
+}
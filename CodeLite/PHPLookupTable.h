@@ -36,7 +36,10 @@
 #include "fileutils.h"
 #include "smart_ptr.h"
 #include "wx/wxsqlite3.h"
+#include <functional>
+#include <mutex>
 #include <set>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 #include <wx/longlong.h>
@@ -65,6 +68,8 @@ class WXDLLIMPEXP_CL PHPLookupTable
     wxFileName m_filename;
     size_t m_sizeLimit;
     std::unordered_set<wxString> m_allClasses;
+    // the class cache is queried by the parser threads while the writer updates it
+    mutable std::mutex m_allClassesMutex;
 
 public:
     enum eLookupFlags {
@@ -151,6 +156,28 @@ private:
      */
     void UpdateFileLastParsedTimestamp(const wxFileName& filename);
 
+    /**
+     * @brief load the content hash of all the files stored in the database
+     */
+    void LoadFilesContentHash(std::unordered_map<wxString, wxString>& hashes);
+
+    /**
+     * @brief store the content hash of a parsed file
+     */
+    void UpdateFileContentHash(const wxFileName& filename, const wxString& contentHash);
+
+    /**
+     * @brief return a hash for a file content (as read by RecreateSymbolsDatabase)
+     */
+    static wxString GetContentHash(const wxString& content);
+
+    /**
+     * @brief parse the files on a pool of threads and store the results from the calling thread. The classes
+     * declared by the files are collected before the parsing starts, so the class cache is the same for all files
+     */
+    void DoRecreateSymbolsDatabase(const wxArrayString& files, eUpdateMode updateMode,
+                                   const std::function<bool()>& goingDown, bool parseFuncBodies);
+
     /**
      * @brief check the database disk image to see if it corrupted
      */
@@ -316,95 +343,7 @@ template <typename GoindDownFunc>
 void PHPLookupTable::RecreateSymbolsDatabase(const wxArrayString& files, eUpdateMode updateMode,
                                              GoindDownFunc pFuncGoingDown, bool parseFuncBodies)
 {
-    try {
-
-        {
-            clParseEvent event(wxPHP_PARSE_STARTED);
-            event.SetTotalFiles(files.GetCount());
-            event.SetCurfileIndex(0);
-            EventNotifier::Get()->AddPendingEvent(event);
-        }
-
-        wxStopWatch sw;
-        sw.Start();
-
-        m_allClasses.clear(); // clear the cache
-        m_db.Begin();
-        for(size_t i = 0; i < files.GetCount(); ++i) {
-            if(pFuncGoingDown()) { break; }
-            {
-                clParseEvent event(wxPHP_PARSE_PROGRESS);
-                event.SetTotalFiles(files.GetCount());
-                event.SetCurfileIndex(i);
-                event.SetFileName(files.Item(i));
-                EventNotifier::Get()->AddPendingEvent(event);
-            }
-
-            wxFileName fnFile(files.Item(i));
-            bool reParseNeeded(true);
-
-            if(updateMode == kUpdateMode_Fast) {
-                // Check to see if we need to re-parse this file
-                // and store it to the database
-
-                if(!fnFile.Exists()) {
-                    reParseNeeded = false;
-                } else {
-                    time_t lastModifiedOnDisk = fnFile.GetModificationTime().GetTicks();
-                    wxLongLong lastModifiedInDB = GetFileLastParsedTimestamp(fnFile);
-                    if(lastModifiedOnDisk <= lastModifiedInDB.ToLong()) { reParseNeeded = false; }
-                }
-            }
-
-            // Ensure that the file exists
-            if(!fnFile.Exists()) { reParseNeeded = false; }
-
-            // Parse only valid PHP files
-            if(FileExtManager::GetType(fnFile.GetFullName()) != FileExtManager::TypePhp) { reParseNeeded = false; }
-
-            if(reParseNeeded) {
-                // For performance reaons, load the file into memory and then parse it
-                wxFileName fnSourceFile(files.Item(i));
-                wxString content;
-                if(!FileUtils::ReadFileContent(fnSourceFile, content, wxConvISO8859_1)) {
-                    clWARNING() << "PHP: Failed to read file:" << fnSourceFile << "for parsing" << clEndl;
-                    continue;
-                }
-                PHPSourceFile sourceFile(content, this);
-                sourceFile.SetFilename(fnSourceFile);
-                sourceFile.SetParseFunctionBody(parseFuncBodies);
-                sourceFile.Parse();
-                UpdateSourceFile(sourceFile, false);
-            }
-        }
-        m_db.Commit();
-        long elapsedMs = sw.Time();
-        clDEBUG1() << _("PHP: parsed ") << files.GetCount() << " in " << elapsedMs << " milliseconds" << clEndl;
-
-        {
-            clParseEvent event(wxPHP_PARSE_ENDED);
-            event.SetTotalFiles(files.GetCount());
-            event.SetCurfileIndex(files.GetCount());
-            EventNotifier::Get()->AddPendingEvent(event);
-        }
-
-    } catch(wxSQLite3Exception& e) {
-        try {
-            m_db.Rollback();
-
-        } catch(...) {
-        }
-
-        {
-            // always make sure that the end event is sent
-            clParseEvent event(wxPHP_PARSE_ENDED);
-            event.SetTotalFiles(files.GetCount());
-            event.SetCurfileIndex(files.GetCount());
-            EventNotifier::Get()->AddPendingEvent(event);
-        }
-
-        clWARNING() << "PHPLookupTable::UpdateSourceFiles:" << e.GetMessage() << clEndl;
-    }
+    DoRecreateSymbolsDatabase(files, updateMode, pFuncGoingDown, parseFuncBodies);
 }
 
 #endif // PHPLOOKUPTABLE_H
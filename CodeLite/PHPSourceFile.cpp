@@ -1304,7 +1304,7 @@ void PHPSourceFile::OnConstant(const phpLexerToken& tok)
 
 phpLexerToken& PHPSourceFile::GetPreviousToken()
 {
-    static phpLexerToken NullToken;
+    static thread_local phpLexerToken NullToken;
     if(m_lookBackTokens.size() >= 2) {
         // The last token in the list is the current one. We want the previous one
         return m_lookBackTokens.at(m_lookBackTokens.size() - 2);
@@ -1357,19 +1357,8 @@ wxString PHPSourceFile::DoMakeIdentifierAbsolute(const wxString& type, bool exac
 {
     if(m_converter) { return m_converter->MakeIdentifierAbsolute(type); }
 
-    static std::unordered_set<std::string> phpKeywords;
-    if(phpKeywords.empty()) {
-        phpKeywords.insert("string");
-        phpKeywords.insert("array");
-        phpKeywords.insert("mixed");
-        phpKeywords.insert("bool");
-        phpKeywords.insert("integer");
-        phpKeywords.insert("boolean");
-        phpKeywords.insert("double");
-        phpKeywords.insert("float");
-        phpKeywords.insert("float");
-        phpKeywords.insert("void");
-    }
+    static const std::unordered_set<std::string> phpKeywords = { "string",  "array",  "mixed", "bool",
+                                                                 "integer", "boolean", "double", "float", "void" };
     wxString typeWithNS(type);
     typeWithNS.Trim().Trim(false);
 
@@ -1,20 +1,203 @@
 #include "clCxxFileCacheSymbols.h"
+#include "cl_standard_paths.h"
 #include "codelite_events.h"
 #include "ctags_manager.h"
 #include "event_notifier.h"
 #include "file_logger.h"
 #include "parse_thread.h"
 #include "worker_thread.h"
+#include "fileutils.h"
 #include <algorithm>
+#include <wx/dir.h>
+#include <wx/ffile.h>
 #include <wx/tokenzr.h>
 
 wxDEFINE_EVENT(wxEVT_CXX_SYMBOLS_CACHE_UPDATED, clCommandEvent);
 wxDEFINE_EVENT(wxEVT_CXX_SYMBOLS_CACHE_INVALIDATED, clCommandEvent);
 
+// Bump this whenever the ctags output format changes
+#define SYMBOLS_CACHE_VERSION 2
+#define SYMBOLS_CACHE_MAGIC "CLSC"
+// magic, version, content hash and length, little endian
+#define SYMBOLS_CACHE_HEADER_SIZE 20
+#define SYMBOLS_CACHE_MAX_TAGS 100000
+// Limits of the disk cache, checked every SYMBOLS_CACHE_PRUNE_INTERVAL writes
+#define SYMBOLS_CACHE_MAX_FILES 5000
+#define SYMBOLS_CACHE_MAX_BYTES (256 * 1024 * 1024)
+#define SYMBOLS_CACHE_PRUNE_INTERVAL 100
+
+namespace
+{
+// FNV-1a
+wxUint64 HashBytes(const char* data, size_t len, wxUint64 hash = wxULL(14695981039346656037))
+{
+    for(size_t i = 0; i < len; ++i) {
+        hash ^= (wxUint64)(unsigned char)data[i];
+        hash *= wxULL(1099511628211);
+    }
+    return hash;
+}
+
+wxUint64 HashString(const wxString& str, wxUint64 hash = wxULL(14695981039346656037))
+{
+    const wxCharBuffer cb = str.mb_str(wxConvUTF8);
+    return HashBytes(cb.data(), cb.length(), hash);
+}
+
+struct SymbolsCacheHeader {
+    char magic[4];
+    wxUint32 version;
+    wxUint64 contentHash;
+    wxUint32 length;
+};
+
+void EncodeHeader(const SymbolsCacheHeader& header, char* buffer)
+{
+    wxUint32 version = wxUINT32_SWAP_ON_BE(header.version);
+    wxUint64 contentHash = wxUINT64_SWAP_ON_BE(header.contentHash);
+    wxUint32 length = wxUINT32_SWAP_ON_BE(header.length);
+    memcpy(buffer, header.magic, 4);
+    memcpy(buffer + 4, &version, 4);
+    memcpy(buffer + 8, &contentHash, 8);
+    memcpy(buffer + 16, &length, 4);
+}
+
+void DecodeHeader(const char* buffer, SymbolsCacheHeader& header)
+{
+    memcpy(header.magic, buffer, 4);
+    memcpy(&header.version, buffer + 4, 4);
+    memcpy(&header.contentHash, buffer + 8, 8);
+    memcpy(&header.length, buffer + 16, 4);
+    header.version = wxUINT32_SWAP_ON_BE(header.version);
+    header.contentHash = wxUINT64_SWAP_ON_BE(header.contentHash);
+    header.length = wxUINT32_SWAP_ON_BE(header.length);
+}
+
+struct SourceToTagsRequest {
+    wxString filename;
+    wxString cacheFolder;
+    wxUint64 optionsHash = 0;
+};
+} // namespace
+
 class SourceToTagsThread : public wxThread
 {
     clCxxFileCacheSymbols* m_cache;
-    wxMessageQueue<wxString> m_queue;
+    wxMessageQueue<SourceToTagsRequest> m_queue;
+    size_t m_writesCount = 0;
+
+protected:
+    /**
+     * @brief hash the file content (and the parser options that affect the output)
+     */
+    bool GetContentHash(const SourceToTagsRequest& req, wxUint64& hash)
+    {
+        wxFFile fp(req.filename, "rb");
+        if(!fp.IsOpened()) { return false; }
+        wxFileOffset size = fp.Length();
+        if(size < 0) { return false; }
+
+        wxMemoryBuffer buffer;
+        size_t bytes = fp.Read(buffer.GetWriteBuf(size), size);
+        buffer.UngetWriteBuf(bytes);
+        hash = HashBytes((const char*)buffer.GetData(), buffer.GetDataLen(), req.optionsHash);
+        return true;
+    }
+
+    wxFileName GetCacheFile(const SourceToTagsRequest& req) const
+    {
+        wxString name;
+        name << wxString::Format("%016llx", (unsigned long long)HashString(req.filename)) << ".tags";
+        return wxFileName(req.cacheFolder, name);
+    }
+
+    bool ReadCache(const wxFileName& cacheFile, wxUint64 contentHash, wxString& strTags)
+    {
+        if(!cacheFile.FileExists()) { return false; }
+        wxFFile fp(cacheFile.GetFullPath(), "rb");
+        if(!fp.IsOpened()) { return false; }
+
+        char buffer[SYMBOLS_CACHE_HEADER_SIZE];
+        if(fp.Read(buffer, sizeof(buffer)) != sizeof(buffer)) { return false; }
+        SymbolsCacheHeader header;
+        DecodeHeader(buffer, header);
+        if(memcmp(header.magic, SYMBOLS_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+           header.version != SYMBOLS_CACHE_VERSION || header.contentHash != contentHash) {
+            return false;
+        }
+
+        // Don't trust the length read from the disk, it must match the rest of the file
+        wxFileOffset fileSize = fp.Length();
+        if(fileSize < SYMBOLS_CACHE_HEADER_SIZE ||
+           (wxFileOffset)header.length != (fileSize - SYMBOLS_CACHE_HEADER_SIZE)) {
+            return false;
+        }
+
+        wxCharBuffer cb(header.length);
+        if(fp.Read(cb.data(), header.length) != header.length) { return false; }
+        strTags = wxString(cb.data(), wxConvUTF8, header.length);
+        fp.Close();
+
+        // Entries are pruned by their modification time, keep the used ones
+        wxFileName(cacheFile).Touch();
+        return true;
+    }
+
+    /**
+     * @brief remove the least recently used entries once the cache exceeds its limits
+     */
+    void PruneCache(const wxString& cacheFolder)
+    {
+        wxArrayString files;
+        wxDir::GetAllFiles(cacheFolder, &files, "*.tags", wxDIR_FILES);
+
+        std::vector<std::pair<time_t, wxString> > entries;
+        entries.reserve(files.size());
+        wxULongLong totalSize = 0;
+        for(const wxString& file : files) {
+            wxULongLong size = wxFileName::GetSize(file);
+            if(size != wxInvalidSize) { totalSize += size; }
+            entries.push_back(std::make_pair(FileUtils::GetFileModificationTime(file), file));
+        }
+        if(entries.size() <= SYMBOLS_CACHE_MAX_FILES && totalSize <= SYMBOLS_CACHE_MAX_BYTES) { return; }
+
+        std::sort(entries.begin(), entries.end());
+        size_t count = entries.size();
+        for(size_t i = 0; i < entries.size(); ++i) {
+            if(count <= SYMBOLS_CACHE_MAX_FILES && totalSize <= SYMBOLS_CACHE_MAX_BYTES) { break; }
+            wxULongLong size = wxFileName::GetSize(entries[i].second);
+            if(::wxRemoveFile(entries[i].second)) {
+                if(size != wxInvalidSize) { totalSize -= size; }
+                --count;
+            }
+        }
+        clDEBUG() << "Symbols cache pruned:" << (entries.size() - count) << "entries removed" << clEndl;
+    }
+
+    void WriteCache(const wxFileName& cacheFile, wxUint64 contentHash, const wxString& strTags)
+    {
+        const wxCharBuffer cb = strTags.mb_str(wxConvUTF8);
+        SymbolsCacheHeader header;
+        memcpy(header.magic, SYMBOLS_CACHE_MAGIC, sizeof(header.magic));
+        header.version = SYMBOLS_CACHE_VERSION;
+        header.contentHash = contentHash;
+        header.length = cb.length();
+        char buffer[SYMBOLS_CACHE_HEADER_SIZE];
+        EncodeHeader(header, buffer);
+
+        // Write to a temporary file first so a concurrent CodeLite instance never reads a partial entry
+        wxString tmpfile = cacheFile.GetFullPath() + wxString::Format(".%lu", wxGetProcessId());
+        {
+            wxFFile fp(tmpfile, "wb");
+            if(!fp.IsOpened()) { return; }
+            if(fp.Write(buffer, sizeof(buffer)) != sizeof(buffer) || fp.Write(cb.data(), cb.length()) != cb.length()) {
+                fp.Close();
+                ::wxRemoveFile(tmpfile);
+                return;
+            }
+        }
+        if(!::wxRenameFile(tmpfile, cacheFile.GetFullPath(), true)) { ::wxRemoveFile(tmpfile); }
+    }
 
 public:
     SourceToTagsThread(clCxxFileCacheSymbols* cache)
@@ -46,26 +229,40 @@ public:
     virtual void* Entry()
     {
         while(true) {
-            wxString filename;
-            if(m_queue.ReceiveTimeout(50, filename) == wxMSGQUEUE_NO_ERROR) {
+            SourceToTagsRequest req;
+            if(m_queue.ReceiveTimeout(50, req) == wxMSGQUEUE_NO_ERROR) {
                 TagsOptionsData tod;
-                if(TagsManagerST::Get()->IsBinaryFile(filename, tod)) { continue; }
+                if(TagsManagerST::Get()->IsBinaryFile(req.filename, tod)) { continue; }
+
+                wxUint64 contentHash = 0;
+                bool hasHash = !req.cacheFolder.IsEmpty() && GetContentHash(req, contentHash);
+                wxFileName cacheFile = GetCacheFile(req);
 
                 wxString strTags;
-                TagsManagerST::Get()->SourceToTags(filename, strTags);
+                if(hasHash && ReadCache(cacheFile, contentHash, strTags)) {
+                    clDEBUG1() << "Symbols for file:" << req.filename << "loaded from the disk cache" << clEndl;
+                } else {
+                    TagsManagerST::Get()->SourceToTags(req.filename, strTags);
+                    if(hasHash) {
+                        WriteCache(cacheFile, contentHash, strTags);
+                        if((m_writesCount++ % SYMBOLS_CACHE_PRUNE_INTERVAL) == 0) { PruneCache(req.cacheFolder); }
+                    }
+                }
 
                 // Fire the event
-                m_cache->CallAfter(&clCxxFileCacheSymbols::OnPraseCompleted, filename, strTags);
+                m_cache->CallAfter(&clCxxFileCacheSymbols::OnPraseCompleted, req.filename, strTags);
             }
             if(TestDestroy()) break;
         }
         return NULL;
     }
 
-    void ParseFile(const wxString& filename) { m_queue.Post(filename); }
+    void ParseFile(const SourceToTagsRequest& req) { m_queue.Post(req); }
 };
 
 clCxxFileCacheSymbols::clCxxFileCacheSymbols()
+    : m_cachedTagsCount(0)
+    , m_maxCachedTags(SYMBOLS_CACHE_MAX_TAGS)
 {
     EventNotifier::Get()->Bind(wxEVT_FILE_SAVED, &clCxxFileCacheSymbols::OnFileSave, this);
     EventNotifier::Get()->Bind(wxEVT_WORKSPACE_CLOSED, &clCxxFileCacheSymbols::OnWorkspaceAction, this);
@@ -95,8 +292,11 @@ bool clCxxFileCacheSymbols::Contains(const wxString& filename) const
 
 void clCxxFileCacheSymbols::Clear()
 {
+    // Only the memory is cleared, the disk cache is validated against the file content
     // wxCriticalSectionLocker locker(m_cs);
     m_cache.clear();
+    m_lru.clear();
+    m_cachedTagsCount = 0;
     m_pendingFiles.clear();
     clDEBUG1() << "Symbols cache cleared" << clEndl;
 }
@@ -104,15 +304,52 @@ void clCxxFileCacheSymbols::Clear()
 void clCxxFileCacheSymbols::Update(const wxFileName& filename, const TagEntryPtrVector_t& tags)
 {
     // wxCriticalSectionLocker locker(m_cs);
-    if(m_cache.count(filename.GetFullPath())) { m_cache.erase(filename.GetFullPath()); }
-    m_cache[filename.GetFullPath()] = tags;
+    const wxString& fullpath = filename.GetFullPath();
+    auto iter = m_cache.find(fullpath);
+    if(iter != m_cache.end()) {
+        m_cachedTagsCount -= iter->second.tags.size();
+        m_lru.erase(iter->second.lruIter);
+        m_cache.erase(iter);
+    }
+
+    m_lru.push_front(fullpath);
+    CacheEntry& entry = m_cache[fullpath];
+    entry.tags = tags;
+    entry.lruIter = m_lru.begin();
+    m_cachedTagsCount += tags.size();
     clDEBUG1() << "Updating Symbols cache for file:" << filename << clEndl;
+    DoEvict();
+}
+
+void clCxxFileCacheSymbols::DoEvict()
+{
+    // Never evict the most recently used file, even if it alone exceeds the budget
+    while(m_cachedTagsCount > m_maxCachedTags && m_lru.size() > 1) {
+        auto iter = m_cache.find(m_lru.back());
+        if(iter != m_cache.end()) {
+            m_cachedTagsCount -= iter->second.tags.size();
+            clDEBUG1() << "Evicting symbols of file:" << iter->first << "from the memory cache" << clEndl;
+            m_cache.erase(iter);
+        }
+        m_lru.pop_back();
+    }
+}
+
+void clCxxFileCacheSymbols::SetMaxCachedTags(size_t maxCachedTags)
+{
+    m_maxCachedTags = maxCachedTags;
+    DoEvict();
 }
 
 void clCxxFileCacheSymbols::Delete(const wxFileName& filename)
 {
     // wxCriticalSectionLocker locker(m_cs);
-    m_cache.erase(filename.GetFullPath());
+    auto iter = m_cache.find(filename.GetFullPath());
+    if(iter != m_cache.end()) {
+        m_cachedTagsCount -= iter->second.tags.size();
+        m_lru.erase(iter->second.lruIter);
+        m_cache.erase(iter);
+    }
     clDEBUG1() << "Deleting Symbols cache for file:" << filename << clEndl;
 
     // Notify that the symbols for this file were invalidated
@@ -125,8 +362,11 @@ bool clCxxFileCacheSymbols::Find(const wxFileName& filename, TagEntryPtrVector_t
 {
     {
         // wxCriticalSectionLocker locker(m_cs);
-        if(m_cache.count(filename.GetFullPath())) {
-            tags = m_cache[filename.GetFullPath()];
+        auto iter = m_cache.find(filename.GetFullPath());
+        if(iter != m_cache.end()) {
+            tags = iter->second.tags;
+            // Mark this file as the most recently used one
+            m_lru.splice(m_lru.begin(), m_lru, iter->second.lruIter);
             clDEBUG1() << "Symbols fetched from cache for file:" << filename << clEndl;
         } else {
             clDEBUG1() << "Symbols for file:" << filename << "do not exist in the cache" << clEndl;
@@ -169,7 +409,22 @@ void clCxxFileCacheSymbols::RequestSymbols(const wxFileName& filename)
         return;
     }
 
-    m_helperThread->ParseFile(filename.GetFullPath());
+    // The options affect the parser output, so they are part of the disk cache key
+    const TagsOptionsData& options = TagsManagerST::Get()->GetCtagsOptions();
+    wxString optionsKey;
+    optionsKey << options.GetTokens() << "\n" << options.GetTypes() << "\n" << options.GetFlags();
+
+    SourceToTagsRequest req;
+    req.filename = filename.GetFullPath();
+    req.optionsHash = HashString(optionsKey);
+
+    wxFileName cacheFolder(clStandardPaths::Get().GetUserDataDir(), "");
+    cacheFolder.AppendDir("symbols-cache");
+    if(cacheFolder.DirExists() || cacheFolder.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL)) {
+        req.cacheFolder = cacheFolder.GetPath();
+    }
+
+    m_helperThread->ParseFile(req);
     m_pendingFiles.insert(filename.GetFullPath());
 }
 
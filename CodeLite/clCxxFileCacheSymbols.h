@@ -5,6 +5,7 @@
 #include "codelite_exports.h"
 #include "entry.h"
 #include "wxStringHash.h"
+#include <list>
 #include <vector>
 #include <wx/event.h>
 #include <wx/filename.h>
@@ -12,9 +13,22 @@
 #include <wx/thread.h>
 
 class SourceToTagsThread;
+/**
+ * @class clCxxFileCacheSymbols
+ * @brief per-file symbols cache used by the Outline, the navigation bar and the TagsManager.
+ * The parsed symbols are kept in memory (LRU, limited by the number of tags) while the raw ctags output
+ * is persisted to the disk keyed by the file content hash, so unchanged files are not re-parsed across sessions
+ */
 class WXDLLIMPEXP_CL clCxxFileCacheSymbols : public wxEvtHandler
 {
-    std::unordered_map<wxString, std::vector<TagEntryPtr> > m_cache;
+    struct CacheEntry {
+        TagEntryPtrVector_t tags;
+        std::list<wxString>::iterator lruIter;
+    };
+    std::unordered_map<wxString, CacheEntry> m_cache;
+    std::list<wxString> m_lru; // most recently used files first
+    size_t m_cachedTagsCount;
+    size_t m_maxCachedTags;
     std::unordered_set<wxString> m_pendingFiles;
     wxCriticalSection m_cs;
     SourceToTagsThread* m_helperThread;
@@ -22,6 +36,7 @@ class WXDLLIMPEXP_CL clCxxFileCacheSymbols : public wxEvtHandler
 protected:
     void OnFileSave(clCommandEvent& e);
     void OnWorkspaceAction(wxCommandEvent& e);
+    void DoEvict();
 
 public:
     void OnPraseCompleted(const wxString& filename, const wxString& strTags);
@@ -48,6 +63,13 @@ public:
      */
     bool Find(const wxFileName& filename, TagEntryPtrVector_t& tags, size_t flags = 0);
 
+    /**
+     * @brief set the maximum number of tags kept in memory. Least recently used files are evicted
+     * once this limit is exceeded (their symbols are still available from the disk cache)
+     */
+    void SetMaxCachedTags(size_t maxCachedTags);
+    size_t GetMaxCachedTags() const { return m_maxCachedTags; }
+
     /**
      * @brief Request parsing of a file from the parser thread. The results will be cached
      * and an event 'clCommandEvent' is fired to notify that the cache was updated
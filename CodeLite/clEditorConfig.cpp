@@ -3,6 +3,34 @@
 #include "fileutils.h"
 #include "file_logger.h"
 #include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include "wxStringHash.h"
+
+namespace
+{
+struct clEditorConfigFileCache {
+    time_t lastModified;
+    bool rootFileFound;
+    clEditorConfigSection::Vec_t sections;
+};
+
+struct clEditorConfigFolderCache {
+    wxString editorConfigFile; // empty when there is none
+    // The folders that were searched without finding a .editorconfig file and their modification time. Adding a
+    // file to one of them changes its modification time
+    std::vector<std::pair<wxString, time_t> > folders;
+};
+
+// Forget all the folders lookups once we have this many, rather than growing without bounds
+#define EDITORCONFIG_MAX_CACHED_FOLDERS 5000
+
+std::mutex m_cacheLock;
+// folder => the .editorconfig file that applies to it
+std::unordered_map<wxString, clEditorConfigFolderCache> m_foldersCache;
+// .editorconfig file => its parsed content
+std::unordered_map<wxString, clEditorConfigFileCache> m_filesCache;
+} // namespace
 
 clEditorConfig::clEditorConfig()
     : m_rootFileFound(false)
@@ -11,20 +39,93 @@ clEditorConfig::clEditorConfig()
 
 clEditorConfig::~clEditorConfig() {}
 
-bool clEditorConfig::LoadForFile(const wxFileName& filename, wxFileName& editorConfigFile)
+void clEditorConfig::ClearCache()
 {
-    editorConfigFile = wxFileName(filename.GetPath(), ".editorconfig");
+    std::lock_guard<std::mutex> locker(m_cacheLock);
+    m_foldersCache.clear();
+    m_filesCache.clear();
+}
+
+bool clEditorConfig::FindEditorConfigFile(const wxString& folder, wxFileName& editorConfigFile)
+{
+    clEditorConfigFolderCache cached;
+    bool isCached = false;
+    {
+        std::lock_guard<std::mutex> locker(m_cacheLock);
+        std::unordered_map<wxString, clEditorConfigFolderCache>::const_iterator iter = m_foldersCache.find(folder);
+        if(iter != m_foldersCache.end()) {
+            cached = iter->second;
+            isCached = true;
+        }
+    }
+
+    if(isCached) {
+        // The cached answer holds as long as no .editorconfig file was added to the folders we searched. A removed
+        // or modified .editorconfig file is detected by LoadForFile()
+        bool upToDate = true;
+        for(size_t i = 0; i < cached.folders.size() && upToDate; ++i) {
+            upToDate = (FileUtils::GetFileModificationTime(cached.folders[i].first) == cached.folders[i].second);
+        }
+        if(upToDate) {
+            if(cached.editorConfigFile.IsEmpty()) { return false; }
+            editorConfigFile = cached.editorConfigFile;
+            return true;
+        }
+    }
 
+    // Walk up the tree. All the folders we pass through use the same file
+    editorConfigFile = wxFileName(folder, ".editorconfig");
+    std::vector<std::pair<wxString, time_t> > visited;
     bool foundFile = false;
     while(editorConfigFile.GetDirCount()) {
+        // Take the folder modification time before looking for the file, so a file created meanwhile is noticed
+        wxString path = editorConfigFile.GetPath();
+        time_t lastModified = FileUtils::GetFileModificationTime(path);
         if(editorConfigFile.FileExists()) {
             foundFile = true;
             break;
         }
+        visited.push_back({ path, lastModified });
         editorConfigFile.RemoveLastDir();
     }
 
-    if(!foundFile) return false;
+    clEditorConfigFolderCache entry;
+    entry.editorConfigFile = foundFile ? editorConfigFile.GetFullPath() : wxString();
+    std::lock_guard<std::mutex> locker(m_cacheLock);
+    if(m_foldersCache.size() + visited.size() + 1 > EDITORCONFIG_MAX_CACHED_FOLDERS) { m_foldersCache.clear(); }
+    // Each folder we passed through depends on itself and on the folders above it
+    for(size_t i = 0; i < visited.size(); ++i) {
+        entry.folders.assign(visited.begin() + i, visited.end());
+        m_foldersCache[visited[i].first] = entry;
+    }
+    entry.folders = visited;
+    m_foldersCache[folder] = entry;
+    return foundFile;
+}
+
+bool clEditorConfig::LoadForFile(const wxFileName& filename, wxFileName& editorConfigFile)
+{
+    if(!FindEditorConfigFile(filename.GetPath(), editorConfigFile)) return false;
+
+    time_t lastModified = FileUtils::GetFileModificationTime(editorConfigFile);
+    if(lastModified == 0) {
+        // The file was removed since we looked for it, look again
+        ClearCache();
+        if(!FindEditorConfigFile(filename.GetPath(), editorConfigFile)) return false;
+        lastModified = FileUtils::GetFileModificationTime(editorConfigFile);
+    }
+
+    wxString key = editorConfigFile.GetFullPath();
+    {
+        std::lock_guard<std::mutex> locker(m_cacheLock);
+        std::unordered_map<wxString, clEditorConfigFileCache>::const_iterator iter = m_filesCache.find(key);
+        if(iter != m_filesCache.end() && iter->second.lastModified == lastModified) {
+            m_sections.insert(m_sections.end(), iter->second.sections.begin(), iter->second.sections.end());
+            if(iter->second.rootFileFound) { m_rootFileFound = true; }
+            clDEBUG1() << "Using .editorconfig file:" << editorConfigFile << clEndl;
+            return true;
+        }
+    }
 
     wxString content;
     if(!FileUtils::ReadFileContent(editorConfigFile, content)) {
@@ -32,6 +133,10 @@ bool clEditorConfig::LoadForFile(const wxFileName& filename, wxFileName& editorC
         return false;
     }
 
+    size_t firstSection = m_sections.size();
+    bool rootFileFound = m_rootFileFound;
+    m_rootFileFound = false;
+
     clEditorConfigSection section;
     m_sections.push_back(section);
     clEditorConfigSection* cursection = &(m_sections.back());
@@ -59,6 +164,17 @@ bool clEditorConfig::LoadForFile(const wxFileName& filename, wxFileName& editorC
             ProcessDirective(strLine);
         }
     }
+
+    // Keep the parsed sections for the next files using this .editorconfig
+    clEditorConfigFileCache entry;
+    entry.lastModified = lastModified;
+    entry.rootFileFound = m_rootFileFound;
+    entry.sections.insert(entry.sections.end(), m_sections.begin() + firstSection, m_sections.end());
+    m_rootFileFound = m_rootFileFound || rootFileFound;
+    {
+        std::lock_guard<std::mutex> locker(m_cacheLock);
+        m_filesCache[key] = entry;
+    }
     clDEBUG1() << "Using .editorconfig file:" << editorConfigFile << clEndl;
     return true;
 }
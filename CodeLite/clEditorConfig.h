@@ -127,6 +127,12 @@ private:
     void ProcessDirective(wxString& strLine);
     bool ReadUntil(wxChar delim, wxString& strLine, wxString& output);
 
+    /**
+     * @brief find the .editorconfig file that applies to the files in 'folder'. The result is cached per folder
+     * and checked against the modification time of the folders that were searched
+     */
+    static bool FindEditorConfigFile(const wxString& folder, wxFileName& editorConfigFile);
+
 public:
     clEditorConfig();
     ~clEditorConfig();
@@ -141,6 +147,12 @@ public:
      * @brief find the best section for a file
      */
     bool GetSectionForFile(const wxFileName& filename, clEditorConfigSection& section);
+
+    /**
+     * @brief clear the cached folders lookups and parsed files. Added, removed and modified .editorconfig files are
+     * detected automatically (by modification time), this is only needed to force a reload
+     */
+    static void ClearCache();
 };
 
 #endif // CLEDITOR_CONFIG_H
@@ -65,6 +65,18 @@ size_t clFilesScanner::Scan(const wxString& rootFolder, std::vector<wxString>& f
                             const wxString& excludeFilespec, const wxStringSet_t& excludeFolders)
 {
     filesOutput.clear();
+    return Scan(rootFolder,
+                [&](const wxString& fullpath) {
+                    filesOutput.push_back(fullpath);
+                    return true;
+                },
+                filespec, excludeFilespec, excludeFolders);
+}
+
+size_t clFilesScanner::Scan(const wxString& rootFolder, const std::function<bool(const wxString&)>& onFile,
+                            const wxString& filespec, const wxString& excludeFilespec,
+                            const wxStringSet_t& excludeFolders)
+{
     if(!wxFileName::DirExists(rootFolder)) {
         clDEBUG() << "clFilesScanner: No such dir:" << rootFolder << clEndl;
         return 0;
@@ -72,6 +84,7 @@ size_t clFilesScanner::Scan(const wxString& rootFolder, std::vector<wxString>& f
 
     wxArrayString specArr = ::wxStringTokenize(filespec.Lower(), ";,|", wxTOKEN_STRTOK);
     wxArrayString excludeSpecArr = ::wxStringTokenize(excludeFilespec.Lower(), ";,|", wxTOKEN_STRTOK);
+    size_t count = 0;
     std::queue<wxString> Q;
     Q.push(rootFolder);
 
@@ -104,12 +117,13 @@ size_t clFilesScanner::Scan(const wxString& rootFolder, std::vector<wxString>& f
                 // Do nothing
             } else if(!isDirectory && FileUtils::WildMatch(specArr, filename)) {
                 // Include this file
-                filesOutput.push_back(fullpath);
+                ++count;
+                if(!onFile(fullpath)) { return count; }
             }
             cont = dir.GetNext(&filename);
         }
     }
-    return filesOutput.size();
+    return count;
 }
 
 size_t clFilesScanner::ScanNoRecurse(const wxString& rootFolder, clFilesScanner::EntryData::Vec_t& results,
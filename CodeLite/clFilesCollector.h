@@ -3,6 +3,7 @@
 
 #include "codelite_exports.h"
 #include "macros.h"
+#include <functional>
 #include <vector>
 #include <wx/string.h>
 #include <wx/filename.h>
@@ -38,6 +39,15 @@ public:
      */
     size_t Scan(const wxString& rootFolder, std::vector<wxString>& filesOutput, const wxString& filespec = "*",
                 const wxString& excludeFilespec = "", const wxStringSet_t& excludeFolders = wxStringSet_t());
+    /**
+     * @brief same as above, but instead of collecting the files, pass each file to "onFile" as soon as it is found.
+     * This allows the caller to process the files while the scan is still in progress
+     * @param onFile callback called for every matching file. Return false to stop the scan
+     * @return number of files found
+     */
+    size_t Scan(const wxString& rootFolder, const std::function<bool(const wxString&)>& onFile,
+                const wxString& filespec = "*", const wxString& excludeFilespec = "",
+                const wxStringSet_t& excludeFolders = wxStringSet_t());
     /**
      * @brief same as above, but accepts the ignore directories list in a spec format
      */
@@ -57,6 +57,7 @@ public:
 #define kConfigLLDBTooltipW "LLDBTooltipW"
 #define kConfigLLDBTooltipH "LLDBTooltipH"
 #define kConfigBuildAutoScroll "build-auto-scroll"
+#define kConfigBuildParallelProjects "build-parallel-projects"
 #define kConfigCreateVirtualFoldersOnDisk "CreateVirtualFoldersOnDisk"
 #define kConfigLogVerbosity "LogVerbosity"
 #define kConfigRedirectLogOutput "RedirectLogOutput"
@@ -29,7 +29,7 @@
 #include <wx/filename.h>
 #include <wx/regex.h>
 #include <wx/xml/xml.h>
-#include <wx/thread.h>
+#include <mutex>
 
 struct Matcher {
     SmartPtr<wxRegEx> m_regex;
@@ -56,18 +56,29 @@ struct Matcher {
     }
 };
 
+// Content detection results
+struct ContentTypeEntry {
+    time_t lastModified;
+    bool detected;
+    FileExtManager::FileType fileType;
+};
+
+// Bound the number of cached content detection results
+#define CONTENT_TYPE_CACHE_MAX_SIZE 5000
+
+// m_map and m_matchers are filled once by Init() and are read-only afterwards, so the extension lookup does not need
+// any lock
 static std::unordered_map<wxString, FileExtManager::FileType> m_map;
 static std::vector<Matcher> m_matchers;
-static wxCriticalSection m_CS;
+static std::once_flag m_initOnce;
+// wxRegEx keeps the last match state, the matchers can not be used by multiple threads at once
+static std::mutex m_matchersLock;
+static std::unordered_map<wxString, ContentTypeEntry> m_contentTypeCache;
+static std::mutex m_contentTypeCacheLock;
 
 void FileExtManager::Init()
 {
-    wxCriticalSectionLocker locker(m_CS);
-
-    // per thread initialization
-    static bool init_done(false);
-    if(!init_done) {
-        init_done = true;
+    std::call_once(m_initOnce, []() {
         m_map[wxT("cc")] = TypeSourceCpp;
         m_map[wxT("cpp")] = TypeSourceCpp;
         m_map[wxT("cxx")] = TypeSourceCpp;
@@ -198,27 +209,40 @@ void FileExtManager::Init()
 
         // #include <
         m_matchers.push_back(Matcher("#include[ \t]+[\\<\"]", TypeSourceCpp));
+    });
+}
+
+void FileExtManager::SplitFileName(const wxString& filename, wxString& fullname, wxString& ext)
+{
+    size_t sepPos = filename.find_last_of(wxFileName::GetPathSeparators());
+    fullname = (sepPos == wxString::npos) ? filename : filename.Mid(sepPos + 1);
+
+    // Like wxFileName, a leading dot is part of the name and not an extension separator
+    size_t dotPos = fullname.rfind('.');
+    if(dotPos == wxString::npos || dotPos == 0) {
+        ext.clear();
+    } else {
+        ext = fullname.Mid(dotPos + 1);
     }
 }
 
 FileExtManager::FileType FileExtManager::GetType(const wxString& filename, FileExtManager::FileType defaultType)
 {
     Init();
-    wxCriticalSectionLocker locker(m_CS);
-
-    wxFileName fn(filename);
-    if(fn.IsOk() == false) { return defaultType; }
+    if(filename.IsEmpty()) { return defaultType; }
 
-    wxString e(fn.GetExt());
+    // This is called in tight loops, avoid building a wxFileName
+    wxString fullname, e;
+    SplitFileName(filename, fullname, e);
     e.MakeLower();
     e.Trim().Trim(false);
 
-    std::unordered_map<wxString, FileType>::iterator iter = m_map.find(e);
+    std::unordered_map<wxString, FileType>::const_iterator iter = m_map.find(e);
     if(iter == m_map.end()) {
         // try to see if the file is a makefile
-        if(fn.GetFullName().CmpNoCase(wxT("makefile")) == 0) {
+        if(fullname.CmpNoCase(wxT("makefile")) == 0) {
             return TypeMakefile;
-        } else if(fn.GetFullName().Lower() == "dockerfile") {
+        } else if(fullname.CmpNoCase("dockerfile") == 0) {
             return TypeDockerfile;
         } else {
             // try auto detecting
@@ -226,12 +250,13 @@ FileExtManager::FileType FileExtManager::GetType(const wxString& filename, FileE
             if(AutoDetectByContent(filename, autoDetectType)) { return autoDetectType; }
         }
         return defaultType;
-    } else if((iter->second == TypeText) && (fn.GetFullName().CmpNoCase("CMakeLists.txt") == 0)) {
+    } else if((iter->second == TypeText) && (fullname.CmpNoCase("CMakeLists.txt") == 0)) {
         return TypeCMake;
     }
 
     FileExtManager::FileType type = iter->second;
-    if(fn.Exists() && (type == TypeWorkspace)) {
+    if((type == TypeWorkspace) && wxFileName::FileExists(filename)) {
+        wxFileName fn(filename);
         wxString content;
         if(FileUtils::ReadFileContent(fn, content)) {
             if(content.Contains("<CodeLite_Workspace")) {
@@ -260,7 +285,6 @@ FileExtManager::FileType FileExtManager::GetType(const wxString& filename, FileE
 
 bool FileExtManager::IsCxxFile(const wxString& filename)
 {
-    wxCriticalSectionLocker locker(m_CS);
     FileType ft = GetType(filename);
     if(ft == TypeOther) {
         // failed to detect the type
@@ -271,22 +295,50 @@ bool FileExtManager::IsCxxFile(const wxString& filename)
 
 bool FileExtManager::AutoDetectByContent(const wxString& filename, FileExtManager::FileType& fileType)
 {
-    wxCriticalSectionLocker locker(m_CS);
+    Init();
+
+    // Reading the file and running the matchers is expensive, reuse the last result as long as the file did not
+    // change
+    time_t lastModified = FileUtils::GetFileModificationTime(filename);
+    {
+        std::lock_guard<std::mutex> locker(m_contentTypeCacheLock);
+        std::unordered_map<wxString, ContentTypeEntry>::const_iterator iter = m_contentTypeCache.find(filename);
+        if(iter != m_contentTypeCache.end() && iter->second.lastModified == lastModified) {
+            if(iter->second.detected) { fileType = iter->second.fileType; }
+            return iter->second.detected;
+        }
+    }
+
+    ContentTypeEntry entry;
+    entry.lastModified = lastModified;
+    entry.detected = false;
+    entry.fileType = TypeOther;
+
     wxString fileContent;
     if(!FileUtils::ReadBufferFromFile(filename, fileContent, 4096)) { return false; }
-
-    for(size_t i = 0; i < m_matchers.size(); ++i) {
-        if(m_matchers[i].Matches(fileContent)) {
-            fileType = m_matchers[i].m_fileType;
-            return true;
+    {
+        std::lock_guard<std::mutex> locker(m_matchersLock);
+        for(size_t i = 0; i < m_matchers.size(); ++i) {
+            if(m_matchers[i].Matches(fileContent)) {
+                entry.fileType = m_matchers[i].m_fileType;
+                entry.detected = true;
+                break;
+            }
         }
     }
-    return false;
+
+    {
+        std::lock_guard<std::mutex> locker(m_contentTypeCacheLock);
+        if(m_contentTypeCache.size() >= CONTENT_TYPE_CACHE_MAX_SIZE) { m_contentTypeCache.clear(); }
+        m_contentTypeCache[filename] = entry;
+    }
+
+    if(entry.detected) { fileType = entry.fileType; }
+    return entry.detected;
 }
 
 bool FileExtManager::IsFileType(const wxString& filename, FileExtManager::FileType type)
 {
-    wxCriticalSectionLocker locker(m_CS);
     FileType ft = GetType(filename);
     if(ft == TypeOther) {
         // failed to detect the type
@@ -303,8 +355,8 @@ bool FileExtManager::IsJavaFile(const wxString& filename) { return FileExtManage
 
 FileExtManager::FileType FileExtManager::GetTypeFromExtension(const wxFileName& filename)
 {
-    wxCriticalSectionLocker locker(m_CS);
-    std::unordered_map<wxString, FileExtManager::FileType>::iterator iter = m_map.find(filename.GetExt().Lower());
+    Init();
+    std::unordered_map<wxString, FileExtManager::FileType>::const_iterator iter = m_map.find(filename.GetExt().Lower());
     if(iter == m_map.end()) return TypeOther;
     return iter->second;
 }
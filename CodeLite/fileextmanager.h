@@ -97,6 +97,13 @@ public:
         TypeLast,
     };
 
+protected:
+    /**
+     * @brief split 'filename' into its name+extension part and its extension. Unlike wxFileName, no allocation is made
+     * for the path components
+     */
+    static void SplitFileName(const wxString& filename, wxString& fullname, wxString& ext);
+
 public:
     static FileType GetType(const wxString& filename, FileExtManager::FileType defaultType = FileExtManager::TypeOther);
     static void Init();
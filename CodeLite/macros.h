@@ -94,6 +94,7 @@
 #define BUILD_START_MSG "----------Build Started--------\n"
 #define BUILD_END_MSG "----------Build Ended----------\n"
 #define BUILD_PROJECT_PREFIX "----------Building project:[ "
+#define BUILD_PROJECT_END_PREFIX "----------Finished project:[ "
 #define CLEAN_PROJECT_PREFIX "----------Cleaning project:[ "
 
 // Find in files options
@@ -30,6 +30,13 @@
 #include "fileextmanager.h"
 #include "event_notifier.h"
 #include "search_thread.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <wx/thread.h>
 #if wxUSE_GUI
 #include <wx/progdlg.h>
 #include <wx/sizer.h>
@@ -39,6 +46,107 @@
 wxDEFINE_EVENT(wxEVT_REFACTOR_ENGINE_REFERENCES, clRefactoringEvent);
 wxDEFINE_EVENT(wxEVT_REFACTOR_ENGINE_RENAME_SYMBOL, clRefactoringEvent);
 
+// How many files can be scanned ahead of the file that is being resolved, per worker
+#define REFACTOR_SCAN_AHEAD_PER_WORKER 4
+
+namespace
+{
+// The candidates found in a single file
+struct FileTokens {
+    wxString filename;
+    // A unique copy of the file name for the worker thread, created by the main thread
+    wxString scanFilename;
+    CppToken::Vec_t tokens;
+    TextStatesPtr states;
+    bool ready = false;
+};
+
+// Build the files state tables on worker threads, ahead of the main thread that resolves the tokens.
+// CppWordScanner does not touch any global state, unlike the resolving itself which uses the tags database
+// and the expression parsers and must remain on the main thread
+class FileStatesScanner
+{
+    std::vector<FileTokens>& m_files;
+    std::vector<std::thread> m_workers;
+    std::mutex m_lock;
+    std::condition_variable m_cv;
+    size_t m_nextFile = 0;
+    size_t m_released = 0;
+    size_t m_scanAhead = 0;
+    bool m_stop = false;
+
+    void Run()
+    {
+        while(true) {
+            size_t index = 0;
+            {
+                std::unique_lock<std::mutex> locker(m_lock);
+                m_cv.wait(locker, [&]() {
+                    return m_stop || m_nextFile >= m_files.size() || m_nextFile < (m_released + m_scanAhead);
+                });
+                if(m_stop || m_nextFile >= m_files.size()) { return; }
+                index = m_nextFile++;
+            }
+
+            // SmartPtr reference counting is not thread safe: make sure that the only reference left when the file
+            // is published is the one kept in m_files
+            m_files[index].states = CppWordScanner(m_files[index].scanFilename).states();
+            {
+                std::lock_guard<std::mutex> locker(m_lock);
+                m_files[index].ready = true;
+            }
+            m_cv.notify_all();
+        }
+    }
+
+public:
+    FileStatesScanner(std::vector<FileTokens>& files)
+        : m_files(files)
+    {
+        size_t workersCount = std::max(1, wxThread::GetCPUCount());
+        workersCount = std::min(workersCount, m_files.size());
+        m_scanAhead = workersCount * REFACTOR_SCAN_AHEAD_PER_WORKER;
+        for(size_t i = 0; i < workersCount; ++i) {
+            m_workers.push_back(std::thread(&FileStatesScanner::Run, this));
+        }
+    }
+
+    ~FileStatesScanner()
+    {
+        {
+            std::lock_guard<std::mutex> locker(m_lock);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        for(std::thread& worker : m_workers) {
+            worker.join();
+        }
+    }
+
+    /**
+     * @brief wait up to timeoutMs for the file at 'index' to be scanned. Return true if it is ready
+     */
+    bool WaitForFile(size_t index, int timeoutMs)
+    {
+        std::unique_lock<std::mutex> locker(m_lock);
+        return m_cv.wait_for(locker, std::chrono::milliseconds(timeoutMs), [&]() { return m_files[index].ready; });
+    }
+
+    /**
+     * @brief the main thread is done with the file at 'index', free its states and let the workers move on
+     */
+    void Release(size_t index)
+    {
+        m_files[index].states.Reset(NULL);
+        {
+            std::lock_guard<std::mutex> locker(m_lock);
+            m_released = index + 1;
+        }
+        m_cv.notify_all();
+    }
+};
+} // namespace
+
 RefactoringEngine::RefactoringEngine()
 {
     Bind(wxEVT_SEARCH_THREAD_MATCHFOUND, &RefactoringEngine::OnSearchMatch, this);
@@ -445,69 +553,92 @@ void RefactoringEngine::DoCompleteFindReferences()
 {
     ScopeCleaner cleaner; // ensure that DoCleanup is called when leave this scope
 
-    // Load all tokens, first we need to parse the workspace files...
+    // Group the tokens by file, keeping the order in which the files were searched. Each file is scanned only once
     CppToken::Vec_t tokens = std::move(m_tokens);
+    size_t tokensCount = tokens.size();
+    std::vector<FileTokens> files;
+    std::unordered_map<wxString, size_t> filesIndex;
+    for(CppToken& token : tokens) {
+        auto where = filesIndex.find(token.getFilename());
+        if(where == filesIndex.end()) {
+            where = filesIndex.insert({ token.getFilename(), files.size() }).first;
+            files.push_back(FileTokens());
+            files.back().filename = token.getFilename();
+            // use c_str() to make sure we create a unique copy
+            files.back().scanFilename = token.getFilename().c_str();
+        }
+        files[where->second].tokens.push_back(std::move(token));
+    }
+    tokens.clear();
 
     RefactorSource target;
     int counter(0);
 
-    TextStatesPtr statesPtr(NULL);
-    wxString statesPtrFileName;
 #if wxUSE_GUI
-    clProgressDlg* prgDlg = CreateProgressDialog(_("Parsing matches..."), (int)tokens.size());
+    clProgressDlg* prgDlg = CreateProgressDialog(_("Parsing matches..."), (int)tokensCount);
 #endif
-    for(CppToken& token : tokens) {
-        wxFileName f(token.getFilename());
+    // Return false if the user clicked 'Cancel'
+    auto UpdateProgress = [&](const wxFileName& f) {
 #if wxUSE_GUI
         wxString msg;
-        msg << _("Parsing expression ") << counter << wxT("/") << tokens.size() << _(" in file: ") << f.GetFullName();
+        msg << _("Parsing expression ") << counter << wxT("/") << tokensCount << _(" in file: ") << f.GetFullName()
+            << wxT("\n") << m_candidates.size() << _(" matches found");
         if(!prgDlg->Update(counter, msg)) {
-            // user clicked 'Cancel'
             Clear();
             prgDlg->Destroy();
-            return;
+            return false;
         }
 #endif
-        counter++;
-        // reset the result
-        target.Reset();
-
-        if(!statesPtr || statesPtrFileName != token.getFilename()) {
-            // Create new statesPtr
-            CppWordScanner sc(token.getFilename());
-            statesPtr = sc.states();
-            statesPtrFileName = token.getFilename();
+        return true;
+    };
+
+    FileStatesScanner scanner(files);
+    for(size_t i = 0; i < files.size(); ++i) {
+        FileTokens& fileTokens = files[i];
+        wxFileName f(fileTokens.filename);
+
+        // Keep the UI responsive while the file is being scanned
+        while(!scanner.WaitForFile(i, 100)) {
+            if(!UpdateProgress(f)) { return; }
         }
 
-        if(!statesPtr) continue;
+        TextStatesPtr statesPtr = fileTokens.states;
+        for(CppToken& token : fileTokens.tokens) {
+            if(!UpdateProgress(f)) { return; }
+            counter++;
+            if(!statesPtr) continue;
 
-        if(DoResolveWord(statesPtr, wxFileName(token.getFilename()), token.getOffset(), token.getLineNumber(),
-                         m_symbolName, &target)) {
+            // reset the result
+            target.Reset();
+            if(DoResolveWord(statesPtr, f, token.getOffset(), token.getLineNumber(), m_symbolName, &target)) {
 
-            // set the line number
-            if(statesPtr->states.size() > token.getOffset())
-                token.setLineNumber(statesPtr->states[token.getOffset()].lineNo);
+                // set the line number
+                if(statesPtr->states.size() > token.getOffset())
+                    token.setLineNumber(statesPtr->states[token.getOffset()].lineNo);
 
-            if(target.name == m_refactorSource.name && target.scope == m_refactorSource.scope) {
-                // full match
-                m_candidates.push_back(token);
+                if(target.name == m_refactorSource.name && target.scope == m_refactorSource.scope) {
+                    // full match
+                    m_candidates.push_back(token);
 
-            } else if(target.name == m_refactorSource.scope && !m_refactorSource.isClass) {
-                // source is function, and target is class
-                m_candidates.push_back(token);
+                } else if(target.name == m_refactorSource.scope && !m_refactorSource.isClass) {
+                    // source is function, and target is class
+                    m_candidates.push_back(token);
 
-            } else if(target.name == m_refactorSource.name && m_refactorSource.isClass) {
-                // source is class, and target is ctor
-                m_candidates.push_back(token);
+                } else if(target.name == m_refactorSource.name && m_refactorSource.isClass) {
+                    // source is class, and target is ctor
+                    m_candidates.push_back(token);
 
+                } else if(!m_onlyDefiniteMatches) {
+                    // add it to the possible match list
+                    m_possibleCandidates.push_back(token);
+                }
             } else if(!m_onlyDefiniteMatches) {
-                // add it to the possible match list
+                // resolved word failed, add it to the possible list
                 m_possibleCandidates.push_back(token);
             }
-        } else if(!m_onlyDefiniteMatches) {
-            // resolved word failed, add it to the possible list
-            m_possibleCandidates.push_back(token);
         }
+        statesPtr.Reset(NULL);
+        scanner.Release(i);
     }
 #if wxUSE_GUI
     prgDlg->Destroy();
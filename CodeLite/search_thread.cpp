@@ -30,8 +30,10 @@
 #include "search_thread.h"
 #include "wx/event.h"
 #include <algorithm>
+#include <condition_variable>
 #include <iostream>
-#include <set>
+#include <mutex>
+#include <thread>
 #include <wx/dir.h>
 #if wxUSE_GUI
 #include <wx/fontmap.h>
@@ -50,6 +52,13 @@ wxDEFINE_EVENT(wxEVT_SEARCH_THREAD_SEARCHEND, wxCommandEvent);
 wxDEFINE_EVENT(wxEVT_SEARCH_THREAD_SEARCHCANCELED, wxCommandEvent);
 wxDEFINE_EVENT(wxEVT_SEARCH_THREAD_SEARCHSTARTED, wxCommandEvent);
 
+// Maximum number of files waiting to be searched while the enumeration is ahead of the search
+#define SEARCH_FILES_QUEUE_SIZE 1000
+// After the first batch, results are delivered at most every SEARCH_RESULTS_INTERVAL ms...
+#define SEARCH_RESULTS_INTERVAL 100
+// ... unless that many results are already waiting
+#define SEARCH_RESULTS_BATCH_SIZE 1000
+
 #define SEND_ST_EVENT()                       \
     if(owner) {                               \
         wxPostEvent(owner, event);            \
@@ -87,6 +96,84 @@ SearchData& SearchData::Copy(const SearchData& other)
     return *this;
 }
 
+//----------------------------------------------------------------
+// SearchFilesQueue
+//----------------------------------------------------------------
+
+namespace
+{
+/**
+ * @brief a bounded queue between the files enumeration (producer) and the search (consumer)
+ */
+class SearchFilesQueue
+{
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<wxString> m_files;
+    bool m_done = false;
+    bool m_stopped = false;
+
+public:
+    /**
+     * @brief add a file to the queue. Blocks while the queue is full
+     * @return false if the consumer is no longer interested in files
+     */
+    bool Push(const wxString& file)
+    {
+        std::unique_lock<std::mutex> lk(m_mutex);
+        m_cv.wait(lk, [&] { return m_stopped || m_files.size() < SEARCH_FILES_QUEUE_SIZE; });
+        if(m_stopped) { return false; }
+        // deep copy, the string is passed between threads
+        m_files.push_back(file.c_str());
+        m_cv.notify_all();
+        return true;
+    }
+
+    /**
+     * @brief the producer has no more files to add
+     */
+    void SetDone()
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_done = true;
+        m_cv.notify_all();
+    }
+
+    /**
+     * @brief the consumer stopped, release the producer
+     */
+    void Stop()
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_stopped = true;
+        m_files.clear();
+        m_cv.notify_all();
+    }
+
+    /**
+     * @brief get the next file to search. Waits for the producer if the queue is empty
+     * @param onWait called (without the queue lock) every 50ms while waiting, returns true to cancel
+     * @return false when there are no more files or when the search was cancelled
+     */
+    bool Pop(wxString& file, const std::function<bool()>& onWait)
+    {
+        std::unique_lock<std::mutex> lk(m_mutex);
+        while(m_files.empty() && !m_done) {
+            m_cv.wait_for(lk, std::chrono::milliseconds(50));
+            lk.unlock();
+            bool cancelled = onWait();
+            lk.lock();
+            if(cancelled) { return false; }
+        }
+        if(m_files.empty()) { return false; }
+        file = m_files.front();
+        m_files.pop_front();
+        m_cv.notify_all();
+        return true;
+    }
+};
+} // namespace
+
 //----------------------------------------------------------------
 // SearchThread
 //----------------------------------------------------------------
@@ -94,6 +181,7 @@ SearchData& SearchData::Copy(const SearchData& other)
 SearchThread::SearchThread()
     : WorkerThread()
     , m_wordChars(wxT("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_"))
+    , m_stopSearch(false)
     , m_reExpr(wxT(""))
 {
     IndexWordChars();
@@ -138,10 +226,10 @@ void SearchThread::PerformSearch(const SearchData& data) { Add(new SearchData(da
 
 void SearchThread::ProcessRequest(ThreadRequest* req)
 {
-    wxStopWatch sw;
+    m_searchTime.Start();
     m_summary = SearchSummary();
     DoSearchFiles(req);
-    m_summary.SetElapsedTime(sw.Time());
+    m_summary.SetElapsedTime(m_searchTime.Time());
 
     SearchData* sd = (SearchData*)req;
     m_summary.SetFindWhat(sd->GetFindString());
@@ -151,31 +239,36 @@ void SearchThread::ProcessRequest(ThreadRequest* req)
     SendEvent(wxEVT_SEARCH_THREAD_SEARCHEND, sd->GetOwner());
 }
 
-void SearchThread::GetFiles(const SearchData* data, wxArrayString& files)
+void SearchThread::GetFiles(const SearchData* data, const std::function<bool(const wxString&)>& onFile)
 {
     wxStringSet_t scannedFiles;
+    const wxArrayString& excludePatterns = data->GetExcludePatterns();
+    const wxString& mask = data->GetExtensions();
 
-    const wxArrayString& rootDirs = data->GetRootDirs();
-    files = data->GetFiles();
+    bool cont = true;
+    auto addFile = [&](const wxString& filename) -> bool {
+        if(TestStopSearch()) {
+            cont = false;
+        } else if(scannedFiles.insert(filename).second && FileUtils::WildMatch(mask, filename) &&
+                  !FileUtils::WildMatch(excludePatterns, filename)) {
+            cont = onFile(filename);
+        }
+        return cont;
+    };
 
-    // Populate "scannedFiles" with list of files to scan
-    scannedFiles.insert(files.begin(), files.end());
+    // The explicit files are known in advance, search them in order
+    wxArrayString files = data->GetFiles();
+    files.Sort([](const wxString& f1, const wxString& f2) -> int { return f1.CmpNoCase(f2); });
+    for(size_t i = 0; i < files.size() && cont; ++i) {
+        addFile(files.Item(i));
+    }
 
-    for(size_t i = 0; i < rootDirs.size(); ++i) {
-        // make sure it's really a dir (not a fifo, etc.)
+    // Folders are searched while they are being scanned
+    const wxArrayString& rootDirs = data->GetRootDirs();
+    for(size_t i = 0; i < rootDirs.size() && cont; ++i) {
         clFilesScanner scanner;
-        std::vector<wxString> filesV;
-        if(scanner.Scan(rootDirs.Item(i), filesV, data->GetExtensions())) {
-            std::for_each(filesV.begin(), filesV.end(), [&](const wxString& file) { scannedFiles.insert(file); });
-        }
+        scanner.Scan(rootDirs.Item(i), addFile, data->GetExtensions());
     }
-
-    files.clear();
-    files.Alloc(scannedFiles.size());
-    std::for_each(scannedFiles.begin(), scannedFiles.end(), [&](const wxString& file) { files.Add(file); });
-
-    // Filter all non matching files
-    FilterFiles(files, data);
 }
 
 void SearchThread::DoSearchFiles(ThreadRequest* req)
@@ -189,10 +282,7 @@ void SearchThread::DoSearchFiles(ThreadRequest* req)
     }
 
     StopSearch(false);
-    wxArrayString fileList;
-    GetFiles(data, fileList);
-
-    wxStopWatch sw;
+    m_findWhat = SearchResult::MakeShared(data->GetFindString());
 
     // Send startup message to main thread
     if(m_notifiedWindow || data->GetOwner()) {
@@ -206,35 +296,38 @@ void SearchThread::DoSearchFiles(ThreadRequest* req)
         }
     }
 
-    for(size_t i = 0; i < fileList.Count(); i++) {
-        m_summary.SetNumFileScanned((int)i + 1);
+    // Enumerate the files on a separate thread and start searching as soon as the first file is found
+    SearchFilesQueue queue;
+    std::thread producer([&]() {
+        GetFiles(data, [&](const wxString& file) { return queue.Push(file); });
+        queue.SetDone();
+    });
 
-        // give user chance to cancel the search ...
-        if(TestStopSearch()) {
-            // Send cancel event
-            SendEvent(wxEVT_SEARCH_THREAD_SEARCHCANCELED, data->GetOwner());
-            StopSearch(false);
-            break;
-        }
-        DoSearchFile(fileList.Item(i), data);
+    wxString fileName;
+    int filesCount = 0;
+    // While waiting for files, deliver the matches that are already found
+    auto onWait = [&]() {
+        FlushResults(data->GetOwner());
+        return TestStopSearch();
+    };
+    while(!TestStopSearch() && queue.Pop(fileName, onWait)) {
+        m_summary.SetNumFileScanned(++filesCount);
+        DoSearchFile(fileName, data);
     }
-}
-
-bool SearchThread::TestStopSearch()
-{
-    bool stop = false;
-    {
-        wxCriticalSectionLocker locker(m_cs);
-        stop = m_stopSearch;
+    queue.Stop();
+    producer.join();
+
+    // give user chance to cancel the search ...
+    if(TestStopSearch()) {
+        // Send cancel event
+        SendEvent(wxEVT_SEARCH_THREAD_SEARCHCANCELED, data->GetOwner());
+        StopSearch(false);
     }
-    return stop;
 }
 
-void SearchThread::StopSearch(bool stop)
-{
-    wxCriticalSectionLocker locker(m_cs);
-    m_stopSearch = stop;
-}
+bool SearchThread::TestStopSearch() { return m_stopSearch.load(); }
+
+void SearchThread::StopSearch(bool stop) { m_stopSearch.store(stop); }
 
 void SearchThread::DoSearchFile(const wxString& fileName, const SearchData* data)
 {
@@ -244,6 +337,7 @@ void SearchThread::DoSearchFile(const wxString& fileName, const SearchData* data
 
     size_t size = FileUtils::GetFileSize(fileName);
     if(size == 0) { return; }
+    m_fileName = SearchResult::MakeShared(fileName);
     wxString fileData;
     fileData.Alloc(size);
 
@@ -286,12 +380,13 @@ void SearchThread::DoSearchFile(const wxString& fileName, const SearchData* data
     int lineOffset = 0;
     if(data->IsRegularExpression()) {
         // regular expression search
-        while(tkz.HasMoreTokens()) {
+        while(tkz.HasMoreTokens() && !TestStopSearch()) {
             // Read the next line
             wxString line = tkz.NextToken();
             DoSearchLineRE(line, lineNumber, lineOffset, fileName, data, states);
             lineOffset += line.Length() + 1;
             lineNumber++;
+            FlushResults(data->GetOwner());
         }
     } else {
         // simple search
@@ -316,17 +411,18 @@ void SearchThread::DoSearchFile(const wxString& fileName, const SearchData* data
         if(findString.empty()) { return; }
         
         if(!data->IsMatchCase()) { findString.MakeLower(); }
-        while(tkz.HasMoreTokens()) {
+        while(tkz.HasMoreTokens() && !TestStopSearch()) {
 
             // Read the next line
             wxString line = tkz.NextToken();
             DoSearchLine(line, lineNumber, lineOffset, fileName, data, findString, filters, states);
             lineOffset += line.Length() + 1;
             lineNumber++;
+            FlushResults(data->GetOwner());
         }
     }
 
-    if(m_results.empty() == false) { SendEvent(wxEVT_SEARCH_THREAD_MATCHFOUND, data->GetOwner()); }
+    FlushResults(data->GetOwner());
 }
 
 void SearchThread::DoSearchLineRE(const wxString& line, const int lineNum, const int lineOffset,
@@ -337,6 +433,7 @@ void SearchThread::DoSearchLineRE(const wxString& line, const int lineNum, const
     int iCorrectedCol = 0;
     int iCorrectedLen = 0;
     wxString modLine = line;
+    SearchResult::SharedString_t pattern; // shared by all the matches in this line
     if(re.IsValid()) {
         while(re.Matches(modLine)) {
             size_t start, len;
@@ -352,12 +449,13 @@ void SearchThread::DoSearchLineRE(const wxString& line, const int lineNum, const
             result.SetColumnInChars((int)col);
             result.SetColumn(iCorrectedCol);
             result.SetLineNumber(lineNum);
-            result.SetPattern(line);
-            result.SetFileName(fileName);
+            if(!pattern) { pattern = SearchResult::MakeShared(line); }
+            result.SetPattern(pattern);
+            result.SetFileName(m_fileName);
             result.SetLenInChars((int)len);
             result.SetLen(iCorrectedLen);
             result.SetFlags(data->m_flags);
-            result.SetFindWhat(data->GetFindString());
+            result.SetFindWhat(m_findWhat);
 
             // Make sure our match is not on a comment
             int position(wxNOT_FOUND);
@@ -416,6 +514,7 @@ void SearchThread::DoSearchLine(const wxString& line, const int lineNum, const i
                                 TextStatesPtr statesPtr)
 {
     wxString modLine = line;
+    SearchResult::SharedString_t pattern; // shared by all the matches in this line
 
     if(!data->IsMatchCase()) { modLine.MakeLower(); }
 
@@ -479,11 +578,12 @@ void SearchThread::DoSearchLine(const wxString& line, const int lineNum, const i
             result.SetColumn(iCorrectedCol);
             result.SetLineNumber(lineNum);
             // Dont use match pattern larger than 500 chars
-            result.SetPattern(line.length() > 500 ? line.Mid(0, 500) : line);
-            result.SetFileName(fileName);
+            if(!pattern) { pattern = SearchResult::MakeShared(line.length() > 500 ? line.Mid(0, 500) : line); }
+            result.SetPattern(pattern);
+            result.SetFileName(m_fileName);
             result.SetLenInChars((int)findWhat.Length());
             result.SetLen(iCorrectedLen);
-            result.SetFindWhat(data->GetFindString());
+            result.SetFindWhat(m_findWhat);
             result.SetFlags(data->m_flags);
 
             int position(wxNOT_FOUND);
@@ -553,24 +653,28 @@ void SearchThread::SendEvent(wxEventType type, wxEvtHandler* owner)
 
     wxCommandEvent event(type, GetId());
 
-    if(type == wxEVT_SEARCH_THREAD_MATCHFOUND && m_counter == 10) {
-        // match found and we scanned 10 files
-        m_counter = 0;
-        event.SetClientData(new SearchResultList(m_results));
-        m_results.clear();
-        SEND_ST_EVENT();
-
-    } else if(type == wxEVT_SEARCH_THREAD_MATCHFOUND) {
-        // a match event, but we did not meet the minimum number of files
-        m_counter++;
-        wxThread::Sleep(10);
+    if(type == wxEVT_SEARCH_THREAD_MATCHFOUND) {
+        // Deliver the first results immediately, then in time slices so we don't flood the UI with events
+        bool isFirst = (m_summary.GetFirstResultElapsedTime() == wxNOT_FOUND);
+        if(isFirst || m_resultsTime.Time() >= SEARCH_RESULTS_INTERVAL ||
+           m_results.size() >= SEARCH_RESULTS_BATCH_SIZE) {
+            if(isFirst) { m_summary.SetFirstResultElapsedTime(m_searchTime.Time()); }
+            // Hand over the results without copying them
+            SearchResultList* results = new SearchResultList();
+            results->swap(m_results);
+            event.SetClientData(results);
+            SEND_ST_EVENT();
+            m_resultsTime.Start();
+        }
 
     } else if((type == wxEVT_SEARCH_THREAD_SEARCHEND) || (type == wxEVT_SEARCH_THREAD_SEARCHCANCELED)) {
         // search eneded, if we got any matches "buffed" send them before the
         // the summary event
         if(m_results.empty() == false) {
             wxCommandEvent evt(wxEVT_SEARCH_THREAD_MATCHFOUND, GetId());
-            evt.SetClientData(new SearchResultList(m_results));
+            SearchResultList* results = new SearchResultList();
+            results->swap(m_results);
+            evt.SetClientData(results);
             if(owner) {
                 wxPostEvent(owner, evt);
             } else if(m_notifiedWindow) {
@@ -579,7 +683,6 @@ void SearchThread::SendEvent(wxEventType type, wxEvtHandler* owner)
         }
 
         m_results.clear();
-        m_counter = 0;
 
         // Now send the summary event
         event.SetClientData(type == wxEVT_SEARCH_THREAD_SEARCHEND ? new SearchSummary(m_summary) : nullptr);
@@ -587,21 +690,10 @@ void SearchThread::SendEvent(wxEventType type, wxEvtHandler* owner)
     }
 }
 
-void SearchThread::FilterFiles(wxArrayString& files, const SearchData* data)
+void SearchThread::FlushResults(wxEvtHandler* owner)
 {
-    wxArrayString tmpFiles;
-    std::set<wxString> uniqueFiles;
-    const wxArrayString& excludePatterns = data->GetExcludePatterns();
-    const wxString& mask = data->GetExtensions();
-    std::for_each(files.begin(), files.end(), [&](const wxString& filename) {
-        if(uniqueFiles.count(filename)) return;
-        uniqueFiles.insert(filename);
-        if(FileUtils::WildMatch(mask, filename) && !FileUtils::WildMatch(excludePatterns, filename)) {
-            tmpFiles.Add(filename);
-        }
-    });
-    files.swap(tmpFiles);
-    files.Sort([](const wxString& f1, const wxString& f2) -> int { return f1.CmpNoCase(f2); });
+    // SendEvent() decides whether the interval has passed
+    if(!m_results.empty()) { SendEvent(wxEVT_SEARCH_THREAD_MATCHFOUND, owner); }
 }
 
 static SearchThread* gs_SearchThread = NULL;
@@ -617,14 +709,20 @@ SearchThread* SearchThreadST::Get()
     return gs_SearchThread;
 }
 
+const wxString& SearchResult::DoGetString(const SharedString_t& str)
+{
+    static const wxString emptyString;
+    return str ? *str : emptyString;
+}
+
 JSONItem SearchResult::ToJSON() const
 {
     JSONItem json = JSONItem::createObject();
-    json.addProperty("file", m_fileName);
+    json.addProperty("file", GetFileName());
     json.addProperty("line", m_lineNumber);
     json.addProperty("col", m_column);
     json.addProperty("pos", m_position);
-    json.addProperty("pattern", m_pattern);
+    json.addProperty("pattern", GetPattern());
     json.addProperty("len", m_len);
     json.addProperty("flags", m_flags);
     json.addProperty("columnInChars", m_columnInChars);
@@ -640,8 +738,8 @@ void SearchResult::FromJSON(const JSONItem& json)
     m_position = json.namedObject("pos").toInt(m_position);
     m_column = json.namedObject("col").toInt(m_column);
     m_lineNumber = json.namedObject("line").toInt(m_lineNumber);
-    m_pattern = json.namedObject("pattern").toString(m_pattern);
-    m_fileName = json.namedObject("file").toString(m_fileName);
+    m_pattern = MakeShared(json.namedObject("pattern").toString(GetPattern()));
+    m_fileName = MakeShared(json.namedObject("file").toString(GetFileName()));
     m_len = json.namedObject("len").toInt(m_len);
     m_flags = json.namedObject("flags").toSize_t(m_flags);
     m_columnInChars = json.namedObject("columnInChars").toInt(m_columnInChars);
@@ -657,6 +755,7 @@ JSONItem SearchSummary::ToJSON() const
     json.addProperty("filesScanned", m_fileScanned);
     json.addProperty("matchesFound", m_matchesFound);
     json.addProperty("elapsed", m_elapsed);
+    json.addProperty("firstResultElapsed", m_firstResultElapsed);
     json.addProperty("failedFiles", m_failedFiles);
     json.addProperty("findWhat", m_findWhat);
     json.addProperty("replaceWith", m_replaceWith);
@@ -668,6 +767,7 @@ void SearchSummary::FromJSON(const JSONItem& json)
     m_fileScanned = json.namedObject("filesScanned").toInt(m_fileScanned);
     m_matchesFound = json.namedObject("matchesFound").toInt(m_matchesFound);
     m_elapsed = json.namedObject("elapsed").toInt(m_elapsed);
+    m_firstResultElapsed = json.namedObject("firstResultElapsed").toInt(m_firstResultElapsed);
     m_failedFiles = json.namedObject("failedFiles").toArrayString();
     m_findWhat = json.namedObject("findWhat").toString();
     m_replaceWith = json.namedObject("replaceWith").toString();
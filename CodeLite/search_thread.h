@@ -32,10 +32,15 @@
 #include "wx/event.h"
 #include "wx/filename.h"
 #include "wxStringHash.h"
+#include <atomic>
 #include <deque>
+#include <functional>
 #include <list>
 #include <map>
+#include <vector>
 #include <wx/regex.h>
+#include <wx/sharedptr.h>
+#include <wx/stopwatch.h>
 #include <wx/string.h>
 #include "JSON.h"
 
@@ -153,44 +158,39 @@ public:
 //------------------------------------------
 class WXDLLIMPEXP_CL SearchResult : public wxObject
 {
-    wxString m_pattern;
+public:
+    /**
+     * @brief an immutable string shared between results. A search usually produces many results for the same file
+     * (and the same find-what string), so these strings are allocated once and copying a result is cheap
+     */
+    typedef wxSharedPtr<const wxString> SharedString_t;
+
+private:
+    SharedString_t m_pattern;
     int m_position;
     int m_lineNumber;
     int m_column;
-    wxString m_fileName;
+    SharedString_t m_fileName;
     int m_len;
-    wxString m_findWhat;
+    SharedString_t m_findWhat;
     size_t m_flags;
     int m_columnInChars;
     int m_lenInChars;
     short m_matchState;
-    wxString m_scope;
+    SharedString_t m_scope;
+
+    static const wxString& DoGetString(const SharedString_t& str);
 
 public:
-    // ctor-dtor, copy constructor and assignment operator
+    // ctor-dtor. Copying a result only shares its strings
     SearchResult() {}
 
     virtual ~SearchResult() {}
 
-    SearchResult(const SearchResult& rhs) { *this = rhs; }
-
-    SearchResult& operator=(const SearchResult& rhs)
-    {
-        if(this == &rhs) return *this;
-        m_position = rhs.m_position;
-        m_column = rhs.m_column;
-        m_lineNumber = rhs.m_lineNumber;
-        m_pattern = rhs.m_pattern.c_str();
-        m_fileName = rhs.m_fileName.c_str();
-        m_len = rhs.m_len;
-        m_findWhat = rhs.m_findWhat.c_str();
-        m_flags = rhs.m_flags;
-        m_columnInChars = rhs.m_columnInChars;
-        m_lenInChars = rhs.m_lenInChars;
-        m_matchState = rhs.m_matchState;
-        m_scope = rhs.m_scope.c_str();
-        return *this;
-    }
+    /**
+     * @brief create a shared string. The content is deep copied so it can be passed between threads
+     */
+    static SharedString_t MakeShared(const wxString& str) { return SharedString_t(new wxString(str.c_str())); }
 
     JSONItem ToJSON() const;
     void FromJSON(const JSONItem& json);
@@ -202,25 +202,28 @@ public:
 
     const size_t& GetFlags() const { return m_flags; }
 
-    void SetPattern(const wxString& pat) { m_pattern = pat.c_str(); }
+    void SetPattern(const wxString& pat) { m_pattern = MakeShared(pat); }
+    void SetPattern(const SharedString_t& pat) { m_pattern = pat; }
     void SetPosition(const int& position) { m_position = position; }
     void SetLineNumber(const int& line) { m_lineNumber = line; }
     void SetColumn(const int& col) { m_column = col; }
-    void SetFileName(const wxString& fileName) { m_fileName = fileName.c_str(); }
+    void SetFileName(const wxString& fileName) { m_fileName = MakeShared(fileName); }
+    void SetFileName(const SharedString_t& fileName) { m_fileName = fileName; }
 
     const int& GetPosition() const { return m_position; }
     const int& GetLineNumber() const { return m_lineNumber; }
     const int& GetColumn() const { return m_column; }
-    const wxString& GetPattern() const { return m_pattern; }
-    const wxString& GetFileName() const { return m_fileName; }
+    const wxString& GetPattern() const { return DoGetString(m_pattern); }
+    const wxString& GetFileName() const { return DoGetString(m_fileName); }
 
     void SetLen(const int& len) { this->m_len = len; }
     const int& GetLen() const { return m_len; }
 
     // Setters
-    void SetFindWhat(const wxString& findWhat) { this->m_findWhat = findWhat.c_str(); }
+    void SetFindWhat(const wxString& findWhat) { this->m_findWhat = MakeShared(findWhat); }
+    void SetFindWhat(const SharedString_t& findWhat) { this->m_findWhat = findWhat; }
     // Getters
-    const wxString& GetFindWhat() const { return m_findWhat; }
+    const wxString& GetFindWhat() const { return DoGetString(m_findWhat); }
 
     void SetColumnInChars(const int& col) { this->m_columnInChars = col; }
     const int& GetColumnInChars() const { return m_columnInChars; }
@@ -231,8 +234,8 @@ public:
     void SetMatchState(short matchState) { this->m_matchState = matchState; }
     short GetMatchState() const { return m_matchState; }
 
-    void SetScope(const wxString& scope) { this->m_scope = scope.c_str(); }
-    const wxString& GetScope() const { return m_scope; }
+    void SetScope(const wxString& scope) { this->m_scope = MakeShared(scope); }
+    const wxString& GetScope() const { return DoGetString(m_scope); }
     // return a foramtted message
     wxString GetMessage() const
     {
@@ -243,13 +246,14 @@ public:
     }
 };
 
-typedef std::list<SearchResult> SearchResultList;
+typedef std::vector<SearchResult> SearchResultList;
 
 class WXDLLIMPEXP_CL SearchSummary : public wxObject
 {
     int m_fileScanned;
     int m_matchesFound;
     int m_elapsed;
+    int m_firstResultElapsed; //< Time (ms) until the first results were delivered, -1 if there were none
     wxArrayString m_failedFiles;
     wxString m_findWhat;
     wxString m_replaceWith;
@@ -259,6 +263,7 @@ public:
         : m_fileScanned(0)
         , m_matchesFound(0)
         , m_elapsed(0)
+        , m_firstResultElapsed(wxNOT_FOUND)
     {
     }
 
@@ -273,6 +278,7 @@ public:
         m_fileScanned = rhs.m_fileScanned;
         m_matchesFound = rhs.m_matchesFound;
         m_elapsed = rhs.m_elapsed;
+        m_firstResultElapsed = rhs.m_firstResultElapsed;
         m_failedFiles = rhs.m_failedFiles;
         m_findWhat = rhs.m_findWhat;
         m_replaceWith = rhs.m_replaceWith;
@@ -295,6 +301,8 @@ public:
     void SetNumFileScanned(const int& num) { m_fileScanned = num; }
     void SetNumMatchesFound(const int& num) { m_matchesFound = num; }
     void SetElapsedTime(long elapsed) { m_elapsed = elapsed; }
+    void SetFirstResultElapsedTime(long elapsed) { m_firstResultElapsed = elapsed; }
+    int GetFirstResultElapsedTime() const { return m_firstResultElapsed; }
     wxString GetMessage() const
     {
         wxString msg(wxString(wxT("====== ")) + _("Number of files scanned: "));
@@ -304,7 +312,13 @@ public:
         int secs = m_elapsed / 1000;
         int msecs = m_elapsed % 1000;
 
-        msg << _(", elapsed time: ") << secs << wxT(".") << msecs << _(" seconds") << wxT(" ======");
+        msg << _(", elapsed time: ") << secs << wxT(".") << msecs << _(" seconds");
+        if(m_firstResultElapsed != wxNOT_FOUND) {
+            msg << _(", first match after: ") << wxString::Format("%d.%03d", m_firstResultElapsed / 1000,
+                                                                  m_firstResultElapsed % 1000)
+                << _(" seconds");
+        }
+        msg << wxT(" ======");
         if(!m_failedFiles.IsEmpty()) {
             msg << "\n";
             msg << "====== " << _("Failed to open the following files for scan:") << "\n";
@@ -326,13 +340,15 @@ class WXDLLIMPEXP_CL SearchThread : public WorkerThread
     wxString m_wordChars;
     std::unordered_map<wxChar, bool> m_wordCharsMap; //< Internal
     SearchResultList m_results;
-    bool m_stopSearch;
+    SearchResult::SharedString_t m_fileName; //< The file currently searched, shared by its results
+    SearchResult::SharedString_t m_findWhat; //< Shared by all the results of the current search
+    std::atomic_bool m_stopSearch;
     SearchSummary m_summary;
     wxString m_reExpr;
     wxRegEx m_regex;
     bool m_matchCase;
-    wxCriticalSection m_cs;
-    int m_counter = 0;
+    wxStopWatch m_searchTime;  //< Started when the request is processed
+    wxStopWatch m_resultsTime; //< Started whenever a batch of results is sent
 
 public:
     /**
@@ -373,11 +389,11 @@ public:
 
 private:
     /**
-     * Return files to search
-     * \param files output
+     * Enumerate the files to search, passing each file to "onFile" as soon as it is found
      * \param data search data
+     * \param onFile called for every file that should be searched. Return false to stop the enumeration
      */
-    void GetFiles(const SearchData* data, wxArrayString& files);
+    void GetFiles(const SearchData* data, const std::function<bool(const wxString&)>& onFile);
 
     /**
      * Index the word chars from the array into a map
@@ -408,14 +424,14 @@ private:
     // Send an event to the notified window
     void SendEvent(wxEventType type, wxEvtHandler* owner);
 
+    // Deliver the pending matches if they waited long enough, even if no new match is found
+    void FlushResults(wxEvtHandler* owner);
+
     // return a compiled regex object for the expression
     wxRegEx& GetRegex(const wxString& expr, bool matchCase);
 
     // Internal function
     bool AdjustLine(wxString& line, int& pos, const wxString& findString);
-
-    // filter 'files' according to the files spec
-    void FilterFiles(wxArrayString& files, const SearchData* data);
 };
 
 class WXDLLIMPEXP_CL SearchThreadST
@@ -1,12 +1,17 @@
 #include "CxxTokenizer.h"
 #include "CxxVariableScanner.h"
 #include "ctags_manager.h"
+#include "fileextmanager.h"
 #include "fileutils.h"
 #include "tester.h"
+#include <atomic>
 #include <iostream>
 #include <stdio.h>
+#include <thread>
+#include <vector>
 #include <wx/init.h>
 #include <wx/log.h>
+#include <wx/thread.h>
 
 TEST_FUNC(test_cxx_normalize_signature)
 {
@@ -188,6 +193,42 @@ TEST_FUNC(test_local_in_std_for_each)
     return true;
 }
 
+TEST_FUNC(test_file_ext_manager_concurrent_lookups)
+{
+    // FileExtManager::GetType() no longer takes a lock, make sure concurrent lookups agree with serial ones
+    FileExtManager::Init();
+    const wxString files[] = { "/home/user/src/main.cpp", "/home/user/src/main.h", "/home/user/src/Makefile",
+                               "/home/user/src/index.php", "/home/user/src/script.js", "/home/user/src/CMakeLists.txt" };
+    const size_t filesCount = sizeof(files) / sizeof(wxString);
+    std::vector<FileExtManager::FileType> expected;
+    for(const wxString& file : files) {
+        expected.push_back(FileExtManager::GetType(file));
+    }
+
+    std::atomic_int mismatches(0);
+    std::vector<std::thread> threads;
+    size_t threadsCount = wxMax(2, wxThread::GetCPUCount());
+    for(size_t i = 0; i < threadsCount; ++i) {
+        threads.push_back(std::thread([&]() {
+            for(size_t j = 0; j < 10000; ++j) {
+                if(FileExtManager::GetType(files[j % filesCount]) != expected[j % filesCount]) { ++mismatches; }
+            }
+        }));
+    }
+    for(std::thread& t : threads) {
+        t.join();
+    }
+
+    CHECK_BOOL(mismatches == 0);
+    CHECK_BOOL(expected[0] == FileExtManager::TypeSourceCpp);
+    CHECK_BOOL(expected[1] == FileExtManager::TypeHeader);
+    CHECK_BOOL(expected[2] == FileExtManager::TypeMakefile);
+    CHECK_BOOL(expected[3] == FileExtManager::TypePhp);
+    CHECK_BOOL(expected[4] == FileExtManager::TypeJS);
+    CHECK_BOOL(expected[5] == FileExtManager::TypeCMake);
+    return true;
+}
+
 int main(int argc, char** argv)
 {
     wxInitializer initializer(argc, argv);
@@ -25,6 +25,7 @@
 
 #include "DbViewerPanel.h"
 #include "SqlCommandPanel.h"
+#include "SqlQueryThread.h"
 #include "bitmap_loader.h"
 #include "clKeyboardManager.h"
 #include "clStatusBarMessage.h"
@@ -39,6 +40,7 @@
 #include <set>
 #include <wx/busyinfo.h>
 #include <wx/file.h>
+#include <wx/numdlg.h>
 #include <wx/textfile.h>
 #include <wx/wupdlock.h>
 #include <wx/xrc/xmlres.h>
@@ -62,6 +64,7 @@ END_EVENT_TABLE()
 SQLCommandPanel::SQLCommandPanel(wxWindow* parent, IDbAdapter* dbAdapter, const wxString& dbName,
                                  const wxString& dbTable)
     : _SqlCommandPanel(parent)
+    , m_queryThread(NULL)
 {
     LexerConf::Ptr_t lexerSQL = EditorConfigST::Get()->GetLexer("SQL");
     if(lexerSQL) {
@@ -99,15 +102,27 @@ SQLCommandPanel::SQLCommandPanel(wxWindow* parent, IDbAdapter* dbAdapter, const
     m_toolbar = new clToolBar(this);
     m_toolbar->AddTool(wxID_OPEN, _("Load SQL Script"), bmpLoader->LoadBitmap("file_open"));
     m_toolbar->AddTool(wxID_EXECUTE, _("Execute SQL"), bmpLoader->LoadBitmap("execute"));
+    m_toolbar->AddTool(wxID_STOP, _("Stop Query"), bmpLoader->LoadBitmap("stop"));
+    m_toolbar->AddTool(wxID_PREFERENCES, _("Maximum Rows..."), bmpLoader->LoadBitmap("cog"));
     m_toolbar->Realize();
     GetSizer()->Insert(0, m_toolbar, 0, wxEXPAND);
 
     // Bind events
     m_toolbar->Bind(wxEVT_TOOL, &SQLCommandPanel::OnExecuteClick, this, wxID_EXECUTE);
     m_toolbar->Bind(wxEVT_TOOL, &SQLCommandPanel::OnLoadClick, this, wxID_OPEN);
+    m_toolbar->Bind(wxEVT_TOOL, &SQLCommandPanel::OnStopClick, this, wxID_STOP);
+    m_toolbar->Bind(wxEVT_TOOL, &SQLCommandPanel::OnMaxRowsClick, this, wxID_PREFERENCES);
+    m_toolbar->Bind(wxEVT_UPDATE_UI, &SQLCommandPanel::OnExecuteUI, this, wxID_EXECUTE);
+    m_toolbar->Bind(wxEVT_UPDATE_UI, &SQLCommandPanel::OnStopUI, this, wxID_STOP);
 }
 
-SQLCommandPanel::~SQLCommandPanel() { wxDELETE(m_pDbAdapter); }
+SQLCommandPanel::~SQLCommandPanel()
+{
+    // Stop the running query (if any) before we delete the adapter
+    if(m_queryThread) { m_queryThread->Cancel(); }
+    wxDELETE(m_queryThread);
+    wxDELETE(m_pDbAdapter);
+}
 
 void SQLCommandPanel::OnExecuteClick(wxCommandEvent& event) { ExecuteSql(); }
 
@@ -121,13 +136,10 @@ void SQLCommandPanel::OnScintilaKeyDown(wxKeyEvent& event)
 
 void SQLCommandPanel::ExecuteSql()
 {
-    clStatusBarMessage message(_("Executing SQL..."));
+    if(IsQueryRunning()) { return; }
 
-    clWindowUpdateLocker locker(this);
-    std::set<int> textCols;
-    std::set<int> blobCols;
-    DatabaseLayerPtr m_pDbLayer = m_pDbAdapter->GetDatabaseLayer(m_dbName);
-    if(m_pDbLayer->IsOpen()) {
+    DatabaseLayerPtr pDbLayer = m_pDbAdapter->GetDatabaseLayer(m_dbName);
+    if(pDbLayer->IsOpen()) {
         // build string of SQL statements with comments removed
         wxArrayString sqls = ParseSql();
         wxString sqlStmt = "";
@@ -139,131 +151,19 @@ void SQLCommandPanel::ExecuteSql()
         SaveSqlHistory(sqls);
 
         if(!sqls.IsEmpty()) {
-            try {
-                m_colsMetaData.clear();
-                if(!m_pDbAdapter->GetUseDb(m_dbName).IsEmpty()) m_pDbLayer->RunQuery(m_pDbAdapter->GetUseDb(m_dbName));
-                // run query
-                DatabaseResultSet* pResultSet = m_pDbLayer->RunQueryWithResults(sqlStmt);
-
-                m_table->ClearAll();
-                if(!pResultSet) {
-                    wxMessageBox(_("Unknown SQL error."), _("DB Error"), wxOK | wxICON_ERROR);
-                    return;
-                }
-
-                int cols = pResultSet->GetMetaData()->GetColumnCount();
-                m_colsMetaData.resize(cols);
-
-                // create table header
-                wxArrayString columns;
-                for(int i = 1; i <= pResultSet->GetMetaData()->GetColumnCount(); i++) {
-                    columns.Add(pResultSet->GetMetaData()->GetColumnName(i));
-                    m_colsMetaData.at(i - 1) = ColumnInfo(pResultSet->GetMetaData()->GetColumnType(i),
-                                                          pResultSet->GetMetaData()->GetColumnName(i));
-                }
-                m_table->SetColumns(columns);
-
-                // fill table data
-                std::vector<wxArrayString> data;
-                while(pResultSet->Next()) {
-                    data.push_back(wxArrayString());
-                    wxArrayString& row = data.back();
-                    wxString value;
-                    for(int i = 1; i <= pResultSet->GetMetaData()->GetColumnCount(); i++) {
-
-                        switch(pResultSet->GetMetaData()->GetColumnType(i)) {
-                        case ResultSetMetaData::COLUMN_INTEGER:
-                            if(m_pDbAdapter->GetAdapterType() == IDbAdapter::atSQLITE) {
-                                value = pResultSet->GetResultString(i);
-
-                            } else {
-                                value = wxString::Format(wxT("%i"), pResultSet->GetResultInt(i));
-                            }
-                            break;
-
-                        case ResultSetMetaData::COLUMN_STRING:
-                            value = pResultSet->GetResultString(i);
-                            break;
-
-                        case ResultSetMetaData::COLUMN_UNKNOWN:
-                            value = pResultSet->GetResultString(i);
-                            break;
-
-                        case ResultSetMetaData::COLUMN_BLOB: {
-                            if(textCols.find(i) != textCols.end()) {
-                                // this column should be displayed as TEXT rather than BLOB
-                                value = pResultSet->GetResultString(i);
-
-                            } else if(blobCols.find(i) != blobCols.end()) {
-                                // this column should be displayed as BLOB
-                                wxMemoryBuffer buffer;
-                                pResultSet->GetResultBlob(i, buffer);
-                                value = wxString::Format(wxT("BLOB (Size:%u)"), buffer.GetDataLen());
-
-                            } else {
-                                // first time
-                                wxString strCol = pResultSet->GetResultString(i);
-                                if(IsBlobColumn(strCol)) {
-                                    blobCols.insert(i);
-                                    wxMemoryBuffer buffer;
-                                    pResultSet->GetResultBlob(i, buffer);
-                                    value = wxString::Format(wxT("BLOB (Size:%u)"), buffer.GetDataLen());
-
-                                } else {
-                                    textCols.insert(i);
-                                    value = strCol;
-                                }
-                            }
-                            break;
-                        }
-                        case ResultSetMetaData::COLUMN_BOOL:
-                            value = wxString::Format(wxT("%b"), pResultSet->GetResultBool(i));
-                            break;
-
-                        case ResultSetMetaData::COLUMN_DATE: {
-                            wxDateTime dt = pResultSet->GetResultDate(i);
-                            if(dt.IsValid()) {
-                                value = dt.Format();
-                            } else {
-                                value.Clear();
-                            }
-                        } break;
-
-                        case ResultSetMetaData::COLUMN_DOUBLE:
-                            value = wxString::Format(wxT("%f"), pResultSet->GetResultDouble(i));
-                            break;
-
-                        case ResultSetMetaData::COLUMN_NULL:
-                            value = wxT("NULL");
-                            break;
-
-                        default:
-                            value = pResultSet->GetResultString(i);
-                            break;
-                        }
-                        row.Add(value);
-                    }
-                }
-                m_pDbLayer->CloseResultSet(pResultSet);
-
-                // Popuplate the data
-                m_table->SetData(data);
-                GetSizer()->Layout();
-                Layout();
-
-            } catch(DatabaseLayerException& e) {
-                // for some reason an exception is thrown even if the error code is 0...
-                if(e.GetErrorCode() != 0) {
-                    wxString errorMessage =
-                        wxString::Format(_("Error (%d): %s"), e.GetErrorCode(), e.GetErrorMessage().c_str());
-                    wxMessageDialog dlg(this, errorMessage, _("DB Error"), wxOK | wxCENTER | wxICON_ERROR);
-                    dlg.ShowModal();
-                }
-
-            } catch(...) {
-                wxMessageDialog dlg(this, _("Unknown error."), _("DB Error"), wxOK | wxCENTER | wxICON_ERROR);
-                dlg.ShowModal();
-            }
+            m_colsMetaData.clear();
+            m_table->ClearAll();
+
+            DbExplorerSettings settings;
+            clConfig conf(DBE_CONFIG_FILE);
+            conf.ReadItem(&settings);
+
+            // Run the query on a worker thread, the rows are streamed back to us in pages
+            clGetManager()->SetStatusMessage(_("Executing SQL..."));
+            m_queryThread = new SqlQueryThread(this, pDbLayer, m_pDbAdapter->GetUseDb(m_dbName), sqlStmt,
+                                               m_pDbAdapter->GetAdapterType(), settings.GetMaxRows());
+            pDbLayer.Reset(NULL); // the thread owns the connection from now on
+            m_queryThread->Start();
         }
 
     } else {
@@ -271,6 +171,70 @@ void SQLCommandPanel::ExecuteSql()
     }
 }
 
+void SQLCommandPanel::OnQueryColumns(const ColumnInfo::Vector_t& columns)
+{
+    m_colsMetaData = columns;
+
+    // create table header
+    wxArrayString names;
+    for(size_t i = 0; i < columns.size(); ++i) {
+        names.Add(columns[i].GetName());
+    }
+    m_table->SetColumns(names);
+    GetSizer()->Layout();
+    Layout();
+}
+
+void SQLCommandPanel::OnQueryRows(const std::vector<wxArrayString>& rows) { m_table->AppendData(rows); }
+
+void SQLCommandPanel::OnQueryError(int errorCode, const wxString& errorMessage)
+{
+    wxString message = errorMessage;
+    if(errorCode != 0) { message = wxString::Format(_("Error (%d): %s"), errorCode, errorMessage.c_str()); }
+    wxMessageDialog dlg(this, message, _("DB Error"), wxOK | wxCENTER | wxICON_ERROR);
+    dlg.ShowModal();
+}
+
+void SQLCommandPanel::OnQueryEnded(size_t rowsCount, int status)
+{
+    // the thread is done, this will join it
+    wxDELETE(m_queryThread);
+
+    wxString message;
+    if(status == SqlQueryThread::kQueryCancelled) {
+        message << _("Query cancelled. ") << rowsCount << _(" rows fetched");
+    } else if(status == SqlQueryThread::kQueryTruncated) {
+        message << _("Query stopped after ") << rowsCount << _(" rows (the row limit is set in the settings)");
+    } else {
+        message << _("Query completed. ") << rowsCount << _(" rows fetched");
+    }
+    clGetManager()->SetStatusMessage(message, 5);
+}
+
+void SQLCommandPanel::OnStopClick(wxCommandEvent& event)
+{
+    wxUnusedVar(event);
+    if(m_queryThread) { m_queryThread->Cancel(); }
+}
+
+void SQLCommandPanel::OnExecuteUI(wxUpdateUIEvent& event) { event.Enable(!IsQueryRunning()); }
+
+void SQLCommandPanel::OnStopUI(wxUpdateUIEvent& event) { event.Enable(IsQueryRunning()); }
+
+void SQLCommandPanel::OnMaxRowsClick(wxCommandEvent& event)
+{
+    wxUnusedVar(event);
+    DbExplorerSettings settings;
+    clConfig conf(DBE_CONFIG_FILE);
+    conf.ReadItem(&settings);
+
+    long maxRows = ::wxGetNumberFromUser(_("Stop fetching the results of a query after this number of rows"),
+                                         _("Rows:"), _("Maximum Rows"), settings.GetMaxRows(), 1, 10000000, this);
+    if(maxRows == -1) { return; }
+    settings.SetMaxRows(maxRows);
+    conf.WriteItem(&settings);
+}
+
 void SQLCommandPanel::OnLoadClick(wxCommandEvent& event)
 {
     wxFileDialog dlg(this, _("Choose a file"), wxT(""), wxT(""), wxT("Sql files(*.sql)|*.sql"),
@@ -365,16 +329,6 @@ void SQLCommandPanel::OnCopyCellValue(wxCommandEvent& e)
     }
 }
 
-bool SQLCommandPanel::IsBlobColumn(const wxString& str)
-{
-    for(size_t i = 0; i < str.Len(); i++) {
-        if(!wxIsprint(str.GetChar(i))) {
-            return true;
-        }
-    }
-    return false;
-}
-
 void SQLCommandPanel::SetDefaultSelect()
 {
     m_scintillaSQL->ClearAll();
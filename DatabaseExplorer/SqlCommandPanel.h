@@ -43,6 +43,7 @@
 
 // ----------------------------------------------------------------
 class clToolBar;
+class SqlQueryThread;
 class ColumnInfo
 {
     int m_type;
@@ -88,9 +89,9 @@ protected:
     ColumnInfo::Vector_t m_colsMetaData;
     clEditEventsHandler::Ptr_t m_editHelper;
     clToolBar* m_toolbar;
+    SqlQueryThread* m_queryThread;
 
 protected:
-    bool IsBlobColumn(const wxString& str);
     wxArrayString ParseSql() const;
     void SaveSqlHistory(wxArrayString sqls);
 
@@ -111,6 +112,21 @@ public:
     void OnCopyCellValue(wxCommandEvent& e);
     DECLARE_EVENT_TABLE()
     void OnExecuteSQL(wxCommandEvent& e);
+    void OnStopClick(wxCommandEvent& event);
+    void OnExecuteUI(wxUpdateUIEvent& event);
+    void OnStopUI(wxUpdateUIEvent& event);
+    void OnMaxRowsClick(wxCommandEvent& event);
+
+    /**
+     * @brief return true if a query is currently running
+     */
+    bool IsQueryRunning() const { return m_queryThread != NULL; }
+
+    // Callbacks invoked (via CallAfter) by the SqlQueryThread
+    void OnQueryColumns(const ColumnInfo::Vector_t& columns);
+    void OnQueryRows(const std::vector<wxArrayString>& rows);
+    void OnQueryError(int errorCode, const wxString& errorMessage);
+    void OnQueryEnded(size_t rowsCount, int status);
 };
 
 #endif // SQLCOMMANDPANEL_H
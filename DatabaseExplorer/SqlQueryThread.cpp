@@ -0,0 +1,183 @@
+#include "SqlQueryThread.h"
+#include "SqlCommandPanel.h"
+#include <wx/dblayer/include/DatabaseLayerException.h>
+#include <wx/dblayer/include/DatabaseResultSet.h>
+#include <wx/dblayer/include/ResultSetMetaData.h>
+
+SqlQueryThread::SqlQueryThread(SQLCommandPanel* owner, DatabaseLayerPtr db, const wxString& useDb,
+                               const wxString& sql, int adapterType, size_t maxRows)
+    : m_owner(owner)
+    , m_db(db)
+    , m_useDb(useDb)
+    , m_sql(sql)
+    , m_adapterType(adapterType)
+    , m_maxRows(maxRows)
+    , m_pageSize(500)
+    , m_cancelled(false)
+{
+}
+
+SqlQueryThread::~SqlQueryThread()
+{
+    // Make sure that the thread is no longer using our members
+    Cancel();
+    Stop();
+}
+
+void* SqlQueryThread::Entry()
+{
+    DoRunQuery();
+    // The connection was created for this query only, close it from this thread
+    m_db.Reset(NULL);
+    return NULL;
+}
+
+void SqlQueryThread::DoRunQuery()
+{
+    size_t rowsCount = 0;
+    bool truncated = false;
+    try {
+        if(!m_useDb.IsEmpty()) { m_db->RunQuery(m_useDb); }
+
+        // run query
+        DatabaseResultSet* pResultSet = m_db->RunQueryWithResults(m_sql);
+        if(!pResultSet) {
+            m_owner->CallAfter(&SQLCommandPanel::OnQueryError, 0, wxString(_("Unknown SQL error.")));
+            m_owner->CallAfter(&SQLCommandPanel::OnQueryEnded, rowsCount, (int)kQueryCompleted);
+            return;
+        }
+
+        // GetMetaData() allocates a new object on every call, fetch it once
+        ResultSetMetaData* metaData = pResultSet->GetMetaData();
+        int cols = metaData->GetColumnCount();
+
+        // create table header
+        ColumnInfo::Vector_t columns;
+        for(int i = 1; i <= cols; i++) {
+            columns.push_back(ColumnInfo(metaData->GetColumnType(i), metaData->GetColumnName(i)));
+        }
+        m_owner->CallAfter(&SQLCommandPanel::OnQueryColumns, columns);
+
+        // stream the rows in pages
+        std::vector<wxArrayString> page;
+        page.reserve(m_pageSize);
+        while(!IsCancelled() && pResultSet->Next()) {
+            if(m_maxRows && rowsCount >= m_maxRows) {
+                truncated = true;
+                break;
+            }
+
+            wxArrayString row;
+            row.Alloc(cols);
+            for(int i = 1; i <= cols; i++) {
+                row.Add(GetCellValue(pResultSet, metaData, i));
+            }
+            page.push_back(row);
+            ++rowsCount;
+
+            if(page.size() == m_pageSize) {
+                m_owner->CallAfter(&SQLCommandPanel::OnQueryRows, page);
+                page.clear();
+            }
+        }
+
+        if(!page.empty()) { m_owner->CallAfter(&SQLCommandPanel::OnQueryRows, page); }
+        m_db->CloseResultSet(pResultSet);
+
+    } catch(DatabaseLayerException& e) {
+        // for some reason an exception is thrown even if the error code is 0...
+        if(e.GetErrorCode() != 0) {
+            m_owner->CallAfter(&SQLCommandPanel::OnQueryError, e.GetErrorCode(), e.GetErrorMessage());
+        }
+
+    } catch(...) {
+        m_owner->CallAfter(&SQLCommandPanel::OnQueryError, 0, wxString(_("Unknown error.")));
+    }
+    int status = kQueryCompleted;
+    if(m_cancelled.load()) {
+        status = kQueryCancelled;
+    } else if(truncated) {
+        status = kQueryTruncated;
+    }
+    m_owner->CallAfter(&SQLCommandPanel::OnQueryEnded, rowsCount, status);
+}
+
+wxString SqlQueryThread::GetCellValue(DatabaseResultSet* pResultSet, ResultSetMetaData* metaData, int i)
+{
+    wxString value;
+    switch(metaData->GetColumnType(i)) {
+    case ResultSetMetaData::COLUMN_INTEGER:
+        if(m_adapterType == IDbAdapter::atSQLITE) {
+            value = pResultSet->GetResultString(i);
+
+        } else {
+            value = wxString::Format(wxT("%i"), pResultSet->GetResultInt(i));
+        }
+        break;
+
+    case ResultSetMetaData::COLUMN_STRING:
+        value = pResultSet->GetResultString(i);
+        break;
+
+    case ResultSetMetaData::COLUMN_UNKNOWN:
+        value = pResultSet->GetResultString(i);
+        break;
+
+    case ResultSetMetaData::COLUMN_BLOB: {
+        if(m_textCols.find(i) != m_textCols.end()) {
+            // this column should be displayed as TEXT rather than BLOB
+            value = pResultSet->GetResultString(i);
+
+        } else if(m_blobCols.find(i) != m_blobCols.end()) {
+            // this column should be displayed as BLOB
+            wxMemoryBuffer buffer;
+            pResultSet->GetResultBlob(i, buffer);
+            value = wxString::Format(wxT("BLOB (Size:%u)"), buffer.GetDataLen());
+
+        } else {
+            // first time
+            wxString strCol = pResultSet->GetResultString(i);
+            if(IsBlobColumn(strCol)) {
+                m_blobCols.insert(i);
+                wxMemoryBuffer buffer;
+                pResultSet->GetResultBlob(i, buffer);
+                value = wxString::Format(wxT("BLOB (Size:%u)"), buffer.GetDataLen());
+
+            } else {
+                m_textCols.insert(i);
+                value = strCol;
+            }
+        }
+        break;
+    }
+    case ResultSetMetaData::COLUMN_BOOL:
+        value = wxString::Format(wxT("%b"), pResultSet->GetResultBool(i));
+        break;
+
+    case ResultSetMetaData::COLUMN_DATE: {
+        wxDateTime dt = pResultSet->GetResultDate(i);
+        if(dt.IsValid()) { value = dt.Format(); }
+    } break;
+
+    case ResultSetMetaData::COLUMN_DOUBLE:
+        value = wxString::Format(wxT("%f"), pResultSet->GetResultDouble(i));
+        break;
+
+    case ResultSetMetaData::COLUMN_NULL:
+        value = wxT("NULL");
+        break;
+
+    default:
+        value = pResultSet->GetResultString(i);
+        break;
+    }
+    return value;
+}
+
+bool SqlQueryThread::IsBlobColumn(const wxString& str) const
+{
+    for(size_t i = 0; i < str.Len(); i++) {
+        if(!wxIsprint(str.GetChar(i))) { return true; }
+    }
+    return false;
+}
@@ -0,0 +1,66 @@
+#ifndef SQLQUERYTHREAD_H
+#define SQLQUERYTHREAD_H
+
+#include "IDbAdapter.h"
+#include "clJoinableThread.h"
+#include <atomic>
+#include <set>
+#include <vector>
+#include <wx/arrstr.h>
+
+class SQLCommandPanel;
+class DatabaseResultSet;
+class ResultSetMetaData;
+
+/**
+ * @class SqlQueryThread
+ * @brief execute a query on a worker thread and stream the result set
+ * back to the SQLCommandPanel in pages
+ */
+class SqlQueryThread : public clJoinableThread
+{
+public:
+    enum eQueryStatus {
+        kQueryCompleted = 0,
+        kQueryTruncated,
+        kQueryCancelled,
+    };
+
+private:
+    SQLCommandPanel* m_owner;
+    DatabaseLayerPtr m_db;
+    wxString m_useDb;
+    wxString m_sql;
+    int m_adapterType;
+    size_t m_maxRows;
+    size_t m_pageSize;
+    std::atomic_bool m_cancelled;
+    std::set<int> m_textCols;
+    std::set<int> m_blobCols;
+
+protected:
+    void DoRunQuery();
+    wxString GetCellValue(DatabaseResultSet* resultSet, ResultSetMetaData* metaData, int col);
+    bool IsBlobColumn(const wxString& str) const;
+    bool IsCancelled() { return m_cancelled.load() || TestDestroy(); }
+
+public:
+    /**
+     * @param owner the panel that receives the results (via CallAfter)
+     * @param db the database layer to use. The thread takes ownership of it
+     * @param maxRows stop fetching rows after maxRows rows. 0 means no limit
+     */
+    SqlQueryThread(SQLCommandPanel* owner, DatabaseLayerPtr db, const wxString& useDb, const wxString& sql,
+                   int adapterType, size_t maxRows);
+    virtual ~SqlQueryThread();
+
+    /**
+     * @brief request the query to stop. This function does not block,
+     * the owner is notified once the thread is done
+     */
+    void Cancel() { m_cancelled.store(true); }
+
+    virtual void* Entry();
+};
+
+#endif // SQLQUERYTHREAD_H
@@ -31,6 +31,7 @@
 
 DbExplorerSettings::DbExplorerSettings()
     : clConfigItem(DBE_CONFIG)
+    , m_maxRows(DBE_DEFAULT_MAX_ROWS)
 {
 }
 
@@ -92,6 +93,7 @@ void DbExplorerSettings::FromJSON(const JSONItem& json)
 {
     m_recentFiles = json.namedObject("m_recentFiles").toArrayString();
     m_sqlHistory  = json.namedObject("m_sqlHistory").toArrayString();
+    SetMaxRows(json.namedObject("m_maxRows").toInt(m_maxRows));
     
     // read the connections
     JSONItem arrConnections = json.namedObject("connections");
@@ -107,6 +109,7 @@ JSONItem DbExplorerSettings::ToJSON() const
     JSONItem element = JSONItem::createObject(GetName());
     element.addProperty("m_recentFiles", m_recentFiles);
     element.addProperty("m_sqlHistory",  m_sqlHistory);
+    element.addProperty("m_maxRows",     m_maxRows);
     
     // add the connections array
     JSONItem arrConnections = JSONItem::createArray("connections");
@@ -31,6 +31,7 @@
 
 #define DBE_CONFIG      "database-explorer"
 #define DBE_CONFIG_FILE "database-explorer.conf"
+#define DBE_DEFAULT_MAX_ROWS 10000
 
 class DbConnectionInfo : public clConfigItem
 {
@@ -115,6 +116,7 @@ protected:
     wxArrayString       m_recentFiles;
     DbConnectionInfoVec m_connections;
     wxArrayString       m_sqlHistory;
+    int                 m_maxRows;
 
 public:
     DbExplorerSettings();
@@ -137,6 +139,15 @@ public:
     const wxArrayString& GetSqlHistory() const {
         return m_sqlHistory;
     }
+    /**
+     * @brief the maximum number of rows fetched by an interactive query. Values lower than 1 restore the default
+     */
+    void SetMaxRows(int maxRows) {
+        this->m_maxRows = maxRows > 0 ? maxRows : DBE_DEFAULT_MAX_ROWS;
+    }
+    int GetMaxRows() const {
+        return m_maxRows;
+    }
     virtual void FromJSON(const JSONItem &json);
     virtual JSONItem ToJSON() const;
 };
@@ -42,6 +42,7 @@ EditorConfigPlugin::EditorConfigPlugin(IManager* manager)
     // Bind events
     EventNotifier::Get()->Bind(wxEVT_EDITOR_CONFIG_LOADING, &EditorConfigPlugin::OnEditorConfigLoading, this);
     EventNotifier::Get()->Bind(wxEVT_ACTIVE_EDITOR_CHANGED, &EditorConfigPlugin::OnActiveEditorChanged, this);
+    EventNotifier::Get()->Bind(wxEVT_FILE_SAVED, &EditorConfigPlugin::OnFileSaved, this);
 }
 
 EditorConfigPlugin::~EditorConfigPlugin() {}
@@ -60,6 +61,7 @@ void EditorConfigPlugin::UnPlug()
 {
     EventNotifier::Get()->Unbind(wxEVT_EDITOR_CONFIG_LOADING, &EditorConfigPlugin::OnEditorConfigLoading, this);
     EventNotifier::Get()->Unbind(wxEVT_ACTIVE_EDITOR_CHANGED, &EditorConfigPlugin::OnActiveEditorChanged, this);
+    EventNotifier::Get()->Unbind(wxEVT_FILE_SAVED, &EditorConfigPlugin::OnFileSaved, this);
 }
 
 void EditorConfigPlugin::OnEditorConfigLoading(clEditorConfigEvent& event)
@@ -124,6 +126,16 @@ bool EditorConfigPlugin::DoGetEditorConfigForFile(const wxFileName& filename, cl
     return true;
 }
 
+void EditorConfigPlugin::OnFileSaved(clCommandEvent& event)
+{
+    event.Skip();
+    // A new .editorconfig file may take over files that are already cached
+    if(wxFileName(event.GetFileName()).GetFullName() == ".editorconfig") {
+        clEditorConfig::ClearCache();
+        m_cache.Clear();
+    }
+}
+
 void EditorConfigPlugin::OnSettings(wxCommandEvent& event)
 {
     EditorConfigSettingsDlg dlg(wxTheApp->GetTopWindow());
@@ -37,6 +37,7 @@ public:
     void OnEditorConfigLoading(clEditorConfigEvent& event);
     void OnActiveEditorChanged(wxCommandEvent& event);
     void OnSettings(wxCommandEvent& event);
+    void OnFileSaved(clCommandEvent& event);
 };
 
 #endif // EditorConfigPlugin
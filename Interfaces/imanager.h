@@ -214,6 +214,12 @@ public:
     virtual clTreeCtrl* GetFileExplorerTree() = 0;
     virtual clTreeCtrl* GetWorkspaceTree() = 0;
 
+    /**
+     * @brief return the workspace tree items of a file by its full path. A file that was added to several
+     * projects has one item per project. The array is empty if the file is not visible in the workspace tree
+     */
+    virtual wxArrayTreeItemIds GetWorkspaceTreeFileItems(const wxString& fullpath) = 0;
+
     /**
      * @brief return a pointer to the workspace pane notebook (the one with the 'workspace' title)
      * @return pointer to Notebook
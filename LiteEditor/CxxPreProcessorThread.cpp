@@ -3,20 +3,55 @@
 #include "CxxLexerAPI.h"
 #include "code_completion_manager.h"
 #include "file_logger.h"
+#include "cl_standard_paths.h"
+#include <wx/stopwatch.h>
+
+// Write the cache statistics to the log every this many requests
+#define PP_CACHE_REPORT_INTERVAL 50
 
 CxxPreProcessorThread::CxxPreProcessorThread()
+    : m_cacheTime(0)
+    , m_parseTime(0)
 {
+    wxFileName cacheFolder(clStandardPaths::Get().GetUserDataDir(), "");
+    cacheFolder.AppendDir("preprocessor-cache");
+    if(cacheFolder.DirExists() || cacheFolder.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL)) {
+        m_cache.SetCacheFolder(cacheFolder.GetPath());
+    }
 }
 
 CxxPreProcessorThread::~CxxPreProcessorThread()
 {
 }
 
+void CxxPreProcessorThread::ReportStatistics()
+{
+    size_t hits = m_cache.GetHits();
+    size_t misses = m_cache.GetMisses();
+    if((hits + misses) == 0) { return; }
+    clSYSTEM() << "Macros cache: hit rate" << (int)((hits * 100) / (hits + misses)) << "% (" << hits << "hits,"
+               << misses << "misses), average time from cache" << (hits ? (m_cacheTime / (long)hits) : 0)
+               << "ms, average parse time" << (misses ? (m_parseTime / (long)misses) : 0) << "ms" << clEndl;
+}
+
 void CxxPreProcessorThread::ProcessRequest(ThreadRequest* request)
 {
     CxxPreProcessorThread::Request* req = dynamic_cast<CxxPreProcessorThread::Request*>(request);
     CHECK_PTR_RET(req);
 
+    wxStopWatch sw;
+    wxString key = m_cache.GetKey(req->filename, req->includePaths, req->definitions);
+    wxArrayString definitions;
+    if(m_cache.Find(key, definitions)) {
+        m_cacheTime += sw.Time();
+        clDEBUG() << "Macros for file" << req->filename << "loaded from cache in" << sw.Time() << "ms (hits:"
+                  << m_cache.GetHits() << "misses:" << m_cache.GetMisses() << ")" << clEndl;
+        if(((m_cache.GetHits() + m_cache.GetMisses()) % PP_CACHE_REPORT_INTERVAL) == 0) { ReportStatistics(); }
+        CodeCompletionManager::Get().CallAfter(&CodeCompletionManager::OnParseThreadCollectedMacros, definitions,
+                                               req->filename);
+        return;
+    }
+
     CxxPreProcessor pp;
     for(size_t i = 0; i < req->includePaths.GetCount(); ++i) {
         pp.AddIncludePath(req->includePaths.Item(i));
@@ -30,8 +65,15 @@ void CxxPreProcessorThread::ProcessRequest(ThreadRequest* request)
     pp.Parse(req->filename, kLexerOpt_CollectMacroValueNumbers | kLexerOpt_DontCollectMacrosDefinedInThisFile);
     CL_DEBUG("Parsing of file: %s completed\n", req->filename);
 
-    CodeCompletionManager::Get().CallAfter(
-        &CodeCompletionManager::OnParseThreadCollectedMacros, pp.GetDefinitions(), req->filename);
+    definitions = pp.GetDefinitions();
+    m_cache.Insert(key, definitions, req->filename, req->includePaths, pp.GetFileMapping());
+    m_parseTime += sw.Time();
+    clDEBUG() << "Macros for file" << req->filename << "collected in" << sw.Time() << "ms (hits:" << m_cache.GetHits()
+              << "misses:" << m_cache.GetMisses() << ")" << clEndl;
+    if(((m_cache.GetHits() + m_cache.GetMisses()) % PP_CACHE_REPORT_INTERVAL) == 0) { ReportStatistics(); }
+
+    CodeCompletionManager::Get().CallAfter(&CodeCompletionManager::OnParseThreadCollectedMacros, definitions,
+                                           req->filename);
 }
 
 void CxxPreProcessorThread::QueueFile(const wxString& filename,
@@ -27,9 +27,19 @@
 #define CXXPREPROCESSORTHREAD_H
 
 #include "worker_thread.h" // Base class: WorkerThread
+#include "CxxPreProcessorCache.h"
 
 class CxxPreProcessorThread : public WorkerThread
 {
+    // Only accessed from the worker thread
+    CxxPreProcessorCache m_cache;
+    // Time spent on requests answered from the cache and on requests that were parsed, in ms
+    long m_cacheTime;
+    long m_parseTime;
+
+protected:
+    void ReportStatistics();
+
 public:
     struct Request : public ThreadRequest
     {
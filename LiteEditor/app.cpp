@@ -60,6 +60,7 @@
 #include <wx/imagjpeg.h>
 #include <wx/persist.h>
 #include <wx/regex.h>
+#include <wx/stopwatch.h>
 
 //#define __PERFORMANCE
 #include "performance.h"
@@ -259,6 +260,9 @@ static wxLogNull NO_LOG;
 
 bool CodeLiteApp::OnInit()
 {
+    // Time to main frame, see below
+    wxStopWatch startupTimer;
+
 #if defined(__WXMSW__) && CL_DEBUG_BUILD
     SetAppName(wxT("codelite-dbg"));
 #elif defined(__WXOSX__)
@@ -661,6 +665,7 @@ bool CodeLiteApp::OnInit()
     m_pMainFrame = clMainFrame::Get();
     m_pMainFrame->Show(TRUE);
     SetTopWindow(m_pMainFrame);
+    clSYSTEM() << "Main frame shown" << startupTimer.Time() << "ms after startup" << clEndl;
 
     long lineNumber(0);
     parser.Found(wxT("l"), &lineNumber);
@@ -170,6 +170,7 @@ void FileViewTree::OnBuildInProgress(wxUpdateUIEvent& event) { event.Enable(!Man
 
 FileViewTree::FileViewTree(wxWindow* parent, const wxWindowID id, const wxPoint& pos, const wxSize& size, long style)
     : clThemedTreeCtrl(parent, id, pos, size, style)
+    , m_filesIndexGeneration(wxString::npos)
     , m_eventsBound(false)
 {
     // Sorting method
@@ -1734,6 +1735,7 @@ void FileViewTree::OnRenameItem(wxCommandEvent& e)
                             // update the item's info
                             data->SetDisplayName(tmp.GetFullName());
                             data->SetFile(tmp.GetFullPath());
+                            m_filesIndexGeneration = wxString::npos;
 
                             // rename the tree item
                             SetItemText(item, tmp.GetFullName());
@@ -2513,6 +2515,42 @@ void FileViewTree::DoClear()
     m_workspaceFolders.clear();
     m_projectsMap.clear();
     m_excludeBuildFiles.clear();
+    m_filesIndex.clear();
+    m_filesIndexGeneration = wxString::npos;
+}
+
+void FileViewTree::DoBuildFilesIndex()
+{
+    m_filesIndex.clear();
+    m_filesIndexGeneration = GetModel().GetGeneration();
+
+    wxTreeItemId root = GetRootItem();
+    if(!root.IsOk()) { return; }
+
+    std::vector<wxTreeItemId> items;
+    items.push_back(root);
+    while(!items.empty()) {
+        wxTreeItemId item = items.back();
+        items.pop_back();
+
+        FilewViewTreeItemData* data = static_cast<FilewViewTreeItemData*>(GetItemData(item));
+        if(data && data->GetData().IsFile()) { m_filesIndex[data->GetData().GetFile()].Add(item); }
+
+        wxTreeItemIdValue cookie;
+        wxTreeItemId child = GetFirstChild(item, cookie);
+        while(child.IsOk()) {
+            items.push_back(child);
+            child = GetNextChild(item, cookie);
+        }
+    }
+}
+
+wxArrayTreeItemIds FileViewTree::FindFileItems(const wxString& fullpath)
+{
+    if(m_filesIndexGeneration != GetModel().GetGeneration()) { DoBuildFilesIndex(); }
+    auto iter = m_filesIndex.find(fullpath);
+    if(iter == m_filesIndex.end()) { return wxArrayTreeItemIds(); }
+    return iter->second;
 }
 
 void FileViewTree::ShowWorkspaceFolderContextMenu()
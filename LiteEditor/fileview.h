@@ -50,6 +50,8 @@ class FileViewTree : public clThemedTreeCtrl
     std::unordered_map<wxString, wxTreeItemId> m_workspaceFolders;
     std::unordered_map<wxString, wxTreeItemId> m_projectsMap;
     std::unordered_map<wxString, wxTreeItemId> m_excludeBuildFiles;
+    std::unordered_map<wxString, wxArrayTreeItemIds> m_filesIndex;
+    size_t m_filesIndexGeneration;
     bool m_eventsBound;
     clTreeCtrlColourHelper::Ptr_t m_colourHelper;
 
@@ -62,6 +64,7 @@ protected:
                                    const ProjectItem& projectItem);
 
     void ExcludeFileFromBuildUI(const wxTreeItemId& item, bool exclude);
+    void DoBuildFilesIndex();
     bool IsItemExcludedFromBuild(const wxTreeItemId& item, const wxString& configName) const;
 
 public:
@@ -131,6 +134,13 @@ public:
      */
     ProjectPtr GetItemProject(const wxTreeItemId& item) const;
 
+    /**
+     * @brief return the tree items of a file by its full path (a file may be added to more than one project).
+     * Only files that are visible in the tree (i.e. their parent was expanded) can be found. The path -> items
+     * index is rebuilt only when the tree structure changes, so this function is cheap to call
+     */
+    wxArrayTreeItemIds FindFileItems(const wxString& fullpath);
+
     /**
      * @brief public access to the "OnFolderDropped" function
      * @param event
@@ -49,6 +49,8 @@
 #include "pluginmanager.h"
 #include "shell_command.h"
 #include "workspace.h"
+#include <algorithm>
+#include <functional>
 #include <wx/choicdlg.h>
 #include <wx/dataview.h>
 #include <wx/dcmemory.h>
@@ -177,6 +179,7 @@ void NewBuildTab::OnBuildEnded(clCommandEvent& e)
     wxString problemcount =
         wxString::Format(wxT("%d %s, %d %s"), m_errorCount, _("errors"), m_warnCount, _("warnings"));
     wxString term = problemcount;
+    DoReportProjectsBuildTime();
     long elapsed = m_sw.Time() / 1000;
     if(elapsed > 10) {
         long sec = elapsed % 60;
@@ -270,6 +273,7 @@ void NewBuildTab::OnBuildStarted(clCommandEvent& e)
         ManagerST::Get()->HidePane(opane->GetName());
     }
     m_sw.Start();
+    m_projectsBuildTime.clear();
 
     m_cmp.Reset(NULL);
     BuildEventDetails* bed = dynamic_cast<BuildEventDetails*>(e.GetClientObject());
@@ -379,6 +383,7 @@ void NewBuildTab::DoClear()
     m_errorsAndWarningsList.clear();
     m_errorsList.clear();
     m_cmpPatterns.clear();
+    m_projectsBuildTime.clear();
 
     // Delete all the user data
     std::for_each(m_viewData.begin(), m_viewData.end(), [&](std::pair<int, BuildLineInfo*> p) { delete p.second; });
@@ -500,6 +505,100 @@ void NewBuildTab::DoSearchForDirectory(const wxString& line)
     }
 }
 
+void NewBuildTab::DoUpdateProjectBuildTime(const wxString& line)
+{
+    // The workspace makefile wraps each project with:
+    // ----------Building project:[ <project> - <config> ]----------
+    // ----------Finished project:[ <project> - <config> ]----------
+    static const wxString startPrefix = wxGetTranslation(BUILD_PROJECT_PREFIX);
+    static const wxString endPrefix = wxGetTranslation(BUILD_PROJECT_END_PREFIX);
+    wxString rest;
+    bool isStart = line.StartsWith(startPrefix, &rest);
+    if(!isStart && !line.StartsWith(endPrefix, &rest)) { return; }
+
+    rest = rest.BeforeLast(']');
+    rest.Trim();
+    size_t where = rest.rfind(" - ");
+    if(where == wxString::npos) { return; }
+
+    ProjectBuildTime& bt = m_projectsBuildTime[rest.Mid(0, where)];
+    if(isStart) {
+        bt.config = rest.Mid(where + 3);
+        bt.start = m_sw.Time();
+        bt.end = wxNOT_FOUND;
+    } else if(bt.start != wxNOT_FOUND) {
+        bt.end = m_sw.Time();
+    }
+}
+
+void NewBuildTab::DoReportProjectsBuildTime()
+{
+    // Projects are built concurrently, report how long each one took and which chain of dependencies
+    // determined the total build time
+    std::vector<wxString> projects;
+    for(const ProjectBuildTimeMap_t::value_type& vt : m_projectsBuildTime) {
+        if(vt.second.end != wxNOT_FOUND) { projects.push_back(vt.first); }
+    }
+    if(projects.size() < 2) { return; }
+
+    // The critical path of a project: its own build time + the longest critical path of its dependencies
+    std::map<wxString, long> criticalPath;
+    std::map<wxString, wxString> prevInPath;
+    std::function<long(const wxString&)> GetCriticalPath = [&](const wxString& name) -> long {
+        if(criticalPath.count(name)) { return criticalPath[name]; }
+        const ProjectBuildTime& bt = m_projectsBuildTime[name];
+        criticalPath[name] = 0; // protect against dependency cycles
+
+        long longestDep = 0;
+        wxString errmsg;
+        ProjectPtr proj = clCxxWorkspaceST::Get()->FindProjectByName(name, errmsg);
+        wxArrayString deps = proj ? proj->GetDependencies(bt.config) : wxArrayString();
+        for(size_t i = 0; i < deps.size(); ++i) {
+            ProjectBuildTimeMap_t::const_iterator iter = m_projectsBuildTime.find(deps.Item(i));
+            if(iter == m_projectsBuildTime.end() || iter->second.end == wxNOT_FOUND) { continue; }
+            long depPath = GetCriticalPath(deps.Item(i));
+            if(depPath > longestDep) {
+                longestDep = depPath;
+                prevInPath[name] = deps.Item(i);
+            }
+        }
+        criticalPath[name] = longestDep + (bt.end - bt.start);
+        return criticalPath[name];
+    };
+
+    std::sort(projects.begin(), projects.end(), [&](const wxString& a, const wxString& b) {
+        return m_projectsBuildTime[a].end < m_projectsBuildTime[b].end;
+    });
+
+    wxString text;
+    wxString lastProject;
+    long longestPath = -1;
+    text << _("Projects build time:") << "\n";
+    for(const wxString& name : projects) {
+        const ProjectBuildTime& bt = m_projectsBuildTime[name];
+        long path = GetCriticalPath(name);
+        text << "  " << name << ": " << wxString::Format("%.1f", (bt.end - bt.start) / 1000.0) << " "
+             << _("seconds") << ", " << _("critical path") << ": " << wxString::Format("%.1f", path / 1000.0) << " "
+             << _("seconds") << "\n";
+        if(path > longestPath) {
+            longestPath = path;
+            lastProject = name;
+        }
+    }
+
+    // Walk back the longest chain
+    wxString chain = lastProject;
+    while(prevInPath.count(lastProject)) {
+        lastProject = prevInPath[lastProject];
+        chain.Prepend(lastProject + " -> ");
+    }
+    text << _("Critical path: ") << chain << " (" << wxString::Format("%.1f", longestPath / 1000.0) << " "
+         << _("seconds") << ")\n";
+
+    m_output = text;
+    DoProcessOutput(true, false);
+}
+
 void NewBuildTab::OnWorkspaceClosed(wxCommandEvent& e)
 {
     e.Skip();
@@ -536,6 +635,7 @@ void NewBuildTab::DoProcessOutput(bool compilationEnded, bool isSummaryLine)
         // If this is a line similar to 'Entering directory `'
         // add the path in the directories array
         DoSearchForDirectory(buildLine);
+        DoUpdateProjectBuildTime(buildLine);
         BuildLineInfo* buildLineInfo = DoProcessLine(buildLine);
 
         // keep the line info
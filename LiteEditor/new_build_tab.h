@@ -152,6 +152,13 @@ class NewBuildTab : public wxPanel
     typedef std::multimap<wxString, BuildLineInfo*> MultimapBuildInfo_t;
     typedef std::list<BuildLineInfo*> BuildInfoList_t;
 
+    struct ProjectBuildTime {
+        wxString config;
+        long start = wxNOT_FOUND; // ms since the build started
+        long end = wxNOT_FOUND;
+    };
+    typedef std::map<wxString, ProjectBuildTime> ProjectBuildTimeMap_t;
+
     wxString m_output;
     wxStyledTextCtrl* m_view;
     CompilerPtr m_cmp;
@@ -175,6 +182,7 @@ class NewBuildTab : public wxPanel
     std::map<int, BuildLineInfo*> m_viewData;
     int m_maxlineWidth;
     int m_lastLineColoured;
+    ProjectBuildTimeMap_t m_projectsBuildTime;
 
 protected:
     void InitView(const wxString& theme = "");
@@ -183,6 +191,8 @@ protected:
     BuildLineInfo* DoProcessLine(const wxString& line);
     void DoProcessOutput(bool compilationEnded, bool isSummaryLine);
     void DoSearchForDirectory(const wxString& line);
+    void DoUpdateProjectBuildTime(const wxString& line);
+    void DoReportProjectsBuildTime();
     bool DoGetCompilerPatterns(const wxString& compilerName, CmpPatterns& patterns);
     void DoClear();
     void MarkEditor(clEditor* editor);
@@ -29,6 +29,7 @@
 #include "clEditorBar.h"
 #include "clKeyboardManager.h"
 #include "clToolBarButtonBase.h"
+#include "clWorkspaceManager.h"
 #include "cl_config.h"
 #include "cl_standard_paths.h"
 #include "ctags_manager.h"
@@ -57,6 +58,7 @@
 #include "wx/xrc/xmlres.h"
 #include <wx/dir.h>
 #include <wx/log.h>
+#include <wx/stopwatch.h>
 #include <wx/tokenzr.h>
 #include <wx/toolbook.h>
 #include "clInfoBar.h"
@@ -97,6 +99,11 @@ void PluginManager::UnLoad()
 
     m_dl.clear();
     m_plugins.clear();
+
+    if(!m_deferredPlugins.empty()) {
+        UnbindTriggers();
+        m_deferredPlugins.clear();
+    }
 }
 
 PluginManager::~PluginManager() {}
@@ -149,12 +156,16 @@ void PluginManager::Load()
 
     wxString pluginsDir = clStandardPaths::Get().GetPluginsDirectory();
     if(wxDir::Exists(pluginsDir)) {
+        wxStopWatch swTotal;
         // get list of dlls
         wxArrayString files;
         wxDir::GetAllFiles(pluginsDir, &files, fileSpec, wxDIR_FILES);
 
         // Sort the plugins by A-Z
         std::sort(files.begin(), files.end());
+
+        // In lazy mode, plugins that declare triggers are loaded only when one of their triggers fires
+        bool lazyActivation = clConfig::Get().Read("LazyPluginActivation", false);
         for(size_t i = 0; i < files.GetCount(); i++) {
 
             wxString fileName(files.Item(i));
@@ -176,6 +187,40 @@ void PluginManager::Load()
             }
 #endif
 
+            // Use the manifest from the previous run to avoid loading shared objects that are
+            // going to be rejected anyway (disabled plugins, wrong interface version etc)
+            size_t modified = wxFileName(fileName).GetModificationTime().GetTicks();
+            PluginInfoArray::ManifestEntry manifestEntry;
+            if(m_pluginsData.GetManifestEntry(fileName, modified, manifestEntry)) {
+                wxString pname = manifestEntry.name;
+                pname.MakeLower().Trim().Trim(false);
+                PluginInfo::PluginMap_t::const_iterator iter = m_pluginsData.GetPlugins().find(manifestEntry.name);
+                if(manifestEntry.interfaceVersion != PLUGIN_INTERFACE_VERSION) {
+                    CL_WARNING(wxString::Format(wxT("Version interface mismatch error for plugin '%s'. Plugin's "
+                                                    "interface version is '%d', CodeLite interface version is '%d'"),
+                                                fileName.c_str(), manifestEntry.interfaceVersion,
+                                                PLUGIN_INTERFACE_VERSION));
+                    continue;
+                } else if(manifestEntry.name.IsEmpty()) {
+                    // Not enough information, load the shared object
+                } else if(pp == CodeLiteApp::PP_FromList && allowedPlugins.Index(pname) == wxNOT_FOUND) {
+                    continue;
+                } else if(iter != m_pluginsData.GetPlugins().end() && !m_pluginsData.CanLoad(iter->second)) {
+                    CL_WARNING(wxT("Plugin ") + manifestEntry.name + wxT(" is not enabled"));
+                    continue;
+                } else if(lazyActivation && iter != m_pluginsData.GetPlugins().end() &&
+                          !iter->second.GetTriggers().IsEmpty()) {
+                    DeferredPlugin deferred;
+                    deferred.fileName = fileName;
+                    deferred.name = manifestEntry.name;
+                    deferred.triggers = iter->second.GetTriggers();
+                    m_deferredPlugins.push_back(deferred);
+                    clDEBUG() << "Plugin" << manifestEntry.name << "will be activated by one of:" << deferred.triggers;
+                    continue;
+                }
+            }
+
+            wxStopWatch sw;
             clDynamicLibrary* dl = new clDynamicLibrary();
             if(!dl->Load(fileName)) {
                 CL_ERROR(wxT("Failed to load plugin's dll: ") + fileName);
@@ -203,7 +248,10 @@ void PluginManager::Load()
                 if(!dl->GetError().IsEmpty()) { CL_WARNING(dl->GetError()); }
             }
 
+            manifestEntry.interfaceVersion = interface_version;
+            manifestEntry.modified = modified;
             if(interface_version != PLUGIN_INTERFACE_VERSION) {
+                m_pluginsData.SetManifestEntry(fileName, manifestEntry);
                 CL_WARNING(wxString::Format(wxT("Version interface mismatch error for plugin '%s'. Plugin's interface "
                                                 "version is '%d', CodeLite interface version is '%d'"),
                                             fileName.c_str(), interface_version, PLUGIN_INTERFACE_VERSION));
@@ -214,6 +262,10 @@ void PluginManager::Load()
             // Check if this dll can be loaded
             PluginInfo* pluginInfo = pfnGetPluginInfo();
 
+            // Remember the result for the next time
+            manifestEntry.name = pluginInfo->GetName();
+            m_pluginsData.SetManifestEntry(fileName, manifestEntry);
+
             wxString pname = pluginInfo->GetName();
             pname.MakeLower().Trim().Trim(false);
 
@@ -245,34 +297,18 @@ void PluginManager::Load()
             }
 
             // try and load the plugin
-            GET_PLUGIN_CREATE_FUNC pfn = (GET_PLUGIN_CREATE_FUNC)dl->GetSymbol(wxT("CreatePlugin"), &success);
-            if(!success) {
-                CL_WARNING(wxT("Failed to find CreatePlugin() in dll: ") + fileName);
-                if(!dl->GetError().IsEmpty()) { CL_WARNING(dl->GetError()); }
-
+            if(!DoCreatePlugin(dl, fileName, pluginInfo->GetName(), sw.Time())) {
                 m_pluginsData.DisablePlugin(pluginInfo->GetName());
                 continue;
             }
-
-            // Construct the plugin
-            IPlugin* plugin = pfn((IManager*)this);
-            CL_DEBUG(wxT("Loaded plugin: ") + plugin->GetLongName());
-            m_plugins[plugin->GetShortName()] = plugin;
-
-            // Load the toolbar
-            plugin->CreateToolBar(GetToolBar());
-
-            // Keep the dynamic load library
-            m_dl.push_back(dl);
         }
         clMainFrame::Get()->GetDockingManager().Update();
         GetToolBar()->Realize();
 
         // Let the plugins plug their menu in the 'Plugins' menu at the menu bar
         // the create menu will be placed as a sub menu of the 'Plugin' menu
-        wxMenu* pluginsMenu = NULL;
-        wxMenuItem* menuitem = clMainFrame::Get()->GetMenuBar()->FindItem(XRCID("manage_plugins"), &pluginsMenu);
-        if(pluginsMenu && menuitem) {
+        wxMenu* pluginsMenu = GetPluginsMenu();
+        if(pluginsMenu) {
             std::map<wxString, IPlugin*>::iterator iter = m_plugins.begin();
             for(; iter != m_plugins.end(); ++iter) {
                 IPlugin* plugin = iter->second;
@@ -282,6 +318,9 @@ void PluginManager::Load()
 
         // save the plugins data
         conf.WriteItem(&m_pluginsData);
+        clDEBUG() << "Loaded" << m_plugins.size() << "plugins in" << swTotal.Time() << "ms," << m_deferredPlugins.size()
+                  << "plugins are waiting for their triggers";
+        if(!m_deferredPlugins.empty()) { BindTriggers(); }
     }
 
     // Now that all the plugins are loaded, load from the configuration file
@@ -328,6 +367,132 @@ void PluginManager::Load()
     }
 }
 
+IPlugin* PluginManager::DoCreatePlugin(clDynamicLibrary* dl, const wxString& fileName, const wxString& name,
+                                      long loadTime)
+{
+    bool success(false);
+    GET_PLUGIN_CREATE_FUNC pfn = (GET_PLUGIN_CREATE_FUNC)dl->GetSymbol(wxT("CreatePlugin"), &success);
+    if(!success) {
+        CL_WARNING(wxT("Failed to find CreatePlugin() in dll: ") + fileName);
+        if(!dl->GetError().IsEmpty()) { CL_WARNING(dl->GetError()); }
+        wxDELETE(dl);
+        return NULL;
+    }
+
+    // Construct the plugin
+    wxStopWatch sw;
+    IPlugin* plugin = pfn((IManager*)this);
+    CL_DEBUG(wxT("Loaded plugin: ") + plugin->GetLongName());
+    m_plugins[plugin->GetShortName()] = plugin;
+    long createTime = sw.Time();
+
+    // Load the toolbar
+    sw.Start();
+    plugin->CreateToolBar(GetToolBar());
+    clDEBUG() << "Plugin" << name << ": load" << loadTime << "ms, create" << createTime << "ms, toolbar" << sw.Time()
+              << "ms";
+
+    // Keep the dynamic load library
+    m_dl.push_back(dl);
+    return plugin;
+}
+
+wxMenu* PluginManager::GetPluginsMenu() const
+{
+    wxMenu* pluginsMenu = NULL;
+    wxMenuItem* menuitem = clMainFrame::Get()->GetMenuBar()->FindItem(XRCID("manage_plugins"), &pluginsMenu);
+    return menuitem ? pluginsMenu : NULL;
+}
+
+void PluginManager::BindTriggers()
+{
+    EventNotifier::Get()->Bind(wxEVT_ACTIVE_EDITOR_CHANGED, &PluginManager::OnActiveEditorChangedTrigger, this);
+    EventNotifier::Get()->Bind(wxEVT_WORKSPACE_LOADED, &PluginManager::OnWorkspaceLoadedTrigger, this);
+    EventNotifier::Get()->Bind(wxEVT_BUILD_STARTING, &PluginManager::OnEventTrigger, this);
+    EventNotifier::Get()->Bind(wxEVT_DEBUG_STARTING, &PluginManager::OnEventTrigger, this);
+}
+
+void PluginManager::UnbindTriggers()
+{
+    EventNotifier::Get()->Unbind(wxEVT_ACTIVE_EDITOR_CHANGED, &PluginManager::OnActiveEditorChangedTrigger, this);
+    EventNotifier::Get()->Unbind(wxEVT_WORKSPACE_LOADED, &PluginManager::OnWorkspaceLoadedTrigger, this);
+    EventNotifier::Get()->Unbind(wxEVT_BUILD_STARTING, &PluginManager::OnEventTrigger, this);
+    EventNotifier::Get()->Unbind(wxEVT_DEBUG_STARTING, &PluginManager::OnEventTrigger, this);
+}
+
+void PluginManager::ActivateDeferredPlugins(const wxString& kind, const wxString& value)
+{
+    if(m_deferredPlugins.empty() || value.IsEmpty()) { return; }
+
+    // Collect the plugins waiting for this trigger. Workspace types may be translated, accept both forms
+    std::vector<DeferredPlugin> plugins;
+    std::vector<DeferredPlugin>::iterator iter = m_deferredPlugins.begin();
+    while(iter != m_deferredPlugins.end()) {
+        bool matched = false;
+        for(const wxString& trigger : iter->triggers) {
+            if(trigger.BeforeFirst(':') != kind) { continue; }
+            wxString triggerValue = trigger.AfterFirst(':');
+            if(triggerValue.CmpNoCase(value) == 0 || wxGetTranslation(triggerValue).CmpNoCase(value) == 0) {
+                matched = true;
+                break;
+            }
+        }
+        if(matched) {
+            plugins.push_back(*iter);
+            iter = m_deferredPlugins.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+    if(plugins.empty()) { return; }
+
+    wxMenu* pluginsMenu = GetPluginsMenu();
+    for(const DeferredPlugin& deferred : plugins) {
+        wxStopWatch sw;
+        clDynamicLibrary* dl = new clDynamicLibrary();
+        if(!dl->Load(deferred.fileName)) {
+            CL_ERROR(wxT("Failed to load plugin's dll: ") + deferred.fileName);
+            if(!dl->GetError().IsEmpty()) { CL_ERROR(dl->GetError()); }
+            wxDELETE(dl);
+            continue;
+        }
+
+        IPlugin* plugin = DoCreatePlugin(dl, deferred.fileName, deferred.name, sw.Time());
+        if(!plugin) { continue; }
+        if(pluginsMenu) { plugin->CreatePluginMenu(pluginsMenu); }
+        clDEBUG() << "Plugin" << deferred.name << "activated by" << kind + ":" + value;
+    }
+    clMainFrame::Get()->GetDockingManager().Update();
+    GetToolBar()->Realize();
+
+    if(m_deferredPlugins.empty()) { UnbindTriggers(); }
+}
+
+void PluginManager::OnActiveEditorChangedTrigger(wxCommandEvent& e)
+{
+    e.Skip();
+    IEditor* editor = GetActiveEditor();
+    if(editor) { ActivateDeferredPlugins("file", editor->GetFileName().GetExt()); }
+}
+
+void PluginManager::OnWorkspaceLoadedTrigger(wxCommandEvent& e)
+{
+    e.Skip();
+    if(clWorkspaceManager::Get().IsWorkspaceOpened()) {
+        ActivateDeferredPlugins("workspace", clWorkspaceManager::Get().GetWorkspace()->GetWorkspaceType());
+    }
+}
+
+void PluginManager::OnEventTrigger(wxEvent& e)
+{
+    e.Skip();
+    if(e.GetEventType() == wxEVT_BUILD_STARTING) {
+        ActivateDeferredPlugins("event", "build");
+    } else if(e.GetEventType() == wxEVT_DEBUG_STARTING) {
+        ActivateDeferredPlugins("event", "debug");
+    }
+}
+
 IEditor* PluginManager::GetActiveEditor()
 {
     if(clMainFrame::Get() && clMainFrame::Get()->GetMainBook()) {
@@ -342,6 +507,11 @@ IConfigTool* PluginManager::GetConfigTool() { return EditorConfigST::Get(); }
 
 void PluginManager::HookPopupMenu(wxMenu* menu, MenuType type)
 {
+    if(!m_deferredPlugins.empty()) {
+        static const wxString menuNames[] = { "explorer", "workspace", "project", "folder", "file", "editor" };
+        ActivateDeferredPlugins("menu", menuNames[type]);
+    }
+
     std::map<wxString, IPlugin*>::iterator iter = m_plugins.begin();
     for(; iter != m_plugins.end(); iter++) {
         iter->second->HookPopupMenu(menu, type);
@@ -363,6 +533,11 @@ TreeItemInfo PluginManager::GetSelectedTreeItemInfo(TreeType type)
 
 clTreeCtrl* PluginManager::GetWorkspaceTree() { return clMainFrame::Get()->GetWorkspaceTab()->GetFileView(); }
 
+wxArrayTreeItemIds PluginManager::GetWorkspaceTreeFileItems(const wxString& fullpath)
+{
+    return clMainFrame::Get()->GetWorkspaceTab()->GetFileView()->FindFileItems(fullpath);
+}
+
 clTreeCtrl* PluginManager::GetFileExplorerTree() { return clMainFrame::Get()->GetFileExplorer()->GetTree(); }
 
 Notebook* PluginManager::GetOutputPaneNotebook() { return clMainFrame::Get()->GetOutputPane()->GetNotebook(); }
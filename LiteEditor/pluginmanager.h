@@ -51,7 +51,17 @@ class clWorkspaceView;
 
 class PluginManager : public IManager
 {
+    /**
+     * @brief a plugin that was not loaded on startup, waiting for one of its triggers
+     */
+    struct DeferredPlugin {
+        wxString fileName;
+        wxString name;
+        wxArrayString triggers;
+    };
+
     std::map<wxString, IPlugin*> m_plugins;
+    std::vector<DeferredPlugin> m_deferredPlugins;
     std::list<clDynamicLibrary*> m_dl;
     PluginInfoArray m_pluginsData;
     BitmapLoader* m_bmpLoader;
@@ -63,6 +73,15 @@ private:
     PluginManager();
     virtual ~PluginManager();
 
+    IPlugin* DoCreatePlugin(clDynamicLibrary* dl, const wxString& fileName, const wxString& name, long loadTime);
+    wxMenu* GetPluginsMenu() const;
+    void BindTriggers();
+    void UnbindTriggers();
+    void ActivateDeferredPlugins(const wxString& kind, const wxString& value);
+    void OnActiveEditorChangedTrigger(wxCommandEvent& e);
+    void OnWorkspaceLoadedTrigger(wxCommandEvent& e);
+    void OnEventTrigger(wxEvent& e);
+
 public:
     static PluginManager* Get();
 
@@ -86,6 +105,7 @@ public:
     TreeItemInfo GetSelectedTreeItemInfo(TreeType type);
     clTreeCtrl* GetFileExplorerTree();
     clTreeCtrl* GetWorkspaceTree();
+    wxArrayTreeItemIds GetWorkspaceTreeFileItems(const wxString& fullpath);
     Notebook* GetOutputPaneNotebook();
     Notebook* GetWorkspacePaneNotebook();
     IEditor* OpenFile(const wxString& fileName, const wxString& projectName = wxEmptyString, int lineno = wxNOT_FOUND,
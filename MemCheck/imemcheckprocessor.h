@@ -93,6 +93,17 @@ public:
      * @brief Processes data from external tool (log file) to ErrorList.
      */
     virtual bool Process(const wxString& outputLogFileName = wxEmptyString) = 0;
+
+    /**
+     * @brief Forget the errors and the state of the log file processed so far.
+     */
+    virtual void Reset() { m_errorList.clear(); }
+
+    /**
+     * @brief Processes data appended to the log file since the last call (the tool may still be running).
+     * @return number of new errors added to ErrorList
+     */
+    virtual size_t Follow() { return 0; }
 };
 
 #endif //_IMEMCHECKPROCESSOR_H_
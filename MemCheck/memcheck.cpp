@@ -13,6 +13,7 @@
 #include "environmentconfig.h"
 #include "event_notifier.h"
 #include "file_logger.h"
+#include "fileutils.h"
 #include "workspace.h"
 
 #include "asyncprocess.h"
@@ -55,6 +56,8 @@ MemCheckPlugin::MemCheckPlugin(IManager* manager)
 {
     m_terminal.Bind(wxEVT_TERMINAL_COMMAND_EXIT, &MemCheckPlugin::OnProcessTerminated, this);
     m_terminal.Bind(wxEVT_TERMINAL_COMMAND_OUTPUT, &MemCheckPlugin::OnProcessOutput, this);
+    m_followTimer = new wxTimer(this);
+    Bind(wxEVT_TIMER, &MemCheckPlugin::OnFollowTimer, this, m_followTimer->GetId());
 
     // CL_DEBUG1(PLUGIN_PREFIX("MemCheckPlugin constructor"));
     m_longName = _("Detects memory management problems. Uses Valgrind - memcheck skin.");
@@ -185,6 +188,9 @@ void MemCheckPlugin::HookPopupMenu(wxMenu* menu, MenuType type)
 
 void MemCheckPlugin::UnPlug()
 {
+    m_followTimer->Stop();
+    Unbind(wxEVT_TIMER, &MemCheckPlugin::OnFollowTimer, this, m_followTimer->GetId());
+    wxDELETE(m_followTimer);
     m_tabHelper.reset(NULL);
     m_terminal.Unbind(wxEVT_TERMINAL_COMMAND_EXIT, &MemCheckPlugin::OnProcessTerminated, this);
     m_terminal.Unbind(wxEVT_TERMINAL_COMMAND_OUTPUT, &MemCheckPlugin::OnProcessOutput, this);
@@ -316,7 +322,6 @@ void MemCheckPlugin::CheckProject(const wxString& projectName)
     wxString wd;
     wxString command = PrepareCommand(projectName, wd);
 
-    m_outputView->Clear(); // To reduce the risk of confusion, clear any current errors before running
     DirSaver ds;
     EnvSetter envGuard(m_mgr->GetEnv());
     wxSetWorkingDirectory(path);
@@ -327,9 +332,17 @@ void MemCheckPlugin::CheckProject(const wxString& projectName)
     wxString cmd;
     wxString cmdArgs;
     m_memcheckProcessor->GetExecutionCommand(command, cmd, cmdArgs);
+
+    // To reduce the risk of confusion, clear any current errors before running. The log of the previous run is
+    // removed so we don't follow it until valgrind truncates it
+    m_memcheckProcessor->Reset();
+    m_outputView->LoadErrors();
+    const wxString& logFile = m_memcheckProcessor->GetOutputLogFileName();
+    if(!logFile.IsEmpty() && wxFileName::FileExists(logFile)) { clRemoveFile(logFile); }
     m_mgr->AppendOutputTabText(kOutputTab_Output, wxString()
                                                       << "MemCheck command: " << command << " " << cmdArgs << "\n");
     m_terminal.ExecuteConsole(cmd, true, cmdArgs, "", wxString::Format("MemCheck: %s", projectName));
+    m_followTimer->Start(1000);
 }
 
 void MemCheckPlugin::OnImportLog(wxCommandEvent& event)
@@ -376,15 +389,23 @@ void MemCheckPlugin::OnProcessOutput(clCommandEvent& event)
 
 void MemCheckPlugin::OnProcessTerminated(clCommandEvent& event)
 {
+    m_followTimer->Stop();
     m_mgr->AppendOutputTabText(kOutputTab_Output, _("\n-- MemCheck process completed\n"));
     wxBusyInfo wait(wxT(BUSY_MESSAGE));
     m_mgr->GetTheApp()->Yield();
 
-    m_memcheckProcessor->Process();
+    // Most of the log was already processed while the test was running, read the rest
+    m_memcheckProcessor->Follow();
     m_outputView->LoadErrors();
     SwitchToMyPage();
 }
 
+void MemCheckPlugin::OnFollowTimer(wxTimerEvent& event)
+{
+    if(!m_memcheckProcessor || !m_terminal.IsRunning()) return;
+    if(m_memcheckProcessor->Follow()) { m_outputView->AppendErrors(); }
+}
+
 void MemCheckPlugin::OnStopProcess(wxCommandEvent& event)
 {
     wxUnusedVar(event);
@@ -34,6 +34,7 @@
 #define _MEMCHECK_H_
 
 #include <wx/process.h>
+#include <wx/timer.h>
 
 #include "plugin.h"
 
@@ -98,6 +99,7 @@ protected:
     IMemCheckProcessor* m_memcheckProcessor;
     MemCheckSettings* m_settings;
     TerminalEmulator m_terminal;
+    wxTimer* m_followTimer; ///< Reads the log while the test is running
     MemCheckOutputView* m_outputView; ///< Main plugin UI pane.
     clTabTogglerHelper::Ptr_t m_tabHelper;
 
@@ -150,6 +152,7 @@ protected:
 
     void OnProcessOutput(clCommandEvent& event);
     void OnProcessTerminated(clCommandEvent& event);
+    void OnFollowTimer(wxTimerEvent& event);
 
     /**
      * @brief Analyse can be made independent of CodeLite and log can be load from file.
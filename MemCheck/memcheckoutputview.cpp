@@ -85,6 +85,38 @@ void MemCheckOutputView::LoadErrors()
     ApplyFilterSupp(FILTER_CLEAR);
 }
 
+void MemCheckOutputView::AppendErrors()
+{
+    size_t totalBefore = m_totalErrorsView;
+    ResetItemsView();
+    if(m_totalErrorsView <= totalBefore) return;
+
+    if(m_currentPage == 0) {
+        m_currentPage = 1;
+        pageValidator.TransferToWindow();
+    }
+
+    size_t pageSize = m_plugin->GetSettings()->GetResultPageSize();
+    size_t iStart = std::max((m_currentPage - 1) * pageSize, totalBefore);
+    size_t iStop = std::min(m_totalErrorsView, m_currentPage * pageSize);
+    if(iStart >= iStop) return; // current page is already full
+
+    unsigned int flags = 0;
+    if(m_plugin->GetSettings()->GetOmitNonWorkspace()) flags |= MC_IT_OMIT_NONWORKSPACE;
+    if(m_plugin->GetSettings()->GetOmitDuplications()) flags |= MC_IT_OMIT_DUPLICATIONS;
+    if(m_plugin->GetSettings()->GetOmitSuppressed()) flags |= MC_IT_OMIT_SUPPRESSED;
+
+    ErrorList& errorList = m_plugin->GetProcessor()->GetErrors();
+    size_t i = 0;
+    MemCheckIterTools::ErrorListIterator it = MemCheckIterTools::Factory(errorList, m_workspacePath, flags);
+    for(; i < iStart && it != errorList.end(); ++i, ++it)
+        ; // skipping items already shown
+    for(; i < iStop && it != errorList.end(); ++i, ++it) {
+        AddTree(wxDataViewItem(0), *it);
+    }
+    m_currentPageIsEmptyView = false;
+}
+
 void MemCheckOutputView::ResetItemsView()
 {
     ErrorList& errorList = m_plugin->GetProcessor()->GetErrors();
@@ -171,6 +171,13 @@ public:
      * MemCheck plugin calls this method after test ends and after processor parses logfile into ErrorList.
      */
     void LoadErrors();
+
+    /**
+     * @brief Show errors appended to ErrorList since the last LoadErrors() / AppendErrors() call.
+     *
+     * Used while the test is still running. Only the current page is filled, page count is updated.
+     */
+    void AppendErrors();
     /**
      * @brief clear the content
      */
@@ -5,6 +5,7 @@
  * @copyright GNU General Public License v2
  */
 
+#include <wx/ffile.h>
 #include <wx/stdpaths.h>
 #include <wx/textfile.h>
 
@@ -17,6 +18,10 @@
 
 ValgrindMemcheckProcessor::ValgrindMemcheckProcessor(MemCheckSettings* const settings)
     : IMemCheckProcessor(settings)
+    , m_parsedBytes(0)
+    , m_validRoot(false)
+    , m_following(false)
+    , m_auxiliary(false)
 {
     // CL_DEBUG1(PLUGIN_PREFIX("ValgrindMemcheckProcessor created"));
 }
@@ -65,137 +70,251 @@ bool ValgrindMemcheckProcessor::Process(const wxString& outputLogFileName)
 {
     // CL_DEBUG1(PLUGIN_PREFIX("ValgrindMemcheckProcessor::Process()"));
 
+    // Follow() yields while parsing, don't wipe its state from under it
+    if(m_following) {
+        CL_WARNING(PLUGIN_PREFIX("Valgrind log is being parsed, try again later"));
+        return false;
+    }
+
     if(!outputLogFileName.IsEmpty()) m_outputLogFileName = outputLogFileName;
 
     CL_DEBUG(PLUGIN_PREFIX("Processing file '%s'", m_outputLogFileName));
 
-    wxXmlDocument doc;
-    if(!doc.Load(m_outputLogFileName) || doc.GetRoot()->GetName() != wxT("valgrindoutput")) {
+    Reset();
+    Follow();
+    if(!m_validRoot) {
         CL_WARNING("Error while loading file '%s'", m_outputLogFileName);
         return false;
     }
-    m_errorList.clear();
-
-    int i = 0;
-    wxXmlNode* errorNode = doc.GetRoot()->GetChildren();
-    while(errorNode) {
-        if(errorNode->GetName() == wxT("error")) { m_errorList.push_back(ProcessError(doc, errorNode)); }
-        errorNode = errorNode->GetNext();
-
-        if(i < 1000)
-            i++;
-        else {
-            i = 0;
-            // ATTN  m_mgr->GetTheApp()
-            wxTheApp->Yield();
+    return true;
+}
+
+void ValgrindMemcheckProcessor::Reset()
+{
+    IMemCheckProcessor::Reset();
+    m_parsedBytes = 0;
+    m_pending.clear();
+    m_text.clear();
+    m_elements.clear();
+    m_validRoot = false;
+    m_auxiliary = false;
+    m_frames.clear();
+}
+
+size_t ValgrindMemcheckProcessor::Follow()
+{
+    // we yield while parsing, make sure we are not called again meanwhile
+    if(m_following) return 0;
+
+    wxFFile fp(m_outputLogFileName, "rb");
+    if(!fp.IsOpened()) return 0;
+
+    wxFileOffset fileSize = fp.Length();
+    if(fileSize < m_parsedBytes) {
+        // the log was replaced, start over
+        Reset();
+    }
+    if(fileSize == m_parsedBytes || !fp.Seek(m_parsedBytes)) return 0;
+
+    m_following = true;
+    size_t newErrors = 0;
+    std::vector<char> buffer(1024 * 1024);
+    size_t bytes = 0;
+    while((bytes = fp.Read(buffer.data(), buffer.size())) > 0) {
+        m_parsedBytes += bytes;
+        newErrors += ParseChunk(buffer.data(), bytes);
+        if(fp.Eof()) break;
+        // ATTN  m_mgr->GetTheApp()
+        wxTheApp->Yield();
+    }
+    m_following = false;
+    return newErrors;
+}
+
+size_t ValgrindMemcheckProcessor::ParseChunk(const char* data, size_t len)
+{
+    // Valgrind's xml is simple: no attributes (except for the declaration), no CDATA. So a minimal stream
+    // parser is enough and it does not need to hold the whole document in memory
+    m_pending.append(data, len);
+
+    size_t newErrors = 0;
+    size_t pos = 0;
+    while(pos < m_pending.length()) {
+        if(m_pending[pos] != '<') {
+            size_t lt = m_pending.find('<', pos);
+            if(lt == std::string::npos) lt = m_pending.length();
+            m_text.append(m_pending, pos, lt - pos);
+            pos = lt;
+            continue;
         }
+
+        if(m_pending.compare(pos, 4, "<!--") == 0) {
+            size_t end = m_pending.find("-->", pos + 4);
+            if(end == std::string::npos) break; // incomplete comment
+            pos = end + 3;
+            continue;
+        }
+
+        size_t gt = m_pending.find('>', pos);
+        if(gt == std::string::npos) break; // incomplete tag, wait for more data
+
+        char c = (pos + 1 < gt) ? m_pending[pos + 1] : '\0';
+        if(c == '?' || c == '!') {
+            // declaration, doctype
+        } else if(c == '/') {
+            std::string name = m_pending.substr(pos + 2, gt - pos - 2);
+            size_t ws = name.find_first_of(" \t\r\n");
+            if(ws != std::string::npos) name.erase(ws);
+            if(OnEndElement(name)) ++newErrors;
+        } else {
+            bool selfClosing = m_pending[gt - 1] == '/';
+            size_t nameEnd = m_pending.find_first_of(" \t\r\n/>", pos + 1);
+            std::string name = m_pending.substr(pos + 1, nameEnd - pos - 1);
+            OnStartElement(name);
+            if(selfClosing && OnEndElement(name)) ++newErrors;
+        }
+        pos = gt + 1;
     }
-    return true;
+    m_pending.erase(0, pos);
+    return newErrors;
 }
 
-MemCheckError ValgrindMemcheckProcessor::ProcessError(wxXmlDocument& doc, wxXmlNode* errorNode)
+void ValgrindMemcheckProcessor::OnStartElement(const std::string& name)
 {
-    // CL_DEBUG1(PLUGIN_PREFIX("ValgrindMemcheckProcessor::ProcessError()"));
+    m_elements.push_back(name);
+    m_text.clear();
 
-    bool auxiliary = false;
-    MemCheckError result;
-    result.type = MemCheckError::TYPE_ERROR;
-    MemCheckError auxiliaryResult;
+    if(m_elements.size() == 1) {
+        m_validRoot = (name == "valgrindoutput");
+    } else if(name == "error" && m_elements.size() == 2) {
+        m_currentError = MemCheckError();
+        m_currentError.type = MemCheckError::TYPE_ERROR;
+        m_currentAuxiliary = MemCheckError();
+        m_auxiliary = false;
+    } else if(name == "frame") {
+        m_frameObj.clear();
+        m_frameFn.clear();
+        m_frameDir.clear();
+        m_frameFile.clear();
+        m_frameLine.clear();
+    }
+}
 
-    wxXmlNode* suberrorNode = errorNode->GetChildren();
-    while(suberrorNode) {
+bool ValgrindMemcheckProcessor::OnEndElement(const std::string& name)
+{
+    if(m_elements.empty()) return false;
+    m_elements.pop_back();
 
+    bool errorCompleted = false;
+    // only errors directly under the root element are processed
+    bool inError = m_elements.size() >= 2 && m_elements[1] == "error";
+    const std::string& parent = m_elements.empty() ? std::string() : m_elements.back();
+    if(name == "error" && m_elements.size() == 1) {
+        if(!m_currentError.suppression)
+            m_currentError.suppression = wxT("#Suppresion pattern not present in output log.\n#This plugin requires "
+                                             "Valgrind to be run with '--gen-suppressions=all' option");
+        if(m_auxiliary) m_currentError.nestedErrors.push_back(m_currentAuxiliary);
+        m_errorList.push_back(m_currentError);
+        errorCompleted = true;
+
+    } else if(inError) {
         // retrieving error label
-        if(suberrorNode->GetName() == wxT("what")) {
-            result.label = suberrorNode->GetNodeContent();
-        } else if(suberrorNode->GetName() == wxT("xwhat")) {
-            wxXmlNode* child = suberrorNode->GetChildren();
-            while(child) {
-                if(child->GetName() == wxT("text")) {
-                    result.label = child->GetNodeContent();
-                    break;
-                }
-                child = child->GetNext();
-            }
-        } else if(suberrorNode->GetName() == wxT("auxwhat")) {
-            auxiliaryResult.label = suberrorNode->GetNodeContent();
-            auxiliaryResult.type = MemCheckError::TYPE_AUXILIARY;
-            auxiliary = true;
-        } else if(suberrorNode->GetName() == wxT("stack")) {
-            wxXmlNode* locationNode = suberrorNode->GetChildren();
-            while(locationNode) {
-                if(locationNode->GetName() == wxT("frame")) {
-                    if(auxiliary) {
-                        auxiliaryResult.locations.push_back(ProcessLocation(doc, locationNode));
-                    } else {
-                        result.locations.push_back(ProcessLocation(doc, locationNode));
-                    }
-                }
-                locationNode = locationNode->GetNext();
+        if(name == "what" && parent == "error") {
+            m_currentError.label = Decode(m_text);
+        } else if(name == "text" && parent == "xwhat") {
+            m_currentError.label = Decode(m_text);
+        } else if(name == "auxwhat" && parent == "error") {
+            m_currentAuxiliary.label = Decode(m_text);
+            m_currentAuxiliary.type = MemCheckError::TYPE_AUXILIARY;
+            m_auxiliary = true;
+        } else if(name == "frame" && parent == "stack") {
+            if(m_auxiliary) {
+                m_currentAuxiliary.locations.push_back(GetFrameLocation());
+            } else {
+                m_currentError.locations.push_back(GetFrameLocation());
             }
-        } else if(suberrorNode->GetName() == wxT("suppression")) {
-            wxXmlNode* child = suberrorNode->GetChildren();
-            while(child) {
-                if(child->GetName() == wxT("rawtext")) {
-                    result.suppression = child->GetNodeContent();
-                    break;
-                }
-                child = child->GetNext();
+        } else if(parent == "frame") {
+            if(name == "obj") {
+                m_frameObj.swap(m_text);
+            } else if(name == "fn") {
+                m_frameFn.swap(m_text);
+            } else if(name == "dir") {
+                m_frameDir.swap(m_text);
+            } else if(name == "file") {
+                m_frameFile.swap(m_text);
+            } else if(name == "line") {
+                m_frameLine.swap(m_text);
             }
+        } else if(name == "rawtext" && parent == "suppression") {
+            m_currentError.suppression = Decode(m_text);
         }
-        suberrorNode = suberrorNode->GetNext();
     }
+    m_text.clear();
+    return errorCompleted;
+}
 
-    if(!result.suppression)
-        result.suppression = wxT("#Suppresion pattern not present in output log.\n#This plugin requires Valgrind to be "
-                                 "run with '--gen-suppressions=all' option");
+const MemCheckErrorLocation& ValgrindMemcheckProcessor::GetFrameLocation()
+{
+    std::string key;
+    key.reserve(m_frameObj.length() + m_frameFn.length() + m_frameDir.length() + m_frameFile.length() +
+                m_frameLine.length() + 4);
+    key.append(m_frameObj).append(1, '\0').append(m_frameFn).append(1, '\0').append(m_frameDir).append(1, '\0');
+    key.append(m_frameFile).append(1, '\0').append(m_frameLine);
 
-    if(auxiliary) result.nestedErrors.push_back(auxiliaryResult);
+    auto iter = m_frames.find(key);
+    if(iter != m_frames.end()) return iter->second;
 
-    // TODO ? add checout ?
-    // add check for empty locationArrays
-    //  CL_DEBUG1(PLUGIN_PREFIX("\t equal #0 and #1 = %s", (errorArray.Item(0) == errorArray.Item(1)?"true":"false") ));
-    //  CL_DEBUG1(PLUGIN_PREFIX("\t equal #1 and #2 = %s", (*(errorArray.Item(2)) ==
-    //  *(errorArray.Item(1))?"true":"false") )); CL_DEBUG1(PLUGIN_PREFIX("\t equal #2 and #3 = %s", (errorArray.Item(2)
-    //  == errorArray.Item(3)?"true":"false") ));
+    MemCheckErrorLocation result;
+    result.line = m_frameLine.empty() ? -1 : atoi(m_frameLine.c_str());
+    result.obj = Decode(m_frameObj);
+    result.func = Decode(m_frameFn);
 
-    // check if required fields was found
-    //  CL_ERROR1(PLUGIN_PREFIX("Broken input, tag <what> or <xwhat> not found, can't continue!"));
-    //  CL_ERROR1(PLUGIN_PREFIX("Broken input, tag <stack> not found, can't continue!"));
-    return result;
+    wxString dir = Decode(m_frameDir);
+    if(!dir.IsEmpty() && !dir.EndsWith(wxT("/"))) dir.Append(wxT("/"));
+    result.file = dir + Decode(m_frameFile);
+
+    // TODO ? add checkout ?
+    return m_frames.insert({ key, result }).first->second;
 }
 
-MemCheckErrorLocation ValgrindMemcheckProcessor::ProcessLocation(wxXmlDocument& doc, wxXmlNode* locationNode)
+wxString ValgrindMemcheckProcessor::Decode(const std::string& text)
 {
-    // CL_DEBUG1(PLUGIN_PREFIX("ValgrindMemcheckProcessor::ProcessLocation()"));
+    if(text.find('&') == std::string::npos) return wxString::FromUTF8(text.c_str(), text.length());
 
-    MemCheckErrorLocation result;
-    result.line = -1;
-    wxString file;
-    wxString dir;
-
-    wxXmlNode* subframeNode = locationNode->GetChildren();
-    while(subframeNode) {
-
-        if(subframeNode->GetName() == wxT("ip")) {
-            // ignoring
-        } else if(subframeNode->GetName() == wxT("obj")) {
-            result.obj = subframeNode->GetNodeContent();
-        } else if(subframeNode->GetName() == wxT("fn")) {
-            result.func = subframeNode->GetNodeContent();
-        } else if(subframeNode->GetName() == wxT("dir")) {
-            dir = subframeNode->GetNodeContent();
-        } else if(subframeNode->GetName() == wxT("file")) {
-            file = subframeNode->GetNodeContent();
-        } else if(subframeNode->GetName() == wxT("line")) {
-            result.line = wxAtoi(subframeNode->GetNodeContent());
+    std::string decoded;
+    decoded.reserve(text.length());
+    for(size_t i = 0; i < text.length(); ++i) {
+        if(text[i] != '&') {
+            decoded.append(1, text[i]);
+            continue;
+        }
+        size_t semi = text.find(';', i);
+        if(semi == std::string::npos) {
+            decoded.append(text, i, std::string::npos);
+            break;
         }
-        subframeNode = subframeNode->GetNext();
+        std::string entity = text.substr(i + 1, semi - i - 1);
+        if(entity == "lt") {
+            decoded.append(1, '<');
+        } else if(entity == "gt") {
+            decoded.append(1, '>');
+        } else if(entity == "amp") {
+            decoded.append(1, '&');
+        } else if(entity == "quot") {
+            decoded.append(1, '"');
+        } else if(entity == "apos") {
+            decoded.append(1, '\'');
+        } else if(!entity.empty() && entity[0] == '#') {
+            unsigned long code = (entity.length() > 1 && (entity[1] == 'x' || entity[1] == 'X'))
+                                     ? strtoul(entity.c_str() + 2, NULL, 16)
+                                     : strtoul(entity.c_str() + 1, NULL, 10);
+            wxString ch((wxUniChar)code);
+            decoded.append(ch.utf8_str().data());
+        } else {
+            // unknown entity, keep it as is
+            decoded.append(text, i, semi - i + 1);
+        }
+        i = semi;
     }
-
-    if(!dir.IsEmpty() && !dir.EndsWith(wxT("/"))) dir.Append(wxT("/"));
-    result.file = dir + file;
-
-    // TODO ? add checkout ?
-    return result;
+    return wxString::FromUTF8(decoded.c_str(), decoded.length());
 }
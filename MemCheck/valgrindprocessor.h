@@ -34,7 +34,9 @@
 #define _VALGRINDPROCESSOR_H_
 
 #include "imemcheckprocessor.h"
-#include <wx/xml/xml.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 /**
  * @class ValgrindMemcheckProcessor
@@ -74,29 +76,65 @@ public:
      * @param outputLogFileName
      * @return
      *
-     * Loads Valgrind's xml log to wxXmlDocument, and goes trought nodes
+     * Parses the whole Valgrind's xml log from the beginning
      */
     virtual bool Process(const wxString& outputLogFileName = wxEmptyString);
 
+    /**
+     * @brief interface implementation
+     */
+    virtual void Reset();
+
+    /**
+     * @brief interface implementation
+     * @return number of new errors
+     *
+     * The log is read in chunks and parsed as a stream, only complete errors are added to the ErrorList. The parser
+     * state is kept between calls so the log can be followed while valgrind is still writing it.
+     */
+    virtual size_t Follow();
+
 protected:
     /**
-     * @brief creates one MemCheckError object
-     * @param doc whole log document
-     * @param errorNode reference to current processed node in that doc file
-     * @return MemCheckError object
+     * @brief feeds a chunk of the log to the parser
+     * @return number of errors completed by this chunk
+     */
+    size_t ParseChunk(const char* data, size_t len);
+    void OnStartElement(const std::string& name);
+
+    /**
+     * @brief builds MemCheckError / MemCheckErrorLocation objects out of the closed element
+     * @return true if an error was completed
      *
      * Auxiliary section is not in subnode. First part of the node describes particular error, second part describes
      * auxiliary info. For auxiliary is created sub MemCheckError object.
      */
-    MemCheckError ProcessError(wxXmlDocument& doc, wxXmlNode* errorNode);
+    bool OnEndElement(const std::string& name);
 
     /**
-     * @brief creates one MemCheckErrorLocation object
-     * @param doc whole log document
-     * @param locationNode reference to current processed node in that doc file
-     * @return MemCheckErrorLocation object
+     * @brief creates one MemCheckErrorLocation object from the current frame. Frames repeat a lot in the log,
+     * so each distinct frame is decoded only once
      */
-    MemCheckErrorLocation ProcessLocation(wxXmlDocument& doc, wxXmlNode* locationNode);
+    const MemCheckErrorLocation& GetFrameLocation();
+
+    static wxString Decode(const std::string& text);
+
+    wxFileOffset m_parsedBytes;
+    std::string m_pending;
+    std::string m_text;
+    std::vector<std::string> m_elements;
+    bool m_validRoot;
+    bool m_following;
+
+    bool m_auxiliary;
+    MemCheckError m_currentError;
+    MemCheckError m_currentAuxiliary;
+    std::string m_frameObj;
+    std::string m_frameFn;
+    std::string m_frameDir;
+    std::string m_frameFile;
+    std::string m_frameLine;
+    std::unordered_map<std::string, MemCheckErrorLocation> m_frames;
 };
 
 #endif // _VALGRINDPROCESSOR_H_
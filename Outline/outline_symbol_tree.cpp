@@ -36,6 +36,8 @@
 #include "imanager.h"
 #include "outline_symbol_tree.h"
 #include <algorithm>
+#include <unordered_set>
+#include <vector>
 
 //#include "manager.h"
 //#include "frame.h"
@@ -315,9 +317,19 @@ wxString svSymbolTree::GetActiveEditorFile() const
 void svSymbolTree::DoBuildTree(TagEntryPtrVector_t& tags, const wxFileName& filename)
 {
     if(!m_sortByLineNumber) {
-        std::sort(tags.begin(), tags.end(), [&](TagEntryPtr t1, TagEntryPtr t2) {
-            return t1->GetDisplayName().Lower() < t2->GetDisplayName().Lower();
-        });
+        // Lower the names once, not on every comparison
+        std::vector<std::pair<wxString, TagEntryPtr> > sorted;
+        sorted.reserve(tags.size());
+        for(TagEntryPtr tag : tags) {
+            sorted.push_back({ tag->GetDisplayName().Lower(), tag });
+        }
+        std::stable_sort(sorted.begin(), sorted.end(),
+                         [](const std::pair<wxString, TagEntryPtr>& p1, const std::pair<wxString, TagEntryPtr>& p2) {
+                             return p1.first < p2.first;
+                         });
+        for(size_t i = 0; i < sorted.size(); ++i) {
+            tags[i] = sorted[i].second;
+        }
     }
     clDEBUG() << "Outline: DoBuildTree is called";
     if(TagsManagerST::Get()->AreTheSame(m_currentTags, tags)) {
@@ -325,14 +337,28 @@ void svSymbolTree::DoBuildTree(TagEntryPtrVector_t& tags, const wxFileName& file
         return;
     }
     wxWindowUpdateLocker locker(this);
-    SymbolTree::BuildTree(filename, tags, false);
 
+    // Remember the top level items so we only expand the new ones. The others keep their state
+    std::unordered_set<wxString> topLevelKeys;
     wxTreeItemId root = GetRootItem();
+    wxTreeItemIdValue cookie;
+    if(root.IsOk() && ItemHasChildren(root)) {
+        wxTreeItemId child = GetFirstChild(root, cookie);
+        while(child.IsOk()) {
+            MyTreeItemData* data = dynamic_cast<MyTreeItemData*>(GetItemData(child));
+            if(data) { topLevelKeys.insert(data->GetKey()); }
+            child = GetNextChild(root, cookie);
+        }
+    }
+
+    bool incremental = SymbolTree::UpdateTree(filename, tags);
+
+    root = GetRootItem();
     if(root.IsOk() && ItemHasChildren(root)) {
-        wxTreeItemIdValue cookie;
         wxTreeItemId child = GetFirstChild(root, cookie);
         while(child.IsOk()) {
-            Expand(child);
+            MyTreeItemData* data = dynamic_cast<MyTreeItemData*>(GetItemData(child));
+            if(!incremental || !data || topLevelKeys.count(data->GetKey()) == 0) { Expand(child); }
             child = GetNextChild(root, cookie);
         }
     }
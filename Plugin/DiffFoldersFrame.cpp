@@ -15,6 +15,9 @@
 #include <macros.h>
 #include "globals.h"
 #include <atomic>
+#include <cstring>
+#include <vector>
+#include <wx/thread.h>
 
 static int nCallCounter = 0;
 static std::atomic_bool checksumThreadStop;
@@ -82,10 +85,7 @@ void DiffFoldersFrame::OnNewCmparison(wxCommandEvent& event)
 
 static bool CompareFilesCheckSum(const wxString& fn1, const wxString& fn2)
 {
-    // The sizes are the same
-    unsigned char checksum1 = 0;
-    unsigned char checksum2 = 0;
-
+    // The sizes are the same, compare the content in chunks
     FILE* fp1 = fopen(fn1.mb_str(), "rb");
     FILE* fp2 = fopen(fn2.mb_str(), "rb");
     if(!fp1 || !fp2) {
@@ -94,37 +94,74 @@ static bool CompareFilesCheckSum(const wxString& fn1, const wxString& fn2)
         return false;
     }
 
-    while(!feof(fp1) && !ferror(fp1) && !feof(fp2) && !ferror(fp2)) {
-        checksum1 ^= fgetc(fp1);
-        checksum2 ^= fgetc(fp2);
-        if(checksum1 != checksum2) { break; }
+    static const size_t CHUNK_SIZE = 64 * 1024;
+    std::vector<char> buffer1(CHUNK_SIZE);
+    std::vector<char> buffer2(CHUNK_SIZE);
+    bool isSame = true;
+    while(isSame && !checksumThreadStop.load()) {
+        size_t count1 = fread(buffer1.data(), 1, CHUNK_SIZE, fp1);
+        size_t count2 = fread(buffer2.data(), 1, CHUNK_SIZE, fp2);
+        if(count1 != count2 || ferror(fp1) || ferror(fp2)) {
+            isSame = false;
+        } else if(count1 == 0) {
+            break;
+        } else {
+            isSame = (memcmp(buffer1.data(), buffer2.data(), count1) == 0);
+        }
     }
     CLOSE_FP(fp1);
     CLOSE_FP(fp2);
-    return (checksum1 == checksum2);
+    return isSame;
+}
+
+static wxString HelperCompareItem(const wxString& item, const wxString& left, const wxString& right)
+{
+    wxFileName fnLeft(left, item);
+    wxFileName fnRight(right, item);
+    if(fnLeft.IsOk() && fnLeft.FileExists() && fnRight.IsOk() && fnRight.FileExists()) {
+        if(fnLeft.GetSize() != fnRight.GetSize()) {
+            // If the size is different, no need to go further
+            return "different";
+        }
+        bool isSame = CompareFilesCheckSum(fnLeft.GetFullPath(), fnRight.GetFullPath());
+        return isSame ? "same" : "different";
+    }
+    return "n/a"; // Dont know
 }
 
 static void HelperThreadCalculateChecksum(int callId, const wxArrayString& items, const wxString& left,
                                           const wxString& right, DiffFoldersFrame* sink)
 {
-    wxArrayString results;
-    for(size_t i = 0; i < items.size(); ++i) {
-        if(checksumThreadStop.load()) { break; }
-        wxFileName fnLeft(left, items.Item(i));
-        wxFileName fnRight(right, items.Item(i));
-        if(fnLeft.IsOk() && fnLeft.FileExists() && fnRight.IsOk() && fnRight.FileExists()) {
-            if(fnLeft.GetSize() != fnRight.GetSize()) {
-                // If the size is different, no need to go further
-                results.Add("different");
-            } else {
-                bool isSame = CompareFilesCheckSum(fnLeft.GetFullPath(), fnRight.GetFullPath());
-                results.Add(isSame ? "same" : "different");
-            }
-        } else {
-            results.Add("n/a"); // Dont know
+    // Compare the files using a pool of workers. Each worker picks the next item
+    // and writes the answer into its own slot, so no locking is needed
+    std::vector<wxString> answers(items.size());
+    std::atomic_size_t nextItem(0);
+    auto worker = [&]() {
+        while(!checksumThreadStop.load()) {
+            size_t i = nextItem.fetch_add(1);
+            if(i >= items.size()) { break; }
+            answers[i] = HelperCompareItem(items.Item(i), left, right);
         }
+    };
+
+    size_t workersCount = wxMax(1, wxThread::GetCPUCount());
+    workersCount = wxMin(workersCount, items.size());
+    std::vector<std::thread> workers;
+    for(size_t i = 1; i < workersCount; ++i) {
+        workers.push_back(std::thread(worker));
+    }
+    worker();
+    for(std::thread& t : workers) {
+        t.join();
     }
-    if(!checksumThreadStop.load()) { sink->CallAfter(&DiffFoldersFrame::OnChecksum, callId, results); }
+
+    if(checksumThreadStop.load()) { return; }
+    wxArrayString results;
+    results.reserve(answers.size());
+    for(const wxString& answer : answers) {
+        results.Add(answer);
+    }
+    sink->CallAfter(&DiffFoldersFrame::OnChecksum, callId, results);
 }
 
 void DiffFoldersFrame::BuildTrees(const wxString& left, const wxString& right)
@@ -335,7 +372,7 @@ void DiffFoldersFrame::OnRefreshUI(wxUpdateUIEvent& event)
 
 void DiffFoldersFrame::StopChecksumThread()
 {
-    checksumThreadStop.store(false);
+    checksumThreadStop.store(true);
     if(m_checksumThread) { m_checksumThread->join(); }
     checksumThreadStop.store(false);
     wxDELETE(m_checksumThread);
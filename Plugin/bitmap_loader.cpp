@@ -41,9 +41,11 @@
 #include "clSystemSettings.h"
 #include <wx/msgdlg.h>
 #include "clFilesCollector.h"
+#include <wx/stopwatch.h>
 
 std::unordered_map<wxString, wxBitmap> BitmapLoader::m_toolbarsBitmaps;
 std::unordered_map<wxString, wxString> BitmapLoader::m_manifest;
+std::unordered_map<wxString, wxMemoryBuffer> BitmapLoader::m_pngBuffers;
 
 BitmapLoader::~BitmapLoader() {}
 
@@ -64,7 +66,35 @@ const wxBitmap& BitmapLoader::LoadBitmap(const wxString& name, int requestedSize
         const wxBitmap& b = iter->second;
         return b;
     }
-    return wxNullBitmap;
+    return DoDecodeBitmap(newName);
+}
+
+const wxBitmap& BitmapLoader::DoDecodeBitmap(const wxString& name)
+{
+    auto iter = m_pngBuffers.find(name);
+    if(iter == m_pngBuffers.end()) { return wxNullBitmap; }
+
+    wxString hiResName = name + "@2x";
+    std::function<bool(const wxString&, void**, size_t&)> fnGetHiResVersion = [&](const wxString& key, void** ppData,
+                                                                                  size_t& nLen) {
+        auto hiResIter = m_pngBuffers.find(key);
+        if(hiResIter == m_pngBuffers.end()) { return false; }
+        *ppData = hiResIter->second.GetData();
+        nLen = hiResIter->second.GetDataLen();
+        return true;
+    };
+
+    clBitmap bmp;
+    wxMemoryInputStream is(iter->second.GetData(), iter->second.GetDataLen());
+    bool loaded = bmp.LoadPNGFromMemory(name, is, fnGetHiResVersion);
+
+    // We only decode an image once: release the PNG data
+    m_pngBuffers.erase(name);
+    m_pngBuffers.erase(hiResName);
+    if(!loaded) { return wxNullBitmap; }
+
+    clDEBUG1() << "Adding new image:" << name;
+    return m_toolbarsBitmaps.insert({ name, bmp }).first->second;
 }
 
 int BitmapLoader::GetMimeImageId(int type) { return GetMimeBitmaps().GetIndex(type); }
@@ -124,44 +154,19 @@ void BitmapLoader::initialize()
     }
 #else
     if(fnNewZip.FileExists()) {
+        // Only extract the PNG files here, they are decoded on demand (see LoadBitmap)
+        wxStopWatch sw;
         clZipReader zip(fnNewZip);
-        // Extract all images into this memory
-        std::unordered_map<wxString, clZipReader::Entry> buffers;
+        std::unordered_map<wxString, wxMemoryBuffer> buffers;
         zip.ExtractAll(buffers);
-
-        std::function<bool(const wxString&, void**, size_t&)> fnGetHiResVersion = [&](const wxString& name,
-                                                                                      void** ppData, size_t& nLen) {
-            wxString key;
-            key << name << ".png";
-            if(buffers.count(key)) {
-                *ppData = buffers[key].buffer;
-                nLen = buffers[key].len;
-                return true;
-            }
-            return false;
-        };
-
         for(const auto& entry : buffers) {
-            if(!entry.first.EndsWith(".png")) { continue; }
-
+            if(!entry.first.EndsWith(".png") || entry.second.IsEmpty()) { continue; }
             wxString name = wxFileName(entry.first).GetName();
-            clZipReader::Entry d = entry.second;
-            if(d.len && d.buffer) {
-                wxMemoryInputStream is(d.buffer, d.len);
-                clBitmap bmp;
-                if(bmp.LoadPNGFromMemory(name, is, fnGetHiResVersion)) {
-                    clDEBUG1() << "Adding new image:" << name;
-                    m_toolbarsBitmaps.erase(name);
-                    m_toolbarsBitmaps.insert({ name, bmp });
-                }
-            }
-        }
-
-        // Free the memory
-        for(const auto& entry : buffers) {
-            if(entry.second.buffer && entry.second.len) { free(entry.second.buffer); }
+            m_toolbarsBitmaps.erase(name);
+            m_pngBuffers.erase(name);
+            m_pngBuffers.insert({ name, entry.second });
         }
-        buffers.clear();
+        clDEBUG() << "BitmapLoader: indexed" << m_pngBuffers.size() << "images in" << sw.Time() << "ms";
     }
 #endif
     // Create the mime-list
@@ -31,6 +31,7 @@
 #include "wxStringHash.h"
 #include <vector>
 #include <wx/bitmap.h>
+#include <wx/buffer.h>
 #include <wx/filename.h>
 #include <wx/imaglist.h>
 
@@ -106,6 +107,9 @@ public:
 protected:
     wxFileName m_zipPath;
     static std::unordered_map<wxString, wxBitmap> m_toolbarsBitmaps;
+    // The PNG files extracted from the bitmaps archive. They are decoded
+    // (and moved into m_toolbarsBitmaps) the first time they are requested
+    static std::unordered_map<wxString, wxMemoryBuffer> m_pngBuffers;
     static std::unordered_map<wxString, wxString> m_manifest;
     std::unordered_map<FileExtManager::FileType, int> m_fileIndexMap;
     bool m_bMapPopulated;
@@ -158,6 +162,7 @@ protected:
 
 private:
     void initialize();
+    const wxBitmap& DoDecodeBitmap(const wxString& name);
 
 public:
     const wxBitmap& LoadBitmap(const wxString& name, int requestedSize = 16);
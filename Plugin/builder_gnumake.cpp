@@ -32,6 +32,7 @@
 #include "builder_gnumake.h"
 #include "buildmanager.h"
 #include "cl_command_event.h"
+#include "cl_config.h"
 #include "configuration_mapping.h"
 #include "dirsaver.h"
 #include "editor_config.h"
@@ -41,13 +42,60 @@
 #include "globals.h"
 #include "macromanager.h"
 #include "macros.h"
+#include "shell_command.h"
 #include "wx/sstream.h"
 #include "wx/tokenzr.h"
+#include "wxmd5.h"
 #include <algorithm>
+#include <wx/ffile.h>
 #include <wx/stopwatch.h>
+#include <wx/xml/xml.h>
 
 static bool OS_WINDOWS = wxGetOsVersion() & wxOS_WINDOWS ? true : false;
 
+#define MAKEFILE_FINGERPRINT_PREFIX "## Fingerprint: "
+
+static wxString XmlToString(wxXmlNode* node)
+{
+    // the document takes ownership of the node
+    wxXmlDocument doc;
+    doc.SetRoot(node);
+    wxStringOutputStream sos;
+    doc.Save(sos, wxXML_NO_INDENTATION);
+    return sos.GetString();
+}
+
+// Read the fingerprint stored in the header of a generated makefile
+static wxString ReadMakefileFingerprint(const wxString& makefile)
+{
+    wxFFile fp(makefile, "rb");
+    if(!fp.IsOpened()) { return wxEmptyString; }
+
+    char buffer[512];
+    size_t bytes = fp.Read(buffer, sizeof(buffer) - 1);
+    buffer[bytes] = 0;
+    wxString header(buffer, wxConvUTF8);
+    int where = header.Find(MAKEFILE_FINGERPRINT_PREFIX);
+    if(where == wxNOT_FOUND) { return wxEmptyString; }
+    return header.Mid(where + wxStrlen(MAKEFILE_FINGERPRINT_PREFIX)).BeforeFirst('\n').Trim();
+}
+
+// The workspace makefile target that builds a single project. Any character other than [A-Za-z0-9.] (including
+// '_') is written as "_<hex code>_", so two different project names never map to the same target
+static wxString GetProjectTargetName(const wxString& projectName)
+{
+    wxString target("Project_");
+    for(size_t i = 0; i < projectName.length(); ++i) {
+        wxChar ch = projectName.GetChar(i);
+        if((wxIsascii(ch) && wxIsalnum(ch)) || ch == '.') {
+            target << ch;
+        } else {
+            target << wxString::Format("_%x_", (unsigned int)ch);
+        }
+    }
+    return target;
+}
+
 static wxString GetMakeDirCmd(BuildConfigPtr bldConf, const wxString& relPath = wxEmptyString)
 {
     wxString intermediateDirectory(bldConf->GetIntermediateDirectory());
@@ -123,6 +171,8 @@ bool BuilderGNUMakeClassic::Export(const wxString& project, const wxString& conf
     wxArrayString depsArr = proj->GetDependencies(bld_conf_name);
 
     CL_DEBUG("Generating Makefile...");
+    wxStopWatch sw;
+    m_makefilesStats = MakefilesStats();
     // Filter all disabled projects from the dependencies array
     wxArrayString updatedDepsArr;
     for(size_t i = 0; i < depsArr.GetCount(); ++i) {
@@ -186,8 +236,12 @@ bool BuilderGNUMakeClassic::Export(const wxString& project, const wxString& conf
 
     wxFileName wspfile(clCxxWorkspaceST::Get()->GetWorkspaceFileName());
 
-    text << wxT(".PHONY: clean All\n\n");
-    text << wxT("All:\n");
+    // Each project is built by its own target which depends on the targets of the projects it depends on.
+    // This way make builds independent projects concurrently, within the jobs budget (-j) that is shared with
+    // the projects makefiles
+    wxString projectsText;
+    wxStringMap_t depsTargets;
+    wxArrayString depsTargetsList;
 
     // iterate over the dependencies projects and generate makefile
     wxString buildTool = GetBuildToolCommand(project, confToBuild, arguments, false);
@@ -220,8 +274,20 @@ bool BuilderGNUMakeClassic::Export(const wxString& project, const wxString& conf
                 continue;
             }
 
-            text << wxT("\t@echo \"") << wxGetTranslation(BUILD_PROJECT_PREFIX) << dependProj->GetName() << wxT(" - ")
-                 << projectSelConf << wxT(" ]----------\"\n");
+            // Only depend on projects that come before this one in the build order, so the graph has no cycles
+            wxString target = GetProjectTargetName(dependProj->GetName());
+            projectsText << target << wxT(":");
+            wxArrayString projectDeps = dependProj->GetDependencies(projectSelConf);
+            for(size_t j = 0; j < projectDeps.size(); ++j) {
+                wxStringMap_t::const_iterator iter = depsTargets.find(projectDeps.Item(j));
+                if(iter != depsTargets.end()) { projectsText << wxT(" ") << iter->second; }
+            }
+            projectsText << wxT("\n");
+            depsTargets.insert(std::make_pair(dependProj->GetName(), target));
+            depsTargetsList.Add(target);
+
+            projectsText << wxT("\t@echo \"") << wxGetTranslation(BUILD_PROJECT_PREFIX) << dependProj->GetName()
+                         << wxT(" - ") << projectSelConf << wxT(" ]----------\"\n");
             // make the paths relative, if it's sensible to do so
             wxFileName fn(dependProj->GetFileName());
             MakeRelativeIfSensible(fn, wspfile.GetPath());
@@ -239,11 +305,11 @@ bool BuilderGNUMakeClassic::Export(const wxString& project, const wxString& conf
                 e.SetConfigurationName(projectSelConf);
                 e.SetProjectOnly(false);
                 EventNotifier::Get()->ProcessEvent(e);
-                text << wxT("\t") << e.GetCommand() << wxT("\n");
+                projectsText << wxT("\t") << e.GetCommand() << wxT("\n");
 
             } else if(isCustom) {
 
-                CreateCustomPreBuildEvents(dependProjbldConf, text);
+                CreateCustomPreBuildEvents(dependProjbldConf, projectsText);
 
                 wxString customWd = dependProjbldConf->GetCustomBuildWorkingDir();
                 wxString build_cmd = dependProjbldConf->GetCustomBuildCmd();
@@ -267,8 +333,8 @@ bool BuilderGNUMakeClassic::Export(const wxString& project, const wxString& conf
                     customWdCmd << GetCdCmd(wspfile, fn);
                 }
 
-                text << wxT("\t") << customWdCmd << build_cmd << wxT("\n");
-                CreateCustomPostBuildEvents(dependProjbldConf, text);
+                projectsText << wxT("\t") << customWdCmd << build_cmd << wxT("\n");
+                CreateCustomPostBuildEvents(dependProjbldConf, projectsText);
 
             } else {
                 // generate the dependency project makefile
@@ -277,13 +343,26 @@ bool BuilderGNUMakeClassic::Export(const wxString& project, const wxString& conf
                 depsProjs.Add(dep_file);
 
                 GenerateMakefile(dependProj, projectSelConf, confToBuild.IsEmpty() ? force : true, wxArrayString());
-                text << GetProjectMakeCommand(wspfile, fn, dependProj, projectSelConf);
+                projectsText << GetProjectMakeCommand(wspfile, fn, dependProj, projectSelConf);
             }
+            projectsText << wxT("\t@echo \"") << wxGetTranslation(BUILD_PROJECT_END_PREFIX) << dependProj->GetName()
+                         << wxT(" - ") << projectSelConf << wxT(" ]----------\"\n\n");
         }
     }
 
     // Generate makefile for the project itself
     GenerateMakefile(proj, confToBuild, confToBuild.IsEmpty() ? force : true, depsProjs);
+    clDEBUG() << "Makefiles:" << m_makefilesStats.generated << "generated (" << m_makefilesStats.filesSectionsReused
+              << "with reused file rules)," << m_makefilesStats.upToDate << "up to date. Took" << sw.Time()
+              << "ms, saved ~" << m_makefilesStats.timeSaved << "ms" << clEndl;
+    if(m_makefilesStats.upToDate || m_makefilesStats.filesSectionsReused) {
+        // Show what the reuse bought in the build output as well
+        clCommandEvent event(wxEVT_SHELL_COMMAND_ADDLINE);
+        event.SetString(wxString::Format(_("Makefiles: %u generated, %u up to date, saved ~%ldms\n"),
+                                         (unsigned int)m_makefilesStats.generated,
+                                         (unsigned int)m_makefilesStats.upToDate, m_makefilesStats.timeSaved));
+        EventNotifier::Get()->AddPendingEvent(event);
+    }
 
     // incase we manually specified the configuration to be built, set the project
     // as modified, so on next attempt to build it, CodeLite will sync the configuration
@@ -296,8 +375,15 @@ bool BuilderGNUMakeClassic::Export(const wxString& project, const wxString& conf
         projectSelConf = confToBuild;
     }
 
-    text << wxT("\t@echo \"") << wxGetTranslation(BUILD_PROJECT_PREFIX) << project << wxT(" - ") << projectSelConf
-         << wxT(" ]----------\"\n");
+    // The project itself is built after all its dependencies
+    wxString projectTarget = GetProjectTargetName(project);
+    projectsText << projectTarget << wxT(":");
+    for(size_t i = 0; i < depsTargetsList.size(); ++i) {
+        projectsText << wxT(" ") << depsTargetsList.Item(i);
+    }
+    projectsText << wxT("\n");
+    projectsText << wxT("\t@echo \"") << wxGetTranslation(BUILD_PROJECT_PREFIX) << project << wxT(" - ")
+                 << projectSelConf << wxT(" ]----------\"\n");
 
     // make the paths relative, if it's sensible to do so
     wxFileName projectPath(proj->GetFileName());
@@ -316,12 +402,36 @@ bool BuilderGNUMakeClassic::Export(const wxString& project, const wxString& conf
         EventNotifier::Get()->ProcessEvent(e);
 
         cmd = e.GetCommand();
-        text << wxT("\t") << cmd << wxT("\n");
+        projectsText << wxT("\t") << cmd << wxT("\n");
+
+    } else {
+        projectsText << GetProjectMakeCommand(wspfile, projectPath, proj, projectSelConf);
+    }
+    projectsText << wxT("\t@echo \"") << wxGetTranslation(BUILD_PROJECT_END_PREFIX) << project << wxT(" - ")
+                 << projectSelConf << wxT(" ]----------\"\n\n");
 
+    text << wxT(".PHONY: clean All ") << projectTarget;
+    for(size_t i = 0; i < depsTargetsList.size(); ++i) {
+        text << wxT(" ") << depsTargetsList.Item(i);
+    }
+    text << wxT("\n\n");
+
+    // Build the projects one after the other, in the build order. Building them concurrently is opt-in: projects
+    // may rely on an earlier project in the build order without declaring it as a dependency.
+    // When they do run concurrently, ask make (4.0 and later) to print each project's output as one block: the build
+    // tab relies on the "Entering directory" lines to resolve the relative paths in the compiler messages. Older
+    // versions of make interleave the output, so errors may then point to the wrong directory
+    if(!clConfig::Get().Read(kConfigBuildParallelProjects, false)) {
+        text << wxT(".NOTPARALLEL:\n\n");
     } else {
-        text << GetProjectMakeCommand(wspfile, projectPath, proj, projectSelConf);
+        text << wxT("ifneq ($(filter output-sync,$(.FEATURES)),)\n");
+        text << wxT("MAKEFLAGS += --output-sync=target\n");
+        text << wxT("endif\n\n");
     }
 
+    text << wxT("All: ") << projectTarget << wxT("\n\n");
+    text << projectsText;
+
     // create the clean target
     text << wxT("clean:\n");
     if(!isProjectOnly) {
@@ -476,9 +586,27 @@ void BuilderGNUMakeClassic::GenerateMakefile(ProjectPtr proj, const wxString& co
         }
     }
 
+    wxStopWatch sw;
+
     // Load the current project files
     m_projectFilesMetadata = &(proj->GetFiles());
 
+    EvnVarList vars;
+    EnvironmentConfig::Instance()->ReadObject(wxT("Variables"), &vars);
+    EnvMap varMap = vars.GetVariables(wxT(""), true, proj->GetName(), bldConf->GetName());
+
+    // The makefile is a function of the project files, the build configuration, the compiler and the environment.
+    // If none of them changed since the makefile was written, keep it as is
+    MakefileCache& cache = m_makefilesCache[fn];
+    wxString filesFingerprint = GetFilesFingerprint(proj, bldConf, confToBuild);
+    wxString fingerprint = GetMakefileFingerprint(proj, bldConf, filesFingerprint, varMap, depsProj);
+    if(ReadMakefileFingerprint(fn) == fingerprint) {
+        m_makefilesStats.upToDate++;
+        m_makefilesStats.timeSaved += wxMax(0L, cache.generationTime - sw.Time());
+        proj->SetModified(false);
+        return;
+    }
+
     // generate the selected configuration for this project
     // wxTextOutputStream text(output);
     wxString text;
@@ -486,6 +614,7 @@ void BuilderGNUMakeClassic::GenerateMakefile(ProjectPtr proj, const wxString& co
     text << wxT("##") << wxT("\n");
     text << wxT("## Auto Generated makefile by CodeLite IDE") << wxT("\n");
     text << wxT("## any manual changes will be erased      ") << wxT("\n");
+    text << MAKEFILE_FINGERPRINT_PREFIX << fingerprint << wxT("\n");
     text << wxT("##") << wxT("\n");
 
     // Create the makefile variables
@@ -497,10 +626,6 @@ void BuilderGNUMakeClassic::GenerateMakefile(ProjectPtr proj, const wxString& co
     // so user will be able to override any of the default
     // variables by defining its own
     //----------------------------------------------------------
-    EvnVarList vars;
-    EnvironmentConfig::Instance()->ReadObject(wxT("Variables"), &vars);
-    EnvMap varMap = vars.GetVariables(wxT(""), true, proj->GetName(), bldConf->GetName());
-
     text << wxT("##") << wxT("\n");
     text << wxT("## User defined environment variables") << wxT("\n");
     text << wxT("##") << wxT("\n");
@@ -511,7 +636,20 @@ void BuilderGNUMakeClassic::GenerateMakefile(ProjectPtr proj, const wxString& co
         text << name << wxT(":=") << value << wxT("") << wxT("\n");
     }
 
-    CreateListMacros(proj, confToBuild, text); // list of srcs and list of objects
+    // The per file sections are the expensive part, reuse them if the files and the compiler did not change
+    bool reuseFilesSections = (cache.filesFingerprint == filesFingerprint);
+    if(reuseFilesSections) {
+        m_objectChunks = cache.objectChunks;
+        m_makefilesStats.filesSectionsReused++;
+    } else {
+        cache.listMacros.clear();
+        cache.fileTargets.clear();
+        CreateListMacros(proj, confToBuild, cache.listMacros); // list of srcs and list of objects
+        CreateFileTargets(proj, confToBuild, cache.fileTargets);
+        cache.objectChunks = m_objectChunks;
+        cache.filesFingerprint = filesFingerprint;
+    }
+    text << cache.listMacros;
 
     //-----------------------------------------------------------
     // create the build targets
@@ -537,7 +675,7 @@ void BuilderGNUMakeClassic::GenerateMakefile(ProjectPtr proj, const wxString& co
     // Create a list of targets that should be built according to
     // projects' file list
     //-----------------------------------------------------------
-    CreateFileTargets(proj, confToBuild, text);
+    text << cache.fileTargets;
     CreateCleanTargets(proj, confToBuild, text);
 
     // dump the content to a file
@@ -550,6 +688,62 @@ void BuilderGNUMakeClassic::GenerateMakefile(ProjectPtr proj, const wxString& co
 
     // mark the project as non-modified one
     proj->SetModified(false);
+
+    m_makefilesStats.generated++;
+    if(!reuseFilesSections) {
+        cache.generationTime = sw.Time();
+    } else {
+        m_makefilesStats.timeSaved += wxMax(0L, cache.generationTime - sw.Time());
+    }
+}
+
+wxString BuilderGNUMakeClassic::GetFilesFingerprint(ProjectPtr proj, BuildConfigPtr bldConf,
+                                                    const wxString& confToBuild) const
+{
+    CompilerPtr cmp = BuildSettingsConfigST::Get()->GetCompiler(bldConf->GetCompilerType());
+
+    wxString content;
+    content << GetName() << "\n" << confToBuild << "\n" << proj->GetFileName().GetFullPath() << "\n"
+            << bldConf->GetIntermediateDirectory() << "\n";
+    if(cmp) { content << XmlToString(cmp->ToXml()) << "\n"; }
+
+    for(const Project::FilesMap_t::value_type& vt : *m_projectFilesMetadata) {
+        content << vt.second->GetFilename() << (vt.second->IsExcludeFromConfiguration(confToBuild) ? "|x\n" : "\n");
+    }
+    return wxMD5::GetDigest(content);
+}
+
+wxString BuilderGNUMakeClassic::GetMakefileFingerprint(ProjectPtr proj, BuildConfigPtr bldConf,
+                                                       const wxString& filesFingerprint, EnvMap& varMap,
+                                                       const wxArrayString& depsProj) const
+{
+    wxString content;
+    content << filesFingerprint << "\n";
+    content << XmlToString(bldConf->ToXml()) << "\n";
+    content << proj->GetSettings()->GetProjectType(bldConf->GetName()) << "\n";
+    content << clCxxWorkspaceST::Get()->GetWorkspaceFileName().GetFullPath() << "\n";
+    content << clCxxWorkspaceST::Get()->GetStartupDir() << "\n";
+    content << clCxxWorkspaceST::Get()->GetBuildMatrix()->GetSelectedConfigurationName() << "\n";
+
+    // Expanded environment variables
+    for(size_t i = 0; i < varMap.GetCount(); ++i) {
+        wxString name, value;
+        varMap.Get(i, name, value);
+        content << name << "=" << value << "\n";
+    }
+
+    for(size_t i = 0; i < depsProj.size(); ++i) {
+        content << depsProj.Item(i) << "\n";
+    }
+
+    // Flags added by plugins
+    clBuildEvent e(wxEVT_GET_ADDITIONAL_COMPILEFLAGS);
+    e.SetProjectName(proj->GetName());
+    e.SetConfigurationName(bldConf->GetName());
+    EventNotifier::Get()->ProcessEvent(e);
+    content << e.GetCommand() << "\n";
+
+    return wxMD5::GetDigest(content);
 }
 
 void BuilderGNUMakeClassic::CreateMakeDirsTarget(ProjectPtr proj, BuildConfigPtr bldConf, const wxString& targetName,
@@ -29,16 +29,38 @@
 #include "codelite_exports.h"
 #include "project.h"
 #include "workspace.h"
+#include <map>
 #include <wx/txtstrm.h>
 #include <wx/wfstream.h>
+
+class EnvMap;
+
 /*
  * Build using a generated (Gnu) Makefile - this is made as a traditional multistep build :
  *  sources -> (preprocess) -> compile -> link -> exec/lib.
  */
 class WXDLLIMPEXP_SDK BuilderGNUMakeClassic : public Builder
 {
+    // The parts of a project makefile that depend only on the project files and the compiler (one rule per file)
+    struct MakefileCache {
+        wxString filesFingerprint;
+        wxString listMacros;
+        wxString fileTargets;
+        size_t objectChunks = 1;
+        long generationTime = 0; // ms it took to generate the complete makefile
+    };
+
+    struct MakefilesStats {
+        size_t generated = 0;
+        size_t upToDate = 0;
+        size_t filesSectionsReused = 0;
+        long timeSaved = 0;
+    };
+
     size_t m_objectChunks;
     Project::FilesMap_t* m_projectFilesMetadata;
+    std::map<wxString, MakefileCache> m_makefilesCache; // makefile path -> cache
+    MakefilesStats m_makefilesStats;
 
 protected:
     enum eBuildFlags {
@@ -83,6 +105,9 @@ protected:
 
 private:
     void GenerateMakefile(ProjectPtr proj, const wxString& confToBuild, bool force, const wxArrayString& depsProj);
+    wxString GetFilesFingerprint(ProjectPtr proj, BuildConfigPtr bldConf, const wxString& confToBuild) const;
+    wxString GetMakefileFingerprint(ProjectPtr proj, BuildConfigPtr bldConf, const wxString& filesFingerprint,
+                                    EnvMap& varMap, const wxArrayString& depsProj) const;
     void CreateConfigsVariables(ProjectPtr proj, BuildConfigPtr bldConf, wxString& text);
     void CreateMakeDirsTarget(ProjectPtr proj, BuildConfigPtr bldConf, const wxString& targetName, wxString& text);
     void CreateTargets(const wxString& type, BuildConfigPtr bldConf, wxString& text, const wxString& projName);
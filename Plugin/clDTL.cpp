@@ -24,11 +24,211 @@
 //////////////////////////////////////////////////////////////////////////////
 
 #include "clDTL.h"
-#include "dtl/dtl.hpp"
+#include <algorithm>
+#include <unordered_map>
 #include <wx/ffile.h>
-#include <wx/tokenzr.h>
 #include <wx/utils.h>
 
+namespace
+{
+// An edit operation: the type (LINE_COMMON/ADDED/REMOVED) and the line index
+// in the left (COMMON, REMOVED) or right (ADDED) sequence
+struct EditOp {
+    int type;
+    int index;
+};
+typedef std::vector<EditOp> EditScript_t;
+
+/**
+ * @brief linear space Myers diff over integer sequences
+ * See "An O(ND) Difference Algorithm and Its Variations", E. Myers (section 4b)
+ */
+class MyersDiff
+{
+    const int* m_a;
+    const int* m_b;
+    std::vector<int> m_vf;
+    std::vector<int> m_vb;
+    EditScript_t& m_script;
+
+    struct Snake {
+        int x = 0;
+        int y = 0;
+        int u = 0;
+        int v = 0;
+    };
+
+    void Emit(int type, int index, int count)
+    {
+        for(int i = 0; i < count; ++i) {
+            m_script.push_back({ type, index + i });
+        }
+    }
+
+    /// find the middle snake of a[a0, a0+N) and b[b0, b0+M). Both sequences are non empty
+    void FindMiddleSnake(int a0, int N, int b0, int M, Snake& snake)
+    {
+        const int* a = m_a + a0;
+        const int* b = m_b + b0;
+        int maxD = (N + M + 1) / 2;
+        int delta = N - M;
+        bool odd = (delta & 1) != 0;
+        int offset = maxD + 1;
+        size_t size = 2 * maxD + 3;
+        if(m_vf.size() < size) {
+            m_vf.resize(size);
+            m_vb.resize(size);
+        }
+        m_vf[offset + 1] = 0;
+        m_vb[offset + 1] = 0;
+
+        for(int d = 0; d <= maxD; ++d) {
+            // forward search
+            for(int k = -d; k <= d; k += 2) {
+                int x;
+                if(k == -d || (k != d && m_vf[offset + k - 1] < m_vf[offset + k + 1])) {
+                    x = m_vf[offset + k + 1];
+                } else {
+                    x = m_vf[offset + k - 1] + 1;
+                }
+                int y = x - k;
+                int x0 = x;
+                int y0 = y;
+                while(x < N && y < M && a[x] == b[y]) {
+                    ++x;
+                    ++y;
+                }
+                m_vf[offset + k] = x;
+                if(odd && (k >= delta - (d - 1)) && (k <= delta + (d - 1)) && (x + m_vb[offset + delta - k] >= N)) {
+                    snake.x = a0 + x0;
+                    snake.y = b0 + y0;
+                    snake.u = a0 + x;
+                    snake.v = b0 + y;
+                    return;
+                }
+            }
+
+            // reverse search (on the reversed sequences)
+            for(int k = -d; k <= d; k += 2) {
+                int x;
+                if(k == -d || (k != d && m_vb[offset + k - 1] < m_vb[offset + k + 1])) {
+                    x = m_vb[offset + k + 1];
+                } else {
+                    x = m_vb[offset + k - 1] + 1;
+                }
+                int y = x - k;
+                int x0 = x;
+                int y0 = y;
+                while(x < N && y < M && a[N - x - 1] == b[M - y - 1]) {
+                    ++x;
+                    ++y;
+                }
+                m_vb[offset + k] = x;
+                if(!odd && (delta - k >= -d) && (delta - k <= d) && (x + m_vf[offset + delta - k] >= N)) {
+                    snake.x = a0 + N - x;
+                    snake.y = b0 + M - y;
+                    snake.u = a0 + N - x0;
+                    snake.v = b0 + M - y0;
+                    return;
+                }
+            }
+        }
+    }
+
+    void Compare(int a0, int N, int b0, int M)
+    {
+        // strip the common prefix
+        int prefix = 0;
+        while(prefix < N && prefix < M && m_a[a0 + prefix] == m_b[b0 + prefix]) {
+            ++prefix;
+        }
+        Emit(clDTL::LINE_COMMON, a0, prefix);
+        a0 += prefix;
+        b0 += prefix;
+        N -= prefix;
+        M -= prefix;
+
+        // and the common suffix
+        int suffix = 0;
+        while(suffix < N && suffix < M && m_a[a0 + N - suffix - 1] == m_b[b0 + M - suffix - 1]) {
+            ++suffix;
+        }
+        N -= suffix;
+        M -= suffix;
+
+        if(N == 0) {
+            Emit(clDTL::LINE_ADDED, b0, M);
+        } else if(M == 0) {
+            Emit(clDTL::LINE_REMOVED, a0, N);
+        } else {
+            // both sequences are non empty and their first and last items differ,
+            // so the edit distance is at least 2 and each half is strictly smaller
+            Snake snake;
+            FindMiddleSnake(a0, N, b0, M, snake);
+            Compare(a0, snake.x - a0, b0, snake.y - b0);
+            Emit(clDTL::LINE_COMMON, snake.x, snake.u - snake.x);
+            Compare(snake.u, a0 + N - snake.u, snake.v, b0 + M - snake.v);
+        }
+        Emit(clDTL::LINE_COMMON, a0 + N, suffix);
+    }
+
+public:
+    MyersDiff(const std::vector<int>& a, const std::vector<int>& b, EditScript_t& script)
+        : m_a(a.data())
+        , m_b(b.data())
+        , m_script(script)
+    {
+        m_script.reserve(a.size() + b.size());
+        Compare(0, a.size(), 0, b.size());
+    }
+};
+
+/// split 'content' into lines. Each line keeps its terminating "\n"
+void SplitLines(const wxString& content, std::vector<wxString>& lines)
+{
+    size_t start = 0;
+    size_t len = content.length();
+    while(start < len) {
+        size_t where = content.find('\n', start);
+        if(where == wxString::npos) {
+            lines.push_back(content.Mid(start));
+            break;
+        }
+        lines.push_back(content.Mid(start, where - start + 1));
+        start = where + 1;
+    }
+}
+
+/// replace every line with a unique integer so the diff compares ints instead of strings
+void InternLines(const std::vector<wxString>& lines, std::unordered_map<wxString, int>& ids, std::vector<int>& seq)
+{
+    seq.reserve(lines.size());
+    for(const wxString& line : lines) {
+        auto iter = ids.insert({ line, (int)ids.size() }).first;
+        seq.push_back(iter->second);
+    }
+}
+
+/// within every change hunk, place the removed lines before the added lines
+void NormalizeHunks(EditScript_t& script)
+{
+    size_t i = 0;
+    while(i < script.size()) {
+        if(script[i].type == clDTL::LINE_COMMON) {
+            ++i;
+            continue;
+        }
+        size_t end = i;
+        while(end < script.size() && script[end].type != clDTL::LINE_COMMON) {
+            ++end;
+        }
+        std::stable_partition(script.begin() + i, script.begin() + end,
+                              [](const EditOp& op) { return op.type == clDTL::LINE_REMOVED; });
+        i = end;
+    }
+}
+} // namespace
+
 clDTL::clDTL()
 {
 }
@@ -57,26 +257,30 @@ void clDTL::Diff(const wxFileName& fnLeft, const wxFileName& fnRight, DiffMode m
     m_resultRight.clear();
     m_sequences.clear();
 
-    typedef wxString elem;
-    typedef std::pair<elem, dtl::elemInfo> sesElem;
-
-    wxArrayString leftLines = wxStringTokenize(leftFile, "\n", wxTOKEN_RET_DELIMS);
-    wxArrayString rightLines = wxStringTokenize(rightFile, "\n", wxTOKEN_RET_DELIMS);
-
-    std::vector<elem> leftLinesVec;
-    std::vector<elem> rightLinesVec;
-    leftLinesVec.insert(leftLinesVec.end(), leftLines.begin(), leftLines.end());
-    rightLinesVec.insert(rightLinesVec.end(), rightLines.begin(), rightLines.end());
+    std::vector<wxString> leftLines;
+    std::vector<wxString> rightLines;
+    SplitLines(leftFile, leftLines);
+    SplitLines(rightFile, rightLines);
 
-    dtl::Diff<elem, std::vector<elem> > diff(leftLinesVec, rightLinesVec);
-    diff.onHuge();
-    diff.compose();
+    // Each line is hashed once, the diff itself runs over the line ids
+    std::vector<int> leftIds;
+    std::vector<int> rightIds;
+    {
+        std::unordered_map<wxString, int> ids;
+        ids.reserve(leftLines.size() + rightLines.size());
+        InternLines(leftLines, ids, leftIds);
+        InternLines(rightLines, ids, rightIds);
+    }
 
-    if ( 0 == diff.getEditDistance() ) {
+    if ( leftIds == rightIds ) {
         // nothing to be done - files are identical
         return;
     }
 
+    EditScript_t seq;
+    MyersDiff diff(leftIds, rightIds, seq);
+    NormalizeHunks(seq);
+
     if ( mode & clDTL::kTwoPanes ) {
 
         ///////////////////////////////////////////////////////////////////
@@ -85,8 +289,6 @@ void clDTL::Diff(const wxFileName& fnLeft, const wxFileName& fnRight, DiffMode m
         // pane all deletions while on the right pane all the new lines
         ///////////////////////////////////////////////////////////////////
 
-        // Loop over the diff and check if it is a whitespace only diff
-        std::vector<sesElem> seq = diff.getSes().getSequence();
         m_resultLeft.reserve( seq.size() );
         m_resultRight.reserve( seq.size() );
 
@@ -101,8 +303,8 @@ void clDTL::Diff(const wxFileName& fnLeft, const wxFileName& fnRight, DiffMode m
         LineInfoVec_t tmpSeqRight;
 
         for(size_t i=0; i<seq.size(); ++i) {
-            switch(seq.at(i).second.type) {
-            case dtl::SES_COMMON: {
+            switch(seq.at(i).type) {
+            case LINE_COMMON: {
                 if ( state == STATE_IN_SEQ ) {
 
                     // set the sequence size
@@ -123,14 +325,14 @@ void clDTL::Diff(const wxFileName& fnLeft, const wxFileName& fnRight, DiffMode m
                     tmpSeqRight.clear();
                     seqSize = 0;
                 }
-                clDTL::LineInfo line(seq.at(i).first, LINE_COMMON);
+                clDTL::LineInfo line(leftLines.at(seq.at(i).index), LINE_COMMON);
                 m_resultLeft.push_back( line );
                 m_resultRight.push_back( line );
                 break;
 
             }
-            case dtl::SES_ADD: {
-                clDTL::LineInfo lineRight(seq.at(i).first, LINE_ADDED);
+            case LINE_ADDED: {
+                clDTL::LineInfo lineRight(rightLines.at(seq.at(i).index), LINE_ADDED);
                 tmpSeqRight.push_back( lineRight );
 
                 if ( state == STATE_NONE ) {
@@ -140,8 +342,8 @@ void clDTL::Diff(const wxFileName& fnLeft, const wxFileName& fnRight, DiffMode m
                 break;
 
             }
-            case dtl::SES_DELETE: {
-                clDTL::LineInfo lineLeft(seq.at(i).first, LINE_REMOVED);
+            case LINE_REMOVED: {
+                clDTL::LineInfo lineLeft(leftLines.at(seq.at(i).index), LINE_REMOVED);
                 tmpSeqLeft.push_back( lineLeft );
 
                 if ( state == STATE_NONE ) {
@@ -178,34 +380,33 @@ void clDTL::Diff(const wxFileName& fnLeft, const wxFileName& fnRight, DiffMode m
         // One pane diff view
         // designed for displayed on a single editor
         ///////////////////////////////////////////////////////////////////
-        std::vector<sesElem> seq = diff.getSes().getSequence();
         m_resultLeft.reserve( seq.size() );
         int seqStartLine = wxNOT_FOUND;
         for(size_t i=0; i<seq.size(); ++i) {
-            switch(seq.at(i).second.type) {
-            case dtl::SES_COMMON: {
+            switch(seq.at(i).type) {
+            case LINE_COMMON: {
                 if ( seqStartLine != wxNOT_FOUND ) {
                     m_sequences.push_back( std::make_pair(seqStartLine, m_resultLeft.size()) );
                     seqStartLine = wxNOT_FOUND;
                 }
-                clDTL::LineInfo line(seq.at(i).first, LINE_COMMON);
+                clDTL::LineInfo line(leftLines.at(seq.at(i).index), LINE_COMMON);
                 m_resultLeft.push_back( line );
                 break;
             }
-            case dtl::SES_ADD: {
+            case LINE_ADDED: {
                 if ( seqStartLine == wxNOT_FOUND ) {
                     seqStartLine = m_resultLeft.size();
                 }
-                clDTL::LineInfo line(seq.at(i).first, LINE_ADDED);
+                clDTL::LineInfo line(rightLines.at(seq.at(i).index), LINE_ADDED);
                 m_resultLeft.push_back( line );
                 break;
 
             }
-            case dtl::SES_DELETE: {
+            case LINE_REMOVED: {
                 if ( seqStartLine == wxNOT_FOUND ) {
                     seqStartLine = m_resultLeft.size();
                 }
-                clDTL::LineInfo line(seq.at(i).first, LINE_REMOVED);
+                clDTL::LineInfo line(leftLines.at(seq.at(i).index), LINE_REMOVED);
                 m_resultLeft.push_back( line );
                 break;
             }
@@ -0,0 +1,235 @@
+#include "clProjectSnapshot.h"
+#include "file_logger.h"
+#include "wxmd5.h"
+#include <string.h>
+#include <wx/ffile.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+#include <wx/mstream.h>
+#include <wx/utils.h>
+
+// Bump the version whenever the format changes
+#define SNAPSHOT_MAGIC "CLPS"
+#define SNAPSHOT_VERSION 2
+// Guard against corrupted snapshots
+#define SNAPSHOT_MAX_DEPTH 1000
+
+namespace
+{
+struct SnapshotHeader {
+    char magic[4];
+    wxUint32 version;
+    wxInt64 fileSize;
+    wxUint64 contentHash;
+};
+
+// FNV-1a
+wxUint64 HashBytes(const char* data, size_t len)
+{
+    wxUint64 hash = wxULL(14695981039346656037);
+    for(size_t i = 0; i < len; ++i) {
+        hash ^= (wxUint64)(unsigned char)data[i];
+        hash *= wxULL(1099511628211);
+    }
+    return hash;
+}
+
+void WriteUInt32(std::string& buffer, wxUint32 n) { buffer.append((const char*)&n, sizeof(n)); }
+
+void WriteString(std::string& buffer, const wxString& str)
+{
+    const wxScopedCharBuffer cb = str.mb_str(wxConvUTF8);
+    WriteUInt32(buffer, (wxUint32)cb.length());
+    buffer.append(cb.data(), cb.length());
+}
+
+bool ReadUInt32(const char*& ptr, const char* end, wxUint32& n)
+{
+    if((size_t)(end - ptr) < sizeof(n)) { return false; }
+    memcpy(&n, ptr, sizeof(n));
+    ptr += sizeof(n);
+    return true;
+}
+
+bool ReadString(const char*& ptr, const char* end, wxString& str)
+{
+    wxUint32 len = 0;
+    if(!ReadUInt32(ptr, end, len) || (size_t)(end - ptr) < len) { return false; }
+    str = wxString::FromUTF8(ptr, len);
+    ptr += len;
+    return true;
+}
+
+bool ReadFile(const wxString& filename, std::string& content)
+{
+    wxFFile fp(filename, "rb");
+    if(!fp.IsOpened()) { return false; }
+    wxFileOffset length = fp.Length();
+    if(length < 0) { return false; }
+    content.resize((size_t)length);
+    return length == 0 || fp.Read(&content[0], content.length()) == content.length();
+}
+} // namespace
+
+wxString clProjectSnapshot::GetSnapshotFile(const wxString& projectFile, const wxString& snapshotsFolder)
+{
+    wxFileName fn(snapshotsFolder, wxMD5::GetDigest(projectFile));
+    fn.SetExt("snapshot");
+    return fn.GetFullPath();
+}
+
+bool clProjectSnapshot::Load(const wxString& projectFile, const wxString& snapshotsFolder, wxXmlDocument& doc)
+{
+    // Hashing the project file is much cheaper than parsing it, and unlike its size and modification time (in
+    // seconds) it catches every edit
+    std::string content;
+    if(!ReadFile(projectFile, content)) { return false; }
+    wxInt64 fileSize = (wxInt64)content.length();
+    wxUint64 contentHash = HashBytes(content.data(), content.length());
+
+    wxString snapshotFile = GetSnapshotFile(projectFile, snapshotsFolder);
+    if(ReadSnapshot(snapshotFile, fileSize, contentHash, doc)) { return true; }
+
+    // No snapshot or an outdated one, parse the content we already have
+    wxMemoryInputStream is(content.data(), content.length());
+    if(!doc.Load(is)) { return false; }
+    WriteSnapshot(snapshotFile, fileSize, contentHash, doc);
+    return true;
+}
+
+bool clProjectSnapshot::ReadSnapshot(const wxString& snapshotFile, wxInt64 fileSize, wxUint64 contentHash,
+                                     wxXmlDocument& doc)
+{
+    wxFFile fp(snapshotFile, "rb");
+    if(!fp.IsOpened()) { return false; }
+
+    SnapshotHeader header;
+    if(fp.Read(&header, sizeof(header)) != sizeof(header)) { return false; }
+    if(memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 || header.version != SNAPSHOT_VERSION ||
+       header.fileSize != fileSize || header.contentHash != contentHash) {
+        return false;
+    }
+
+    wxFileOffset length = fp.Length() - (wxFileOffset)sizeof(header);
+    if(length <= 0) { return false; }
+    std::string buffer((size_t)length, 0);
+    if(fp.Read(&buffer[0], buffer.length()) != buffer.length()) { return false; }
+
+    const char* ptr = buffer.data();
+    const char* end = ptr + buffer.length();
+    wxString version, encoding;
+    if(!ReadString(ptr, end, version) || !ReadString(ptr, end, encoding)) { return false; }
+
+    wxXmlNode* root = ReadNode(ptr, end, 0);
+    if(!root) {
+        clWARNING() << "Corrupted project snapshot:" << snapshotFile << clEndl;
+        return false;
+    }
+    doc.SetRoot(root);
+    doc.SetVersion(version);
+    doc.SetFileEncoding(encoding);
+    return true;
+}
+
+void clProjectSnapshot::WriteSnapshot(const wxString& snapshotFile, wxInt64 fileSize, wxUint64 contentHash,
+                                      const wxXmlDocument& doc)
+{
+    if(!doc.GetRoot()) { return; }
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.fileSize = fileSize;
+    header.contentHash = contentHash;
+
+    std::string buffer;
+    buffer.append((const char*)&header, sizeof(header));
+    WriteString(buffer, doc.GetVersion());
+    WriteString(buffer, doc.GetFileEncoding());
+    WriteNode(buffer, doc.GetRoot());
+
+    // Write to a temporary file first so a concurrent reader never sees a partial snapshot
+    wxString tmpfile = snapshotFile + wxString::Format(".%lu", wxGetProcessId());
+    {
+        wxFFile fp(tmpfile, "wb");
+        if(!fp.IsOpened()) { return; }
+        if(fp.Write(buffer.data(), buffer.length()) != buffer.length()) {
+            fp.Close();
+            ::wxRemoveFile(tmpfile);
+            return;
+        }
+    }
+    if(!::wxRenameFile(tmpfile, snapshotFile, true)) { ::wxRemoveFile(tmpfile); }
+}
+
+void clProjectSnapshot::WriteNode(std::string& buffer, const wxXmlNode* node)
+{
+    buffer.push_back((char)node->GetType());
+    WriteString(buffer, node->GetName());
+    WriteString(buffer, node->GetContent());
+
+    wxUint32 count = 0;
+    for(const wxXmlAttribute* attr = node->GetAttributes(); attr; attr = attr->GetNext()) {
+        ++count;
+    }
+    WriteUInt32(buffer, count);
+    for(const wxXmlAttribute* attr = node->GetAttributes(); attr; attr = attr->GetNext()) {
+        WriteString(buffer, attr->GetName());
+        WriteString(buffer, attr->GetValue());
+    }
+
+    count = 0;
+    for(const wxXmlNode* child = node->GetChildren(); child; child = child->GetNext()) {
+        ++count;
+    }
+    WriteUInt32(buffer, count);
+    for(const wxXmlNode* child = node->GetChildren(); child; child = child->GetNext()) {
+        WriteNode(buffer, child);
+    }
+}
+
+wxXmlNode* clProjectSnapshot::ReadNode(const char*& ptr, const char* end, int depth)
+{
+    if(depth > SNAPSHOT_MAX_DEPTH || ptr >= end) { return NULL; }
+    wxXmlNodeType type = (wxXmlNodeType)(unsigned char)*ptr++;
+
+    wxString name, content;
+    wxUint32 count = 0;
+    if(!ReadString(ptr, end, name) || !ReadString(ptr, end, content) || !ReadUInt32(ptr, end, count)) {
+        return NULL;
+    }
+
+    wxXmlNode* node = new wxXmlNode(NULL, type, name, content);
+    for(wxUint32 i = 0; i < count; ++i) {
+        wxString attrName, attrValue;
+        if(!ReadString(ptr, end, attrName) || !ReadString(ptr, end, attrValue)) {
+            delete node;
+            return NULL;
+        }
+        node->AddAttribute(attrName, attrValue);
+    }
+
+    if(!ReadUInt32(ptr, end, count)) {
+        delete node;
+        return NULL;
+    }
+
+    // Link the children directly, wxXmlNode::AddChild() walks the whole list for every child
+    wxXmlNode* last = NULL;
+    for(wxUint32 i = 0; i < count; ++i) {
+        wxXmlNode* child = ReadNode(ptr, end, depth + 1);
+        if(!child) {
+            delete node;
+            return NULL;
+        }
+        child->SetParent(node);
+        if(last) {
+            last->SetNext(child);
+        } else {
+            node->SetChildren(child);
+        }
+        last = child;
+    }
+    return node;
+}
@@ -0,0 +1,36 @@
+#ifndef CLPROJECTSNAPSHOT_H
+#define CLPROJECTSNAPSHOT_H
+
+#include "codelite_exports.h"
+#include <string>
+#include <wx/string.h>
+#include <wx/xml/xml.h>
+
+/**
+ * @class clProjectSnapshot
+ * @brief a binary image of a project's XML tree, kept in the workspace private folder.
+ * Loading a snapshot rebuilds the tree without parsing the XML. A snapshot is used only as long as the project
+ * file size and content hash match the ones recorded when it was written
+ */
+class WXDLLIMPEXP_SDK clProjectSnapshot
+{
+    static wxString GetSnapshotFile(const wxString& projectFile, const wxString& snapshotsFolder);
+    static bool ReadSnapshot(const wxString& snapshotFile, wxInt64 fileSize, wxUint64 contentHash,
+                             wxXmlDocument& doc);
+    static void WriteSnapshot(const wxString& snapshotFile, wxInt64 fileSize, wxUint64 contentHash,
+                              const wxXmlDocument& doc);
+    static void WriteNode(std::string& buffer, const wxXmlNode* node);
+    static wxXmlNode* ReadNode(const char*& ptr, const char* end, int depth);
+
+public:
+    /**
+     * @brief load the project document. Use the snapshot if it is up to date, otherwise parse the project file
+     * and write a new snapshot. This function does not access any global state and can be called from a worker thread
+     * @param projectFile the project file full path
+     * @param snapshotsFolder the folder holding the snapshots. Must exist
+     * @param doc [output] the loaded document
+     */
+    static bool Load(const wxString& projectFile, const wxString& snapshotsFolder, wxXmlDocument& doc);
+};
+
+#endif // CLPROJECTSNAPSHOT_H
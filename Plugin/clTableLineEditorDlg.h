@@ -6,8 +6,9 @@
 
 class clTableLineEditorDlg : public clTableLineEditorBaseDlg
 {
-    const wxArrayString& m_columns;
-    const wxArrayString& m_data;
+    // Copies: the dialog is modeless and the table keeps changing while rows are streamed in
+    wxArrayString m_columns;
+    wxArrayString m_data;
 
 public:
     clTableLineEditorDlg(wxWindow* parent, const wxArrayString& columns, const wxArrayString& data);
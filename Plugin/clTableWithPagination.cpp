@@ -68,11 +68,25 @@ void clTableWithPagination::SetData(std::vector<wxArrayString>& data)
     ShowPage(0);
 }
 
+void clTableWithPagination::AppendData(const std::vector<wxArrayString>& data)
+{
+    // Refresh the view only if the new rows are visible in the current page
+    bool pageIsFull = ((int)m_data.size() >= ((m_currentPage + 1) * m_linesPerPage));
+    m_data.insert(m_data.end(), data.begin(), data.end());
+    if(pageIsFull) {
+        UpdateLabel();
+    } else {
+        ShowPage(m_currentPage);
+    }
+}
+
 void clTableWithPagination::ClearAll()
 {
     m_data.clear();
     m_ctrl->DeleteAllItems();
     m_ctrl->ClearColumns();
+    m_currentPage = 0;
+    m_staticText->SetLabel("");
 }
 
 void clTableWithPagination::ShowPage(int nPage)
@@ -90,9 +104,21 @@ void clTableWithPagination::ShowPage(int nPage)
             const wxString& cellContent = items.Item(j);
             cols.push_back(wxVariant(MakeDisplayString(cellContent)));
         }
-        m_ctrl->AppendItem(cols, (wxUIntPtr)&items);
+        // Keep the row index and not its address: the data may grow (and reallocate) while the page is shown
+        m_ctrl->AppendItem(cols, (wxUIntPtr)i);
     }
+    UpdateLabel();
+}
 
+void clTableWithPagination::UpdateLabel()
+{
+    if(m_data.empty()) {
+        m_staticText->SetLabel("");
+        return;
+    }
+    int startIndex = (m_currentPage * m_linesPerPage);
+    int lastIndex = startIndex + m_linesPerPage - 1;
+    if(lastIndex >= (int)m_data.size()) { lastIndex = (m_data.size() - 1); }
     m_staticText->SetLabel(wxString() << _("Showing entries from: ") << startIndex << _(":") << lastIndex
                                       << " Total of: " << m_data.size() << _(" entries"));
 }
@@ -131,9 +157,9 @@ void clTableWithPagination::OnLineActivated(wxDataViewEvent& event)
     wxDataViewItem item = event.GetItem();
     CHECK_ITEM_RET(item);
 
-    wxArrayString* data = reinterpret_cast<wxArrayString*>(m_ctrl->GetItemData(item));
-    CHECK_PTR_RET(data);
+    size_t index = (size_t)m_ctrl->GetItemData(item);
+    if(index >= m_data.size()) { return; }
 
-    clTableLineEditorDlg* dlg = new clTableLineEditorDlg(::wxGetTopLevelParent(this), m_columns, *data);
+    clTableLineEditorDlg* dlg = new clTableLineEditorDlg(::wxGetTopLevelParent(this), m_columns, m_data[index]);
     dlg->Show();
 }
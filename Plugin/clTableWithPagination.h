@@ -26,6 +26,7 @@ protected:
     bool CanPrev() const;
 
     void ClearAllItems();
+    void UpdateLabel();
     wxString MakeDisplayString(const wxString& str) const;
     void OnLineActivated(wxDataViewEvent& event);
 
@@ -49,6 +50,12 @@ public:
      */
     void SetData(std::vector<wxArrayString>& data);
 
+    /**
+     * @brief append rows to the table. Only the current page is refreshed (and only if it is not full yet)
+     * so this can be called repeatedly while the data is being streamed
+     */
+    void AppendData(const std::vector<wxArrayString>& data);
+
     /**
      * @brief clear all data and columns from the table
      */
@@ -42,6 +42,7 @@ void clTreeCtrlModel::GetPrevItems(clRowEntry* from, int count, clRowEntry::Vec_
 wxTreeItemId clTreeCtrlModel::AddRoot(const wxString& text, int image, int selImage, wxTreeItemData* data)
 {
     if(m_root) { return wxTreeItemId(m_root); }
+    ++m_generation;
     m_root = new clRowEntry(m_tree, text, image, selImage);
     m_root->SetClientData(data);
     if(m_tree->GetTreeStyle() & wxTR_HIDE_ROOT) {
@@ -143,6 +144,7 @@ wxTreeItemId clTreeCtrlModel::AppendItem(const wxTreeItemId& parent, const wxStr
     if(!parent.IsOk()) { return wxTreeItemId(); }
     parentNode = ToPtr(parent);
 
+    ++m_generation;
     clRowEntry* child = new clRowEntry(m_tree, text, image, selImage);
     child->SetClientData(data);
     // Find the best insertion point
@@ -177,6 +179,7 @@ wxTreeItemId clTreeCtrlModel::InsertItem(const wxTreeItemId& parent, const wxTre
     clRowEntry* parentNode = ToPtr(parent);
     if(pPrev->GetParent() != parentNode) { return wxTreeItemId(); }
 
+    ++m_generation;
     clRowEntry* child = new clRowEntry(m_tree, text, image, selImage);
     child->SetClientData(data);
     parentNode->InsertChild(child, pPrev);
@@ -236,6 +239,8 @@ void clTreeCtrlModel::DeleteItem(const wxTreeItemId& item)
 
 void clTreeCtrlModel::NodeDeleted(clRowEntry* node)
 {
+    ++m_generation;
+
     // Clear the various caches
     {
         clRowEntry::Vec_t::iterator iter =
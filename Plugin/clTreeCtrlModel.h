@@ -22,6 +22,7 @@ class WXDLLIMPEXP_SDK clTreeCtrlModel
     int m_indentSize = 16;
     bool m_shutdown = false;
     clSortFunc_t m_shouldInsertBeforeFunc = nullptr;
+    size_t m_generation = 0;
 
 protected:
     void DoExpandAllChildren(const wxTreeItemId& item, bool expand);
@@ -54,6 +55,12 @@ public:
                             int selImage, wxTreeItemData* data);
     wxTreeItemId GetRootItem() const;
 
+    /**
+     * @brief return a counter that changes whenever an item is added to or deleted from the tree.
+     * Code that caches wxTreeItemId can use it to find out that its cache is stale
+     */
+    size_t GetGeneration() const { return m_generation; }
+
     void SetIndentSize(int indentSize) { this->m_indentSize = indentSize; }
     int GetIndentSize() const { return m_indentSize; }
 
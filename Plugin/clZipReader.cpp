@@ -112,3 +112,27 @@ void clZipReader::ExtractAll(std::unordered_map<wxString, Entry>& buffers)
         entry = m_zip->GetNextEntry();
     }
 }
+
+void clZipReader::ExtractAll(std::unordered_map<wxString, wxMemoryBuffer>& buffers)
+{
+    if(!m_zip) { return; }
+    wxZipEntry* entry(NULL);
+
+    entry = m_zip->GetNextEntry();
+    while(entry) {
+        if(!entry->IsDir()) {
+            wxMemoryOutputStream out;
+            if(out.IsOk()) {
+                m_zip->Read(out);
+                size_t len = out.GetLength();
+                wxMemoryBuffer buffer(len);
+                out.CopyTo(buffer.GetWriteBuf(len), len);
+                buffer.UngetWriteBuf(len);
+                buffers.erase(entry->GetName());
+                buffers.insert({ entry->GetName(), buffer });
+            }
+        }
+        wxDELETE(entry);
+        entry = m_zip->GetNextEntry();
+    }
+}
@@ -70,6 +70,11 @@ public:
      * @brief extract all zip entries and constract a map of name:memory-output-stream ptr
      */
     void ExtractAll(std::unordered_map<wxString, Entry>& buffers);
+
+    /**
+     * @brief same as above, but the memory is owned by the wxMemoryBuffer objects
+     */
+    void ExtractAll(std::unordered_map<wxString, wxMemoryBuffer>& buffers);
     
     /**
      * @brief close the zip archive
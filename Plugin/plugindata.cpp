@@ -38,6 +38,7 @@ void PluginInfo::FromJSON(const JSONItem& json)
     m_description = json.namedObject("description").toString();
     m_version = json.namedObject("version").toString();
     m_flags = json.namedObject("flags").toSize_t();
+    m_triggers = json.namedObject("triggers").toArrayString();
 }
 
 JSONItem PluginInfo::ToJSON() const
@@ -48,6 +49,7 @@ JSONItem PluginInfo::ToJSON() const
     e.addProperty("description", m_description);
     e.addProperty("version", m_version);
     e.addProperty("flags", m_flags);
+    e.addProperty("triggers", m_triggers);
     return e;
 }
 
@@ -82,6 +84,19 @@ void PluginInfoArray::FromJSON(const JSONItem& json)
         pi.FromJSON(arr.arrayItem(i));
         m_plugins.insert(std::make_pair(pi.GetName(), pi));
     }
+
+    m_manifest.clear();
+    JSONItem manifest = json.namedObject("manifest");
+    for(int i = 0; i < manifest.arraySize(); ++i) {
+        JSONItem item = manifest.arrayItem(i);
+        ManifestEntry entry;
+        wxString filename = item.namedObject("file").toString();
+        entry.name = item.namedObject("name").toString();
+        entry.interfaceVersion = item.namedObject("interfaceVersion").toInt();
+        entry.modified = item.namedObject("modified").toSize_t();
+        if(filename.IsEmpty()) { continue; }
+        m_manifest.insert({ filename, entry });
+    }
 }
 
 JSONItem PluginInfoArray::ToJSON() const
@@ -95,9 +110,34 @@ JSONItem PluginInfoArray::ToJSON() const
         arr.arrayAppend(iter->second.ToJSON());
     }
     el.append(arr);
+
+    JSONItem manifest = JSONItem::createArray("manifest");
+    for(const auto& vt : m_manifest) {
+        JSONItem item = JSONItem::createObject();
+        item.addProperty("file", vt.first);
+        item.addProperty("name", vt.second.name);
+        item.addProperty("interfaceVersion", vt.second.interfaceVersion);
+        item.addProperty("modified", vt.second.modified);
+        manifest.arrayAppend(item);
+    }
+    el.append(manifest);
     return el;
 }
 
+bool PluginInfoArray::GetManifestEntry(const wxString& filename, size_t modified, ManifestEntry& entry) const
+{
+    Manifest_t::const_iterator iter = m_manifest.find(filename);
+    if(iter == m_manifest.end() || iter->second.modified != modified) { return false; }
+    entry = iter->second;
+    return true;
+}
+
+void PluginInfoArray::SetManifestEntry(const wxString& filename, const ManifestEntry& entry)
+{
+    m_manifest.erase(filename);
+    m_manifest.insert({ filename, entry });
+}
+
 void PluginInfoArray::AddPlugin(const PluginInfo& plugin)
 {
     if(m_plugins.count(plugin.GetName())) m_plugins.erase(plugin.GetName());
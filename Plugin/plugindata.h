@@ -46,6 +46,7 @@ protected:
     wxString m_description;
     wxString m_version;
     size_t m_flags;
+    wxArrayString m_triggers;
 
 public:
     typedef std::map<wxString, PluginInfo> PluginMap_t;
@@ -70,6 +71,19 @@ public:
     }
     bool HasFlag(PluginInfo::eFlags flag) const { return m_flags & flag; }
 
+    /**
+     * @brief the triggers that activate the plugin when lazy plugin activation is enabled.
+     * A plugin with no triggers is always loaded on startup. Supported triggers:
+     * "file:<ext>" - an editor for a file with this extension becomes active
+     * "workspace:<type>" - a workspace of this type is loaded (see IWorkspace::GetWorkspaceType())
+     * "menu:<explorer|workspace|project|folder|file|editor>" - this context menu is about to be shown
+     * "event:<build|debug>" - a build or a debug session is starting
+     * A plugin is constructed after its trigger fired, so it will not receive the event that activated it.
+     * It should initialise itself from the current state of the IDE instead
+     */
+    void SetTriggers(const wxArrayString& triggers) { this->m_triggers = triggers; }
+    const wxArrayString& GetTriggers() const { return m_triggers; }
+
     // Getters
     const wxString& GetAuthor() const { return m_author; }
     const wxString& GetDescription() const { return m_description; }
@@ -82,8 +96,22 @@ public:
 
 class WXDLLIMPEXP_SDK PluginInfoArray : public clConfigItem
 {
+public:
+    /**
+     * @brief what we know about a plugin shared object from a previous run.
+     * Used to skip loading shared objects that will be rejected anyway
+     */
+    struct ManifestEntry {
+        wxString name;
+        int interfaceVersion = 0;
+        size_t modified = 0;
+    };
+    typedef std::map<wxString, ManifestEntry> Manifest_t;
+
+protected:
     PluginInfo::PluginMap_t m_plugins;
     wxArrayString m_disabledPlugins;
+    Manifest_t m_manifest;
 
 public:
     PluginInfoArray();
@@ -97,6 +125,13 @@ public:
     void DisablePugins(const wxArrayString& plugins);
     void DisablePlugin(const wxString& plugin);
     const wxArrayString& GetDisabledPlugins() const { return m_disabledPlugins; }
+
+    /**
+     * @brief find the manifest entry of a shared object. The entry is returned only
+     * if the file was not modified since it was recorded
+     */
+    bool GetManifestEntry(const wxString& filename, size_t modified, ManifestEntry& entry) const;
+    void SetManifestEntry(const wxString& filename, const ManifestEntry& entry);
     virtual void FromJSON(const JSONItem& json);
     virtual JSONItem ToJSON() const;
 };
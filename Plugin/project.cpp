@@ -117,7 +117,17 @@ bool Project::Create(const wxString& name, const wxString& description, const wx
 
 bool Project::Load(const wxString& path)
 {
-    if(!m_doc.Load(path)) { return false; }
+    wxXmlDocument doc;
+    if(!doc.Load(path)) { return false; }
+    return Load(path, doc);
+}
+
+bool Project::Load(const wxString& path, wxXmlDocument& doc)
+{
+    if(!doc.IsOk()) { return false; }
+    m_doc.SetRoot(doc.DetachRoot());
+    m_doc.SetVersion(doc.GetVersion());
+    m_doc.SetFileEncoding(doc.GetFileEncoding());
 
     // Workaround WX bug: load the plugins data (GetAllPluginsData will strip any trailing whitespaces)
     // and then set them back
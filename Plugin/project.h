@@ -460,6 +460,12 @@ public:
      * \return
      */
     bool Load(const wxString& path);
+    /**
+     * Load project from an already parsed document. The document root is moved into the project
+     * \param path the project file
+     * \param doc the parsed project file
+     */
+    bool Load(const wxString& path, wxXmlDocument& doc);
     /**
      * \brief Create new project
      * \param name project name
@@ -30,10 +30,26 @@
 #include "globals.h"
 #include "symbol_tree.h"
 #include "tokenizer.h"
+#include <deque>
 #include <functional>
 #include <imanager.h>
+#include <unordered_map>
 #include <wx/wupdlock.h>
 
+#define GLOBALS_NODE_TEXT wxT("Global Functions and Variables")
+#define PROTOTYPES_NODE_TEXT wxT("Functions Prototypes")
+#define MACROS_NODE_TEXT wxT("Macros")
+
+// An item as BuildTree() would create it
+struct SymbolTree::SymbolTreeItem {
+    wxString key;
+    wxString label;
+    int image = wxNOT_FOUND;
+    wxFont font;
+    TagNode* node = nullptr; // nullptr for the root and the group nodes
+    std::vector<SymbolTreeItem*> children;
+};
+
 SymbolTree::SymbolTree()
     : m_sortByLineNumber(true)
 {
@@ -51,7 +67,7 @@ SymbolTree::SymbolTree()
             img2 = b->GetBitmapIndex();
             if(img1 < img2)
                 return true;
-            else if(img1 < img2)
+            else if(img1 > img2)
                 return false;
             else {
                 // Items  has the same icons, compare text
@@ -80,7 +96,7 @@ SymbolTree::SymbolTree(wxWindow* parent, const wxWindowID id, const wxPoint& pos
             img2 = b->GetBitmapIndex();
             if(img1 < img2)
                 return true;
-            else if(img1 < img2)
+            else if(img1 > img2)
                 return false;
             else {
                 // Items  has the same icons, compare text
@@ -204,12 +220,13 @@ void SymbolTree::BuildTree(const wxFileName& fileName, const TagEntryPtrVector_t
     // add three items here:
     // the globals node, the mcros and the prototype node
     int nodeImgIdx = clGetManager()->GetStdIcons()->GetImageIndex(BitmapLoader::kAngleBrackets);
-    m_globalsNode = AppendItem(root, wxT("Global Functions and Variables"), nodeImgIdx, nodeImgIdx,
-                               new MyTreeItemData(wxT("Global Functions and Variables"), wxEmptyString));
-    m_prototypesNode = AppendItem(root, wxT("Functions Prototypes"), nodeImgIdx, nodeImgIdx,
-                                  new MyTreeItemData(wxT("Functions Prototypes"), wxEmptyString));
-    m_macrosNode =
-        AppendItem(root, wxT("Macros"), nodeImgIdx, nodeImgIdx, new MyTreeItemData(wxT("Macros"), wxEmptyString));
+    m_globalsNode = AppendItem(root, GLOBALS_NODE_TEXT, nodeImgIdx, nodeImgIdx,
+                               new MyTreeItemData(GLOBALS_NODE_TEXT, wxEmptyString, wxNOT_FOUND, GLOBALS_NODE_TEXT));
+    m_prototypesNode =
+        AppendItem(root, PROTOTYPES_NODE_TEXT, nodeImgIdx, nodeImgIdx,
+                   new MyTreeItemData(PROTOTYPES_NODE_TEXT, wxEmptyString, wxNOT_FOUND, PROTOTYPES_NODE_TEXT));
+    m_macrosNode = AppendItem(root, MACROS_NODE_TEXT, nodeImgIdx, nodeImgIdx,
+                              new MyTreeItemData(MACROS_NODE_TEXT, wxEmptyString, wxNOT_FOUND, MACROS_NODE_TEXT));
 
     for(; !walker.End(); walker++) {
         // Add the item to the tree
@@ -227,6 +244,207 @@ void SymbolTree::BuildTree(const wxFileName& fileName, const TagEntryPtrVector_t
     if(ItemHasChildren(m_macrosNode) == false) { Delete(m_macrosNode); }
 }
 
+bool SymbolTree::UpdateTree(const wxFileName& fileName, const TagEntryPtrVector_t& tags)
+{
+    wxTreeItemId root = GetRootItem();
+    if(!m_tree || !root.IsOk() || tags.empty() || m_fileName != fileName) {
+        BuildTree(fileName, tags, true);
+        return false;
+    }
+
+    TagEntryPtrVector_t newTags(tags.begin(), tags.end());
+    TagTreePtr tree = TagsManagerST::Get()->Load(fileName, &newTags);
+    if(!tree) {
+        BuildTree(fileName, tags, true);
+        return false;
+    }
+
+    // Compute the items BuildTree() would create, following the same rules as AddItem()
+    std::deque<SymbolTreeItem> items;
+    SymbolTreeItem desiredRoot;
+    int nodeImgIdx = clGetManager()->GetStdIcons()->GetImageIndex(BitmapLoader::kAngleBrackets);
+    auto AddGroup = [&](const wxString& label) {
+        items.push_back(SymbolTreeItem());
+        items.back().key = label;
+        items.back().label = label;
+        items.back().image = nodeImgIdx;
+        return &items.back();
+    };
+    SymbolTreeItem* globals = AddGroup(GLOBALS_NODE_TEXT);
+    SymbolTreeItem* prototypes = AddGroup(PROTOTYPES_NODE_TEXT);
+    SymbolTreeItem* macros = AddGroup(MACROS_NODE_TEXT);
+
+    std::unordered_map<TagNode*, SymbolTreeItem*> nodesMap;
+    TreeWalker<wxString, TagEntry> walker(tree->GetRoot());
+    for(; !walker.End(); walker++) {
+        TagNode* node = walker.GetNode();
+        if(node->IsRoot()) continue;
+
+        const TagEntry& tag = node->GetData();
+        if(tag.GetName().IsEmpty()) continue;
+
+        SymbolTreeItem* parent = &desiredRoot;
+        if(tag.GetKind() == wxT("macro")) {
+            parent = macros;
+        } else if((tag.GetParent() == wxT("<global>")) && m_globalsKind.count(tag.GetKind())) {
+            parent = (tag.GetKind() == wxT("prototype")) ? prototypes : globals;
+        } else if(nodesMap.count(node->GetParent())) {
+            parent = nodesMap[node->GetParent()];
+        }
+
+        items.push_back(SymbolTreeItem());
+        SymbolTreeItem* item = &items.back();
+        item->key = node->GetKey();
+        item->label = tag.GetDisplayName();
+        item->image = GetItemIconIndex(tag.GetKind(), tag.GetAccess());
+        item->font = DoGetTagFont(tag);
+        item->node = node;
+        parent->children.push_back(item);
+        nodesMap[node] = item;
+    }
+
+    // Empty groups are not displayed
+    for(SymbolTreeItem* group : { macros, prototypes, globals }) {
+        if(!group->children.empty()) { desiredRoot.children.insert(desiredRoot.children.begin(), group); }
+    }
+
+    wxWindowUpdateLocker locker(this);
+    m_items.clear();
+    if(!DoUpdateChildren(root, &desiredRoot)) {
+        // Some items moved, rebuild the tree to keep the sort order
+        BuildTree(fileName, tags, true);
+        return false;
+    }
+    m_tree = tree;
+    m_currentTags.swap(newTags);
+
+    m_globalsNode = wxTreeItemId();
+    m_prototypesNode = wxTreeItemId();
+    m_macrosNode = wxTreeItemId();
+    wxTreeItemIdValue cookie;
+    wxTreeItemId child = GetFirstChild(root, cookie);
+    while(child.IsOk()) {
+        MyTreeItemData* data = dynamic_cast<MyTreeItemData*>(GetItemData(child));
+        if(data && data->GetKey() == GLOBALS_NODE_TEXT) {
+            m_globalsNode = child;
+        } else if(data && data->GetKey() == PROTOTYPES_NODE_TEXT) {
+            m_prototypesNode = child;
+        } else if(data && data->GetKey() == MACROS_NODE_TEXT) {
+            m_macrosNode = child;
+        }
+        child = GetNextChild(root, cookie);
+    }
+    return true;
+}
+
+bool SymbolTree::DoUpdateChildren(const wxTreeItemId& parent, const SymbolTreeItem* desired)
+{
+    // Index the current children by their key. Items without a key were not added by us, leave them alone
+    std::unordered_map<wxString, wxTreeItemId> current;
+    wxTreeItemIdValue cookie;
+    wxTreeItemId child = GetFirstChild(parent, cookie);
+    while(child.IsOk()) {
+        MyTreeItemData* data = dynamic_cast<MyTreeItemData*>(GetItemData(child));
+        if(data && !data->GetKey().IsEmpty()) { current.insert({ data->GetKey(), child }); }
+        child = GetNextChild(parent, cookie);
+    }
+
+    bool sorted = true;
+    for(const SymbolTreeItem* item : desired->children) {
+        std::unordered_map<wxString, wxTreeItemId>::iterator iter = current.find(item->key);
+        if(iter == current.end()) {
+            // AppendItem() places the item using the sort function, the order is verified below
+            DoAppendItem(parent, item);
+            continue;
+        }
+
+        wxTreeItemId hti = iter->second;
+        current.erase(iter);
+        // The icon and the label are part of the alphabetical sort
+        if(GetItemText(hti) != item->label) {
+            SetItemText(hti, item->label);
+            if(!m_sortByLineNumber) { sorted = false; }
+        }
+        if(GetItemImage(hti) != item->image) {
+            SetItemImage(hti, item->image, item->image);
+            if(!m_sortByLineNumber) { sorted = false; }
+        }
+        if(item->node) {
+            TagEntry& tag = item->node->GetData();
+            if(GetItemFont(hti) != item->font) { SetItemFont(hti, item->font); }
+            MyTreeItemData* data = static_cast<MyTreeItemData*>(GetItemData(hti));
+            if(data->GetLine() != tag.GetLine() || data->GetPattern() != tag.GetPattern() ||
+               data->GetFileName() != tag.GetFile()) {
+                SetItemData(hti, new MyTreeItemData(tag.GetFile(), tag.GetPattern(), tag.GetLine(), item->key));
+            }
+            tag.SetTreeItemId(hti);
+            m_items[item->key] = hti.m_pItem;
+        }
+        if(!DoUpdateChildren(hti, item)) { sorted = false; }
+    }
+
+    // Whatever is left was removed from the file
+    for(const auto& p : current) {
+        Delete(p.second);
+    }
+
+    if(sorted && m_sortByLineNumber) {
+        // Lines usually shift together, but code that was moved breaks the order
+        int prevLine = wxNOT_FOUND;
+        child = GetFirstChild(parent, cookie);
+        while(child.IsOk() && sorted) {
+            MyTreeItemData* data = dynamic_cast<MyTreeItemData*>(GetItemData(child));
+            if(data) {
+                sorted = (data->GetLine() >= prevLine);
+                prevLine = data->GetLine();
+            }
+            child = GetNextChild(parent, cookie);
+        }
+    } else if(sorted) {
+        // Alphabetical order: by icon and then by label, same as the sort function
+        wxTreeItemId prev;
+        child = GetFirstChild(parent, cookie);
+        while(child.IsOk() && sorted) {
+            if(prev.IsOk()) {
+                int prevImg = GetItemImage(prev);
+                int img = GetItemImage(child);
+                sorted = (prevImg < img) || ((prevImg == img) && GetItemText(prev).CmpNoCase(GetItemText(child)) <= 0);
+            }
+            prev = child;
+            child = GetNextChild(parent, cookie);
+        }
+    }
+    return sorted;
+}
+
+void SymbolTree::DoAppendItem(const wxTreeItemId& parent, const SymbolTreeItem* desired)
+{
+    wxTreeItemId hti;
+    if(desired->node) {
+        TagEntry& tag = desired->node->GetData();
+        hti = AppendItem(parent, desired->label, desired->image, desired->image,
+                         new MyTreeItemData(tag.GetFile(), tag.GetPattern(), tag.GetLine(), desired->key));
+        SetItemFont(hti, desired->font);
+        tag.SetTreeItemId(hti);
+        m_items[desired->key] = hti.m_pItem;
+    } else {
+        hti = AppendItem(parent, desired->label, desired->image, desired->image,
+                         new MyTreeItemData(desired->label, wxEmptyString, wxNOT_FOUND, desired->key));
+    }
+
+    for(const SymbolTreeItem* child : desired->children) {
+        DoAppendItem(hti, child);
+    }
+}
+
+wxFont SymbolTree::DoGetTagFont(const TagEntry& tag) const
+{
+    wxFont font = clScrolledPanel::GetDefaultFont();
+    if(tag.GetKind() == wxT("prototype")) { font.SetStyle(wxFONTSTYLE_ITALIC); }
+    if(tag.GetAccess() == wxT("public")) { font.SetWeight(wxFONTWEIGHT_BOLD); }
+    return font;
+}
+
 void SymbolTree::AddItem(TagNode* node)
 {
     // Get node icon index
@@ -238,9 +456,7 @@ void SymbolTree::AddItem(TagNode* node)
     wxTreeItemId parentHti;
     if(nodeData.GetName().IsEmpty()) return;
 
-    wxFont font = clScrolledPanel::GetDefaultFont();
-    if(nodeData.GetKind() == wxT("prototype")) { font.SetStyle(wxFONTSTYLE_ITALIC); }
-    if(nodeData.GetAccess() == wxT("public")) { font.SetWeight(wxFONTWEIGHT_BOLD); }
+    wxFont font = DoGetTagFont(nodeData);
 
     //-------------------------------------------------------------------------------
     // We gather globals together under special node
@@ -271,7 +487,8 @@ void SymbolTree::AddItem(TagNode* node)
             displayName, // display name
             iconIndex,   // item image index
             iconIndex,   // selected item image
-            new MyTreeItemData(node->GetData().GetFile(), node->GetData().GetPattern(), node->GetData().GetLine()));
+            new MyTreeItemData(node->GetData().GetFile(), node->GetData().GetPattern(), node->GetData().GetLine(),
+                               node->GetKey()));
         SetItemFont(hti, font);
         node->GetData().SetTreeItemId(hti);
         m_items[nodeData.Key()] = hti.m_pItem;
@@ -338,11 +555,8 @@ void SymbolTree::UpdateGuiItem(TagEntry& data, const wxString& key)
                 SetItemImage(node->GetData().GetTreeItemId(), iconIndex, wxTreeItemIcon_Selected);
 
             } // if(curIconIndex != iconIndex )
-            // update the linenumber and file
-            MyTreeItemData* item_data = new MyTreeItemData(data.GetFile(), data.GetPattern());
-            wxTreeItemData* old_data = GetItemData(itemId);
-            if(old_data) delete old_data;
-            SetItemData(itemId, item_data);
+            // update the linenumber and file (SetItemData deletes the old data)
+            SetItemData(itemId, new MyTreeItemData(data.GetFile(), data.GetPattern(), data.GetLine(), key));
         }
     }
 }
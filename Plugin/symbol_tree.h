@@ -47,23 +47,28 @@ private:
     wxString m_fileName;
     wxString m_pattern;
     int m_lineno;
+    wxString m_key;
 
 public:
     /**
      * Constructor.
      * \param filename The full name the file
      * \param pattern search pattern for this item in the file
+     * \param key the item key in the symbol tree
      */
-    MyTreeItemData(const wxString& filename, const wxString& pattern, int lineno = wxNOT_FOUND)
+    MyTreeItemData(const wxString& filename, const wxString& pattern, int lineno = wxNOT_FOUND,
+                   const wxString& key = wxEmptyString)
         : m_fileName(filename)
         , m_pattern(pattern)
         , m_lineno(lineno)
+        , m_key(key)
     {
     }
 
     const wxString& GetFileName() const { return m_fileName; }
     const wxString& GetPattern() const { return m_pattern; }
     int GetLine() const { return m_lineno; }
+    const wxString& GetKey() const { return m_key; }
 };
 
 /**
@@ -132,6 +137,14 @@ public:
      */
     virtual void BuildTree(const wxFileName& fileName, const TagEntryPtrVector_t& tags, bool forceBuild = false);
 
+    /**
+     * Update the outline tree of fileName to match 'tags'. Only the items that were added, removed or modified
+     * are touched, so the expansion state and selection are kept.
+     * Falls back to BuildTree() when the tree shows another file or the items order can not be kept
+     * \return true if the tree was updated incrementally, false if it was rebuilt
+     */
+    virtual bool UpdateTree(const wxFileName& fileName, const TagEntryPtrVector_t& tags);
+
     /**
      * User provided icons for the symbols tree.
      * The assignment is index based, in the following order:
@@ -178,8 +191,22 @@ public:
     bool IsSortByLineNumber() const { return m_sortByLineNumber; }
 
 protected:
+    struct SymbolTreeItem;
+
     bool Matches(const wxTreeItemId& item, const wxString& patter);
 
+    /**
+     * Make the children of 'parent' match the children of 'desired'
+     * \return false if the children order no longer matches the sort order
+     */
+    bool DoUpdateChildren(const wxTreeItemId& parent, const SymbolTreeItem* desired);
+    void DoAppendItem(const wxTreeItemId& parent, const SymbolTreeItem* desired);
+
+    /**
+     * Return the font used to display a tag
+     */
+    wxFont DoGetTagFont(const TagEntry& tag) const;
+
     void GetItemChildrenRecursive(wxTreeItemId& parent, std::map<void*, bool>& deletedMap);
 
     /**
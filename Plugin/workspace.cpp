@@ -22,6 +22,7 @@
 //
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
+#include "clProjectSnapshot.h"
 #include "cl_command_event.h"
 #include "codelite_events.h"
 #include "ctags_manager.h"
@@ -49,6 +50,9 @@
 #include "compiler_command_line_parser.h"
 #include "fileutils.h"
 #include <wx/sstream.h>
+#include <wx/stopwatch.h>
+#include <atomic>
+#include <thread>
 
 clCxxWorkspace::clCxxWorkspace()
     : m_saveOnExit(true)
@@ -480,18 +484,29 @@ ProjectPtr clCxxWorkspace::DoAddProject(ProjectPtr proj)
 
 ProjectPtr clCxxWorkspace::DoAddProject(const wxString& path, const wxString& projectVirtualFolder, wxString& errMsg)
 {
-    // Add the project
-    ProjectPtr proj(new Project());
-
     // Convert the path to absolute path
     wxFileName projectFile(path);
     if(projectFile.IsRelative()) { projectFile.MakeAbsolute(m_fileName.GetPath()); }
 
-    if(!proj->Load(projectFile.GetFullPath())) {
+    wxXmlDocument doc;
+    if(!doc.Load(projectFile.GetFullPath())) {
         errMsg = wxT("Corrupted project file '");
         errMsg << projectFile.GetFullPath() << wxT("'");
         return NULL;
     }
+    return DoAddProject(projectFile.GetFullPath(), projectVirtualFolder, doc, errMsg);
+}
+
+ProjectPtr clCxxWorkspace::DoAddProject(const wxString& path, const wxString& projectVirtualFolder, wxXmlDocument& doc,
+                                        wxString& errMsg)
+{
+    // Add the project
+    ProjectPtr proj(new Project());
+    if(!proj->Load(path, doc)) {
+        errMsg = wxT("Corrupted project file '");
+        errMsg << path << wxT("'");
+        return NULL;
+    }
 
     // Add an entry to the projects map
     m_projects.insert(std::make_pair(proj->GetName(), proj));
@@ -1245,20 +1260,69 @@ void clCxxWorkspace::DoUnselectActiveProject()
 
 void clCxxWorkspace::DoLoadProjectsFromXml(wxXmlNode* parentNode, const wxString& folder,
                                            std::vector<wxXmlNode*>& removedChildren)
+{
+    wxStopWatch sw;
+    std::vector<ProjectXmlEntry> projects;
+    DoCollectProjectsFromXml(parentNode, folder, projects);
+
+    // Parsing the projects is the expensive part, do it in parallel. Projects that did not change since the
+    // workspace was last opened are loaded from their binary snapshot
+    wxString snapshotsFolder = GetPrivateFolder() + wxFileName::GetPathSeparator() + "snapshots";
+    {
+        wxLogNull nolog;
+        wxMkdir(snapshotsFolder);
+    }
+
+    std::atomic_size_t nextProject(0);
+    size_t workersCount = std::max(1, wxThread::GetCPUCount());
+    workersCount = std::min(workersCount, projects.size());
+
+    std::vector<std::thread> workers;
+    for(size_t i = 0; i < workersCount; ++i) {
+        workers.push_back(std::thread([&]() {
+            size_t index = nextProject++;
+            while(index < projects.size()) {
+                ProjectXmlEntry& entry = projects[index];
+                entry.loaded = clProjectSnapshot::Load(entry.path, snapshotsFolder, entry.doc);
+                index = nextProject++;
+            }
+        }));
+    }
+    for(std::thread& worker : workers) {
+        worker.join();
+    }
+
+    // Add the projects to the workspace from the main thread
+    for(ProjectXmlEntry& entry : projects) {
+        wxString errmsg;
+        if(!entry.loaded || !DoAddProject(entry.path, entry.folder, entry.doc, errmsg)) {
+            removedChildren.push_back(entry.node);
+        }
+    }
+    clDEBUG() << "Loaded" << projects.size() << "projects in" << sw.Time() << "ms" << clEndl;
+}
+
+void clCxxWorkspace::DoCollectProjectsFromXml(wxXmlNode* parentNode, const wxString& folder,
+                                              std::vector<ProjectXmlEntry>& projects)
 {
     wxXmlNode* child = parentNode->GetChildren();
     while(child) {
         if(child->GetName() == wxT("Project")) {
-            wxString projectPath = child->GetPropVal(wxT("Path"), wxEmptyString);
-            wxString errmsg;
-            if(!DoAddProject(projectPath, folder, errmsg)) { removedChildren.push_back(child); }
+            // Convert the path to absolute path
+            wxFileName projectFile(child->GetPropVal(wxT("Path"), wxEmptyString));
+            if(projectFile.IsRelative()) { projectFile.MakeAbsolute(m_fileName.GetPath()); }
+
+            projects.push_back(ProjectXmlEntry());
+            projects.back().node = child;
+            projects.back().path = projectFile.GetFullPath();
+            projects.back().folder = folder;
         } else if(child->GetName() == wxT("VirtualDirectory")) {
             // Virtual directory
             wxString currentFolder = folder;
             wxString vdName = child->GetAttribute("Name", wxEmptyString);
             if(!currentFolder.IsEmpty()) { currentFolder << "/"; }
             currentFolder << vdName;
-            DoLoadProjectsFromXml(child, currentFolder, removedChildren);
+            DoCollectProjectsFromXml(child, currentFolder, projects);
         } else if((child->GetName() == wxT("WorkspaceParserPaths")) ||
                   (child->GetName() == wxT("WorkspaceParserMacros"))) {
             wxString swtlw = XmlUtils::ReadString(m_doc.GetRoot(), "SWTLW");
@@ -68,6 +68,15 @@ public:
     typedef std::unordered_map<wxString, ProjectPtr> ProjectMap_t;
 
 protected:
+    // A project referenced by the workspace XML, loaded on a worker thread
+    struct ProjectXmlEntry {
+        wxXmlNode* node = nullptr;
+        wxString path;
+        wxString folder;
+        wxXmlDocument doc;
+        bool loaded = false;
+    };
+
     wxXmlDocument m_doc;
     wxFileName m_fileName;
     ProjectMap_t m_projects;
@@ -113,6 +122,12 @@ private:
      */
     void DoLoadProjectsFromXml(wxXmlNode* parentNode, const wxString& folder, std::vector<wxXmlNode*>& removedChildren);
 
+    /**
+     * @brief collect the projects referenced by the XML file
+     */
+    void DoCollectProjectsFromXml(wxXmlNode* parentNode, const wxString& folder,
+                                  std::vector<ProjectXmlEntry>& projects);
+
     // return the wxXmlNode instance for the give path
     // the path is separated by "/"
     // return NULL if no such virtual directory exists
@@ -503,6 +518,12 @@ private:
      * \param errMsg [output] incase an error, report the error to the caller
      */
     ProjectPtr DoAddProject(const wxString& path, const wxString& projectVirtualFolder, wxString& errMsg);
+    /**
+     * Add a project that was already parsed
+     * \param doc the parsed project file. Its content is moved into the project
+     */
+    ProjectPtr DoAddProject(const wxString& path, const wxString& projectVirtualFolder, wxXmlDocument& doc,
+                            wxString& errMsg);
     ProjectPtr DoAddProject(ProjectPtr proj);
 
     void RemoveProjectFromBuildMatrix(ProjectPtr prj);
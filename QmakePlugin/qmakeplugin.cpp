@@ -66,6 +66,10 @@ CL_PLUGIN_API PluginInfo* GetPluginInfo()
     info.SetName(wxT("QMakePlugin"));
     info.SetDescription(_("Qt's QMake integration with CodeLite"));
     info.SetVersion(wxT("v1.0"));
+    // Everything this plugin does requires a C++ workspace
+    wxArrayString triggers;
+    triggers.Add("workspace:C++");
+    info.SetTriggers(triggers);
     return &info;
 }
 
@@ -1,23 +1,92 @@
 #include "SmartCompletionUsageDB.h"
 #include "cl_standard_paths.h"
 #include "file_logger.h"
+#include <chrono>
 #include <wx/filename.h>
 
-SmartCompletionUsageDB::SmartCompletionUsageDB() {}
+// How long the writer waits for more selections before writing them in a single transaction
+#define USAGE_WRITE_DELAY_MS 2000
+
+SmartCompletionUsageDB::SmartCompletionUsageDB()
+    : m_shutdown(false)
+{
+}
 
 SmartCompletionUsageDB::~SmartCompletionUsageDB() { Close(); }
 
 void SmartCompletionUsageDB::Open()
 {
-    try {
-        if(m_db.IsOpen()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_dbLock);
+        try {
+            if(m_db.IsOpen()) return;
 
-        wxFileName fn(clStandardPaths::Get().GetUserDataDir(), "SmartCompletions.db");
-        fn.AppendDir("config");
-        m_db.Open(fn.GetFullPath());
-        CreateScheme();
+            wxFileName fn(clStandardPaths::Get().GetUserDataDir(), "SmartCompletions.db");
+            fn.AppendDir("config");
+            m_db.Open(fn.GetFullPath());
+            CreateScheme();
+        } catch(wxSQLite3Exception& e) {
+            clWARNING() << "Failed to open SmartCompletions DB:" << e.GetMessage() << clEndl;
+        }
+    }
+
+    if(!m_writer.joinable()) {
+        m_shutdown = false;
+        m_writer = std::thread(&SmartCompletionUsageDB::WriterMain, this);
+    }
+}
+
+void SmartCompletionUsageDB::WriterMain()
+{
+    std::unique_lock<std::mutex> lock(m_pendingLock);
+    while(!m_shutdown) {
+        m_pendingCond.wait(lock, [&]() { return m_shutdown || !m_pendingCC.empty() || !m_pendingGTA.empty(); });
+        // Give the following selections a chance to join this transaction
+        m_pendingCond.wait_for(lock, std::chrono::milliseconds(USAGE_WRITE_DELAY_MS), [&]() { return m_shutdown; });
+        lock.unlock();
+        Flush();
+        lock.lock();
+    }
+}
+
+void SmartCompletionUsageDB::Flush()
+{
+    // Take the batch while holding the database lock: batches must reach the database in the order
+    // they were taken, otherwise an older weight could replace a newer one
+    std::lock_guard<std::mutex> lock(m_dbLock);
+    WeightTable_t cc, gta;
+    {
+        std::lock_guard<std::mutex> pendingLock(m_pendingLock);
+        cc.swap(m_pendingCC);
+        gta.swap(m_pendingGTA);
+    }
+    if(cc.empty() && gta.empty()) return;
+    if(!m_db.IsOpen()) return;
+
+    try {
+        m_db.Begin();
+        StoreUsage("CC_USAGE", cc);
+        StoreUsage("GOTO_ANYTHING_USAGE", gta);
+        m_db.Commit();
     } catch(wxSQLite3Exception& e) {
-        clWARNING() << "Failed to open SmartCompletions DB:" << e.GetMessage() << clEndl;
+        clWARNING() << "SQLite 3 error:" << e.GetMessage() << clEndl;
+        try {
+            m_db.Rollback();
+        } catch(wxSQLite3Exception&) {
+        }
+    }
+}
+
+void SmartCompletionUsageDB::StoreUsage(const wxString& table, const WeightTable_t& weights)
+{
+    if(weights.empty()) return;
+    wxSQLite3Statement st =
+        m_db.PrepareStatement(wxString() << "replace into " << table << " (ID, NAME, WEIGHT) values (NULL, ?, ?)");
+    for(const auto& p : weights) {
+        st.Bind(1, p.first);
+        st.Bind(2, p.second);
+        st.ExecuteUpdate();
+        st.Reset();
     }
 }
 
@@ -61,6 +130,8 @@ void SmartCompletionUsageDB::CreateScheme()
 
 void SmartCompletionUsageDB::LoadCCUsageTable(std::unordered_map<wxString, int>& weightTable)
 {
+    Flush();
+    std::lock_guard<std::mutex> lock(m_dbLock);
     try {
         weightTable.clear();
         wxSQLite3ResultSet res = m_db.ExecuteQuery("select NAME,WEIGHT from CC_USAGE");
@@ -76,6 +147,8 @@ void SmartCompletionUsageDB::LoadCCUsageTable(std::unordered_map<wxString, int>&
 
 void SmartCompletionUsageDB::LoadGTAUsageTable(std::unordered_map<wxString, int>& weightTable)
 {
+    Flush();
+    std::lock_guard<std::mutex> lock(m_dbLock);
     try {
         weightTable.clear();
         wxSQLite3ResultSet res = m_db.ExecuteQuery("select NAME,WEIGHT from GOTO_ANYTHING_USAGE");
@@ -91,20 +164,24 @@ void SmartCompletionUsageDB::LoadGTAUsageTable(std::unordered_map<wxString, int>
 
 void SmartCompletionUsageDB::StoreCCUsage(const wxString& key, int weight)
 {
-    try {
-        m_db.Begin();
-        wxSQLite3Statement st = m_db.PrepareStatement("replace into CC_USAGE (ID, NAME, WEIGHT) values (NULL, ?, ?)");
-        st.Bind(1, key);
-        st.Bind(2, weight);
-        st.ExecuteUpdate();
-        m_db.Commit();
-    } catch(wxSQLite3Exception& e) {
-        clWARNING() << "SQLite 3 error:" << e.GetMessage() << clEndl;
-    }
+    std::lock_guard<std::mutex> lock(m_pendingLock);
+    m_pendingCC[key] = weight;
+    m_pendingCond.notify_one();
 }
 
 void SmartCompletionUsageDB::Close()
 {
+    if(m_writer.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_pendingLock);
+            m_shutdown = true;
+        }
+        m_pendingCond.notify_one();
+        m_writer.join();
+    }
+    Flush();
+
+    std::lock_guard<std::mutex> lock(m_dbLock);
     if(m_db.IsOpen()) {
         try {
             m_db.Close();
@@ -116,6 +193,13 @@ void SmartCompletionUsageDB::Close()
 
 void SmartCompletionUsageDB::Clear()
 {
+    std::lock_guard<std::mutex> lock(m_dbLock);
+    {
+        std::lock_guard<std::mutex> pendingLock(m_pendingLock);
+        m_pendingCC.clear();
+        m_pendingGTA.clear();
+    }
+
     try {
         m_db.Begin();
         wxString sql = "delete from CC_USAGE";
@@ -131,15 +215,7 @@ void SmartCompletionUsageDB::Clear()
 
 void SmartCompletionUsageDB::StoreGTAUsage(const wxString& key, int weight)
 {
-    try {
-        m_db.Begin();
-        wxSQLite3Statement st =
-            m_db.PrepareStatement("replace into GOTO_ANYTHING_USAGE (ID, NAME, WEIGHT) values (NULL, ?, ?)");
-        st.Bind(1, key);
-        st.Bind(2, weight);
-        st.ExecuteUpdate();
-        m_db.Commit();
-    } catch(wxSQLite3Exception& e) {
-        clWARNING() << "SQLite 3 error:" << e.GetMessage() << clEndl;
-    }
+    std::lock_guard<std::mutex> lock(m_pendingLock);
+    m_pendingGTA[key] = weight;
+    m_pendingCond.notify_one();
 }
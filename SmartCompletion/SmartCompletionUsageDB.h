@@ -2,16 +2,33 @@
 #define SMARTCOMPLETIONUSAGEDB_H
 
 #include "wxStringHash.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 #include <wx/string.h>
 #include <wx/wxsqlite3.h>
 
 class SmartCompletionUsageDB
 {
+    typedef std::unordered_map<wxString, int> WeightTable_t;
+
     wxSQLite3Database m_db;
+    // When both locks are needed, m_dbLock is taken first
+    std::mutex m_dbLock;
+
+    // Weights waiting to be written by the writer thread. Only the last weight of a key is kept
+    WeightTable_t m_pendingCC;
+    WeightTable_t m_pendingGTA;
+    bool m_shutdown;
+    std::mutex m_pendingLock;
+    std::condition_variable m_pendingCond;
+    std::thread m_writer;
 
 protected:
     void CreateScheme();
+    void WriterMain();
+    void StoreUsage(const wxString& table, const WeightTable_t& weights);
 
 public:
     SmartCompletionUsageDB();
@@ -37,15 +54,22 @@ public:
     void LoadGTAUsageTable(std::unordered_map<wxString, int>& weightTable);
 
     /**
-     * @brief write the CC usage to the database
+     * @brief write the CC usage to the database. The write is done in the background, together with other
+     * selections made in the meantime
      */
     void StoreCCUsage(const wxString& key, int weight);
-    
+
     /**
-     * @brief write the GTA usage to the database
+     * @brief write the GTA usage to the database. The write is done in the background, together with other
+     * selections made in the meantime
      */
     void StoreGTAUsage(const wxString& key, int weight);
-    
+
+    /**
+     * @brief write all the pending usage to the database
+     */
+    void Flush();
+
     /**
      * @brief clear the content of the database
      */
@@ -83,12 +83,10 @@ void SmartCompletion::OnCodeCompletionSelectionMade(clCodeCompletionEvent& event
         WeightTable_t& T = *m_pCCWeight;
         // we have an associated tag
         wxString k = tag->GetScope() + "::" + tag->GetName();
-        if(T.count(k) == 0) {
-            T[k] = 1;
-        } else {
-            T[k]++;
-        }
-        m_config.GetUsageDb().StoreCCUsage(k, T[k]);
+        int& weight = T[k];
+        ++weight;
+        // Written to the database in the background
+        m_config.GetUsageDb().StoreCCUsage(k, weight);
     }
 }
 
@@ -109,8 +107,9 @@ void SmartCompletion::OnCodeCompletionShowing(clCodeCompletionEvent& event)
         wxCodeCompletionBoxEntry::Ptr_t entry = (*iter);
         if(entry->GetTag()) {
             wxString k = entry->GetTag()->GetScope() + "::" + entry->GetTag()->GetName();
-            if(m_pCCWeight->count(k)) {
-                entry->SetWeight((*m_pCCWeight)[k]);
+            WeightTable_t::const_iterator weightIter = m_pCCWeight->find(k);
+            if(weightIter != m_pCCWeight->end()) {
+                entry->SetWeight(weightIter->second);
                 importantEntries.push_back(entry);
             } else {
                 normalEntries.push_back(entry);
@@ -152,10 +151,10 @@ void SmartCompletion::OnGotoAnythingSort(clGotoEvent& event)
     clGotoEntry::Vec_t normalEntries;
     clGotoEntry::Vec_t::iterator iter = entries.begin();
     std::for_each(entries.begin(), entries.end(), [&](const clGotoEntry& entry) {
-        if(T.count(entry.GetDesc())) {
+        WeightTable_t::const_iterator weightIter = T.find(entry.GetDesc());
+        if(weightIter != T.end()) {
             // This item has weight
-            int weight = T[entry.GetDesc()];
-            importantEntries.push_back({ weight, entry });
+            importantEntries.push_back({ weightIter->second, entry });
         } else {
             normalEntries.push_back(entry);
         }
@@ -183,10 +182,8 @@ void SmartCompletion::OnGotoAnythingSelectionMade(clGotoEvent& event)
     WeightTable_t& T = *m_pGTAWeight;
 
     const wxString& key = event.GetEntry().GetDesc();
-    if(T.count(key) == 0) {
-        T[key] = 1;
-    } else {
-        T[key]++;
-    }
-    m_config.GetUsageDb().StoreGTAUsage(key, T[key]);
+    int& weight = T[key];
+    ++weight;
+    // Written to the database in the background
+    m_config.GetUsageDb().StoreGTAUsage(key, weight);
 }
@@ -10,6 +10,7 @@ public:
     wxFileName filename;
     size_t lastPos;
     wxString displayedText;
+    wxString filter;
 
 public:
     TailData()
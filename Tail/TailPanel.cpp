@@ -9,12 +9,15 @@
 #include "lexer_configuration.h"
 #include "tail.h"
 #include <imanager.h>
-#include <wx/ffile.h>
 #include <wx/filedlg.h>
+#include <wx/regex.h>
+#include <wx/textdlg.h>
 #include "clThemeUpdater.h"
 
 TailPanel::TailPanel(wxWindow* parent, Tail* plugin)
     : TailPanelBase(parent)
+    , m_reader(NULL)
+    , m_readerId(0)
     , m_lastPos(0)
     , m_plugin(plugin)
     , m_isDetached(false)
@@ -23,10 +26,11 @@ TailPanel::TailPanel(wxWindow* parent, Tail* plugin)
     clThemeUpdater::Get().RegisterWindow(this);
     clThemeUpdater::Get().RegisterWindow(m_staticTextFileName);
     
+    // Maximum number of lines kept in the view, older lines are removed
+    m_maxLines = clConfig::Get().Read("tail/max_lines", 10000);
+    if(m_maxLines <= 0) { m_maxLines = 10000; }
+
     DoBuildToolbar();
-    m_fileWatcher.reset(new clFileSystemWatcher());
-    m_fileWatcher->SetOwner(this);
-    Bind(wxEVT_FILE_MODIFIED, &TailPanel::OnFileModified, this);
 
     wxCommandEvent dummy;
     OnThemeChanged(dummy);
@@ -37,22 +41,36 @@ TailPanel::~TailPanel()
 {
     clThemeUpdater::Get().UnRegisterWindow(this);
     clThemeUpdater::Get().UnRegisterWindow(m_staticTextFileName);
-    Unbind(wxEVT_FILE_MODIFIED, &TailPanel::OnFileModified, this);
+    DoStopReader();
     EventNotifier::Get()->Unbind(wxEVT_CL_THEME_CHANGED, &TailPanel::OnThemeChanged, this);
 }
 
-void TailPanel::OnPause(wxCommandEvent& event) { m_fileWatcher->Stop(); }
+void TailPanel::OnPause(wxCommandEvent& event) { DoStopReader(); }
+
+void TailPanel::OnPauseUI(wxUpdateUIEvent& event) { event.Enable(m_file.IsOk() && m_reader); }
 
-void TailPanel::OnPauseUI(wxUpdateUIEvent& event) { event.Enable(m_file.IsOk() && m_fileWatcher->IsRunning()); }
+void TailPanel::OnPlay(wxCommandEvent& event) { DoStartReader(); }
 
-void TailPanel::OnPlay(wxCommandEvent& event) { m_fileWatcher->Start(); }
+void TailPanel::OnPlayUI(wxUpdateUIEvent& event) { event.Enable(m_file.IsOk() && !m_reader); }
+
+void TailPanel::DoStartReader()
+{
+    DoStopReader();
+    // Chunks posted by a previous reader are ignored
+    ++m_readerId;
+    m_reader = new TailReaderThread(this, m_readerId, m_file, m_lastPos, m_filter);
+    m_reader->Start();
+}
 
-void TailPanel::OnPlayUI(wxUpdateUIEvent& event) { event.Enable(m_file.IsOk() && !m_fileWatcher->IsRunning()); }
+void TailPanel::DoStopReader()
+{
+    // Deleting the reader waits for the thread to exit
+    wxDELETE(m_reader);
+}
 
 void TailPanel::DoClear()
 {
-    m_fileWatcher->Stop();
-    m_fileWatcher->Clear();
+    DoStopReader();
 
     m_file.Clear();
     m_stc->SetReadOnly(false);
@@ -65,33 +83,29 @@ void TailPanel::DoClear()
     Layout();
 }
 
-void TailPanel::OnFileModified(clFileSystemEvent& event)
+void TailPanel::OnReaderChunk(const TailReaderChunk& chunk)
 {
-    wxFileName fn(event.GetPath());
-    // Get the current file size
-    size_t cursize = FileUtils::GetFileSize(m_file);
-    wxFFile fp(m_file.GetFullPath(), "rb");
-    if(fp.IsOpened() && fp.Seek(m_lastPos)) {
-        if(cursize > m_lastPos) {
-            size_t bufferSize = cursize - m_lastPos;
-            char* buffer = new char[bufferSize + 1];
-            if(fp.Read(buffer, bufferSize) == bufferSize) {
-                buffer[bufferSize] = '\0';
-                wxString content((const char*)buffer, wxConvUTF8);
-                DoAppendText(content);
-            }
-            wxDELETEA(buffer);
-        } else {
-            DoAppendText(_("\n>>> File truncated <<<\n"));
-        }
-        m_lastPos = cursize;
+    if(!m_reader || chunk.readerId != m_readerId) { return; }
+    m_lastPos = chunk.lastPos;
+
+    wxString content;
+    if(chunk.truncated) { content << _("\n>>> File truncated <<<\n"); }
+    if(chunk.skippedBytes) {
+        content << wxString::Format(_("\n>>> Skipped %s bytes <<<\n"), wxLongLong(chunk.skippedBytes).ToString());
     }
+    for(size_t i = 0; i < chunk.lines.size(); ++i) {
+        content << chunk.lines.Item(i) << "\n";
+    }
+    DoAppendText(content);
 }
 
 void TailPanel::DoAppendText(const wxString& text)
 {
     m_stc->SetReadOnly(false);
     m_stc->AppendText(text);
+    // Keep the view bounded
+    int extraLines = m_stc->GetLineCount() - m_maxLines;
+    if(extraLines > 0) { m_stc->DeleteRange(0, m_stc->PositionFromLine(extraLines)); }
     m_stc->SetReadOnly(true);
     m_stc->SetSelectionEnd(m_stc->GetLength());
     m_stc->SetSelectionStart(m_stc->GetLength());
@@ -121,6 +135,24 @@ void TailPanel::OnClose(wxCommandEvent& event) { DoClear(); }
 
 void TailPanel::OnCloseUI(wxUpdateUIEvent& event) { event.Enable(m_file.IsOk()); }
 
+void TailPanel::OnFilter(wxCommandEvent& event)
+{
+    wxTextEntryDialog dlg(this, _("Only display lines matching this regular expression (leave empty to display all "
+                                  "lines):"),
+                          _("Filter"), m_filter);
+    if(dlg.ShowModal() != wxID_OK) { return; }
+
+    wxString filter = dlg.GetValue();
+    if(!filter.IsEmpty() && !wxRegEx(filter, wxRE_ADVANCED).IsValid()) {
+        ::wxMessageBox(_("Invalid regular expression"), "CodeLite", wxICON_WARNING | wxOK | wxCENTER, this);
+        return;
+    }
+    m_filter = filter;
+    if(m_reader) { m_reader->SetFilter(m_filter); }
+}
+
+void TailPanel::OnFilterUI(wxUpdateUIEvent& event) { event.Check(!m_filter.IsEmpty()); }
+
 void TailPanel::OnOpen(wxCommandEvent& event)
 {
     wxString filepath = ::wxFileSelector();
@@ -150,9 +182,7 @@ void TailPanel::DoOpen(const wxString& filename)
         clConfig::Get().Write("tail", recentItems);
     }
 
-    // Stop the current watcher
-    m_fileWatcher->SetFile(m_file);
-    m_fileWatcher->Start();
+    DoStartReader();
     m_staticTextFileName->SetLabel(m_file.GetFullPath());
     SetFrameTitle();
 
@@ -196,7 +226,10 @@ void TailPanel::Initialize(const TailData& tailData)
     if(tailData.filename.IsOk() && tailData.filename.Exists()) {
         DoOpen(tailData.filename.GetFullPath());
         DoAppendText(tailData.displayedText);
+        // Continue from where the source panel stopped
+        m_filter = tailData.filter;
         m_lastPos = tailData.lastPos;
+        DoStartReader();
         SetFrameTitle();
     }
 }
@@ -207,6 +240,7 @@ TailData TailPanel::GetTailData() const
     dt.displayedText = m_stc->GetText();
     dt.filename = m_file;
     dt.lastPos = m_lastPos;
+    dt.filter = m_filter;
     return dt;
 }
 
@@ -236,6 +270,8 @@ void TailPanel::DoBuildToolbar()
                        wxITEM_DROPDOWN);
     m_toolbar->AddTool(XRCID("tail_close"), _("Close file"), clGetManager()->GetStdIcons()->LoadBitmap("file_close"));
     m_toolbar->AddTool(XRCID("tail_clear"), _("Clear"), clGetManager()->GetStdIcons()->LoadBitmap("clear"));
+    m_toolbar->AddTool(XRCID("tail_filter"), _("Filter lines"), clGetManager()->GetStdIcons()->LoadBitmap("find"), "",
+                       wxITEM_CHECK);
     m_toolbar->AddSeparator();
     m_toolbar->AddTool(XRCID("tail_pause"), _("Pause"), clGetManager()->GetStdIcons()->LoadBitmap("interrupt"));
     m_toolbar->AddTool(XRCID("tail_play"), _("Play"), clGetManager()->GetStdIcons()->LoadBitmap("debugger_start"));
@@ -247,12 +283,14 @@ void TailPanel::DoBuildToolbar()
     m_toolbar->Bind(wxEVT_TOOL_DROPDOWN, &TailPanel::OnOpenMenu, this, XRCID("tail_open"));
     m_toolbar->Bind(wxEVT_TOOL, &TailPanel::OnClose, this, XRCID("tail_close"));
     m_toolbar->Bind(wxEVT_TOOL, &TailPanel::OnClear, this, XRCID("tail_clear"));
+    m_toolbar->Bind(wxEVT_TOOL, &TailPanel::OnFilter, this, XRCID("tail_filter"));
     m_toolbar->Bind(wxEVT_TOOL, &TailPanel::OnPause, this, XRCID("tail_pause"));
     m_toolbar->Bind(wxEVT_TOOL, &TailPanel::OnPlay, this, XRCID("tail_play"));
     m_toolbar->Bind(wxEVT_TOOL, &TailPanel::OnDetachWindow, this, XRCID("tail_detach"));
 
     m_toolbar->Bind(wxEVT_UPDATE_UI, &TailPanel::OnCloseUI, this, XRCID("tail_close"));
     m_toolbar->Bind(wxEVT_UPDATE_UI, &TailPanel::OnClearUI, this, XRCID("tail_clear"));
+    m_toolbar->Bind(wxEVT_UPDATE_UI, &TailPanel::OnFilterUI, this, XRCID("tail_filter"));
     m_toolbar->Bind(wxEVT_UPDATE_UI, &TailPanel::OnPauseUI, this, XRCID("tail_pause"));
     m_toolbar->Bind(wxEVT_UPDATE_UI, &TailPanel::OnPlayUI, this, XRCID("tail_play"));
     m_toolbar->Bind(wxEVT_UPDATE_UI, &TailPanel::OnDetachWindowUI, this, XRCID("tail_detach"));
@@ -2,10 +2,9 @@
 #define TAILPANEL_H
 
 #include "TailData.h"
+#include "TailReaderThread.h"
 #include "TailUI.h"
 #include "clEditorEditEventsHandler.h"
-#include "clFileSystemEvent.h"
-#include "clFileSystemWatcher.h"
 #include <map>
 #include <vector>
 #include <wx/filename.h>
@@ -15,9 +14,12 @@ class clToolBar;
 class Tail;
 class TailPanel : public TailPanelBase
 {
-    clFileSystemWatcher::Ptr_t m_fileWatcher;
+    TailReaderThread* m_reader;
+    size_t m_readerId;
     wxFileName m_file;
     size_t m_lastPos;
+    wxString m_filter;
+    int m_maxLines;
     clEditEventsHandler::Ptr_t m_editEvents;
     std::map<int, wxString> m_recentItemsMap;
     Tail* m_plugin;
@@ -34,6 +36,8 @@ protected:
     virtual void OnClearUI(wxUpdateUIEvent& event);
     virtual void OnClose(wxCommandEvent& event);
     virtual void OnCloseUI(wxUpdateUIEvent& event);
+    void OnFilter(wxCommandEvent& event);
+    void OnFilterUI(wxUpdateUIEvent& event);
     void OnOpenRecentItem(wxCommandEvent& event);
 
 private:
@@ -41,6 +45,8 @@ private:
     void DoClear();
     void DoOpen(const wxString& filename);
     void DoAppendText(const wxString& text);
+    void DoStartReader();
+    void DoStopReader();
     void DoPrepareRecentItemsMenu(wxMenu& menu);
     wxString GetTailTitle() const;
 
@@ -68,7 +74,7 @@ public:
     /**
      * @brief is this panel watching a file?
      */
-    bool IsOpen() const { return m_fileWatcher && m_fileWatcher->IsRunning(); }
+    bool IsOpen() const { return m_reader != NULL; }
 
     /**
      * @brief return the currently watched file name
@@ -80,7 +86,12 @@ protected:
     virtual void OnPauseUI(wxUpdateUIEvent& event);
     virtual void OnPlay(wxCommandEvent& event);
     virtual void OnPlayUI(wxUpdateUIEvent& event);
-    void OnFileModified(clFileSystemEvent& event);
     void OnThemeChanged(wxCommandEvent& event);
+
+public:
+    /**
+     * @brief called by the reader thread with new lines
+     */
+    void OnReaderChunk(const TailReaderChunk& chunk);
 };
 #endif // TAILPANEL_H
@@ -0,0 +1,204 @@
+#include "TailReaderThread.h"
+#include "TailPanel.h"
+#include "file_logger.h"
+#include <vector>
+#include <wx/ffile.h>
+#include <wx/regex.h>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// Size of a single read from the file
+#define TAIL_READ_CHUNK_SIZE (1024 * 1024)
+// When not filtering, never read more than this amount of backlog: the view can not display it anyway
+#define TAIL_MAX_BACKLOG (4 * 1024 * 1024)
+// How long to wait for changes before checking the file again (and checking for TestDestroy)
+#define TAIL_WAIT_MS 250
+
+TailReaderThread::TailReaderThread(TailPanel* owner, size_t readerId, const wxFileName& file, wxFileOffset lastPos,
+                                   const wxString& filter)
+    : m_owner(owner)
+    , m_readerId(readerId)
+    , m_file(file)
+    , m_lastPos(lastPos)
+    , m_fileReplaced(false)
+    , m_filter(filter)
+    , m_filterChanged(true)
+#ifdef __linux__
+    , m_inotifyFd(-1)
+    , m_watchFd(-1)
+#endif
+{
+}
+
+TailReaderThread::~TailReaderThread()
+{
+    // Make sure that the thread is no longer using our members
+    Stop();
+}
+
+void TailReaderThread::SetFilter(const wxString& filter)
+{
+    wxMutexLocker locker(m_filterLock);
+    m_filter = filter;
+    m_filterChanged = true;
+}
+
+void* TailReaderThread::Entry()
+{
+#ifdef __linux__
+    m_inotifyFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(m_inotifyFd < 0) { clWARNING() << "Tail: inotify is not available, falling back to polling" << clEndl; }
+#endif
+
+    wxRegEx re;
+    bool hasFilter = false;
+    while(!TestDestroy()) {
+        {
+            wxMutexLocker locker(m_filterLock);
+            if(m_filterChanged) {
+                m_filterChanged = false;
+                hasFilter = !m_filter.IsEmpty() && re.Compile(m_filter, wxRE_ADVANCED);
+            }
+        }
+        DoReadChanges(hasFilter ? &re : NULL);
+        DoWaitForChanges();
+    }
+
+#ifdef __linux__
+    if(m_inotifyFd >= 0) { ::close(m_inotifyFd); }
+    m_inotifyFd = -1;
+    m_watchFd = -1;
+#endif
+    return NULL;
+}
+
+void TailReaderThread::DoWaitForChanges()
+{
+#ifdef __linux__
+    if(m_inotifyFd >= 0) {
+        if(m_watchFd < 0) {
+            // (Re)install the watch. The file might have been rotated or deleted
+            m_watchFd = ::inotify_add_watch(m_inotifyFd, m_file.GetFullPath().mb_str(wxConvUTF8).data(),
+                                            IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF);
+        }
+        if(m_watchFd >= 0) {
+            struct pollfd pfd;
+            pfd.fd = m_inotifyFd;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            if(::poll(&pfd, 1, TAIL_WAIT_MS) > 0) {
+                // Drain the events, we only care about the fact that something happened
+                char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+                ssize_t len = 0;
+                while((len = ::read(m_inotifyFd, buffer, sizeof(buffer))) > 0) {
+                    for(char* ptr = buffer; ptr < buffer + len;) {
+                        const struct inotify_event* event = (const struct inotify_event*)ptr;
+                        if(event->mask & (IN_MOVE_SELF | IN_DELETE_SELF | IN_IGNORED)) {
+                            ::inotify_rm_watch(m_inotifyFd, m_watchFd);
+                            m_watchFd = -1;
+                        }
+                        if(event->mask & (IN_MOVE_SELF | IN_DELETE_SELF)) {
+                            // The file was rotated or deleted: whatever we find at this path from now on is a
+                            // new file (which may be larger than the old one), so read it from the start
+                            m_fileReplaced = true;
+                        }
+                        ptr += sizeof(struct inotify_event) + event->len;
+                    }
+                }
+            }
+            return;
+        }
+    }
+#endif
+    wxThread::Sleep(TAIL_WAIT_MS);
+}
+
+void TailReaderThread::DoReadChanges(wxRegEx* filter)
+{
+    wxULongLong size = m_file.GetSize();
+    if(size == wxInvalidSize) { return; }
+    wxFileOffset fileSize = (wxFileOffset)size.GetValue();
+
+    TailReaderChunk chunk;
+    chunk.readerId = m_readerId;
+    if(fileSize < m_lastPos || m_fileReplaced) {
+        // The file was truncated (or replaced), start over
+        chunk.truncated = true;
+        m_fileReplaced = false;
+        m_lastPos = 0;
+        m_partialLine.clear();
+    }
+
+    bool dropFirstLine = false;
+    if(!filter && (fileSize - m_lastPos) > TAIL_MAX_BACKLOG) {
+        chunk.skippedBytes = fileSize - TAIL_MAX_BACKLOG - m_lastPos;
+        m_lastPos = fileSize - TAIL_MAX_BACKLOG;
+        m_partialLine.clear();
+        // we are probably in the middle of a line
+        dropFirstLine = true;
+    }
+
+    if(m_lastPos < fileSize) {
+        wxFFile fp(m_file.GetFullPath(), "rb");
+        if(fp.IsOpened() && fp.Seek(m_lastPos)) {
+            std::vector<char> buffer(TAIL_READ_CHUNK_SIZE);
+            while(m_lastPos < fileSize && !TestDestroy()) {
+                size_t count = (size_t)wxMin((wxFileOffset)buffer.size(), fileSize - m_lastPos);
+                size_t bytes = fp.Read(buffer.data(), count);
+                if(bytes == 0) { break; }
+                m_lastPos += bytes;
+
+                // Split into lines, keeping the last incomplete line for the next read
+                const char* start = buffer.data();
+                const char* end = start + bytes;
+                while(start < end) {
+                    const char* eol = (const char*)memchr(start, '\n', end - start);
+                    if(!eol) {
+                        m_partialLine.append(start, end - start);
+                        break;
+                    }
+                    m_partialLine.append(start, eol - start);
+                    start = eol + 1;
+                    if(dropFirstLine) {
+                        dropFirstLine = false;
+                    } else {
+                        DoAddLine(chunk, filter);
+                    }
+                    m_partialLine.clear();
+                }
+                // Pass each chunk as soon as it is ready so we never hold more than a chunk in memory
+                DoPostChunk(chunk);
+            }
+        }
+    }
+    DoPostChunk(chunk);
+}
+
+void TailReaderThread::DoAddLine(TailReaderChunk& chunk, wxRegEx* filter)
+{
+    size_t len = m_partialLine.length();
+    if(len && m_partialLine[len - 1] == '\r') { --len; }
+
+    wxString line = wxString::FromUTF8(m_partialLine.c_str(), len);
+    if(line.IsEmpty() && len) {
+        // Not a valid UTF-8 string
+        line = wxString::From8BitData(m_partialLine.c_str(), len);
+    }
+    if(filter && !filter->Matches(line)) { return; }
+    chunk.lines.Add(line);
+}
+
+void TailReaderThread::DoPostChunk(TailReaderChunk& chunk)
+{
+    if(chunk.lines.IsEmpty() && !chunk.truncated && !chunk.skippedBytes) { return; }
+    // Report the position of the first byte that was not consumed yet
+    chunk.lastPos = m_lastPos - (wxFileOffset)m_partialLine.length();
+    m_owner->CallAfter(&TailPanel::OnReaderChunk, chunk);
+
+    chunk = TailReaderChunk();
+    chunk.readerId = m_readerId;
+}
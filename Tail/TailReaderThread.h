@@ -0,0 +1,67 @@
+#ifndef TAILREADERTHREAD_H
+#define TAILREADERTHREAD_H
+
+#include "clJoinableThread.h"
+#include <string>
+#include <wx/arrstr.h>
+#include <wx/filename.h>
+#include <wx/thread.h>
+
+class TailPanel;
+class wxRegEx;
+
+/**
+ * @brief a batch of new lines read from the tailed file
+ */
+struct TailReaderChunk {
+    size_t readerId = 0;
+    wxArrayString lines;
+    wxFileOffset lastPos = 0;
+    bool truncated = false;
+    wxFileOffset skippedBytes = 0;
+};
+
+/**
+ * @class TailReaderThread
+ * @brief wait for the tailed file to grow (inotify on Linux, polling elsewhere), read the new content
+ * in fixed size chunks, apply the filter and pass only complete, matching lines to the panel
+ */
+class TailReaderThread : public clJoinableThread
+{
+    TailPanel* m_owner;
+    size_t m_readerId;
+    wxFileName m_file;
+    wxFileOffset m_lastPos;
+    std::string m_partialLine;
+    bool m_fileReplaced;
+
+    wxMutex m_filterLock;
+    wxString m_filter;
+    bool m_filterChanged;
+
+#ifdef __linux__
+    int m_inotifyFd;
+    int m_watchFd;
+#endif
+
+protected:
+    void DoWaitForChanges();
+    void DoReadChanges(wxRegEx* filter);
+    void DoAddLine(TailReaderChunk& chunk, wxRegEx* filter);
+    void DoPostChunk(TailReaderChunk& chunk);
+
+public:
+    TailReaderThread(TailPanel* owner, size_t readerId, const wxFileName& file, wxFileOffset lastPos,
+                     const wxString& filter);
+    virtual ~TailReaderThread();
+
+    /**
+     * @brief set the regular expression that lines must match to be displayed. An empty string disables filtering.
+     * Applies to lines read from now on
+     */
+    void SetFilter(const wxString& filter);
+
+    virtual void* Entry();
+};
+
+#endif // TAILREADERTHREAD_H
@@ -201,10 +201,7 @@ void ZoomNavigator::SetEditorText(IEditor* editor)
 {
     m_curfile.Clear();
     m_text->UpdateText(editor);
-    if(editor) {
-        m_curfile = editor->GetFileName().GetFullPath();
-        m_text->UpdateLexer(editor);
-    }
+    if(editor) { m_curfile = editor->GetFileName().GetFullPath(); }
 }
 
 void ZoomNavigator::SetZoomTextScrollPosToMiddle(wxStyledTextCtrl* stc)
@@ -220,7 +217,6 @@ void ZoomNavigator::SetZoomTextScrollPosToMiddle(wxStyledTextCtrl* stc)
     if(first < 0) first = 0;
 
     m_text->SetFirstVisibleLine(first);
-    m_text->ClearSelections();
 }
 
 void ZoomNavigator::PatchUpHighlights(const int first, const int last)
@@ -266,7 +262,6 @@ void ZoomNavigator::DoCleanup()
     SetEditorText(NULL);
     m_markerFirstLine = wxNOT_FOUND;
     m_markerLastLine = wxNOT_FOUND;
-    m_text->UpdateLexer(NULL);
 }
 
 void ZoomNavigator::OnSettings(wxCommandEvent& e)
@@ -328,7 +323,6 @@ void ZoomNavigator::OnInitDone(wxCommandEvent& e)
 {
     e.Skip();
     m_startupCompleted = true;
-    m_text->Startup();
 }
 
 void ZoomNavigator::OnIdle(wxIdleEvent& e)
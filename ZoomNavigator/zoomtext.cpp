@@ -48,6 +48,7 @@
 
 ZoomText::ZoomText(wxWindow* parent, wxWindowID id, const wxPoint& pos, const wxSize& size, long style,
                    const wxString& name)
+    : m_sharedDoc(NULL)
 {
     Hide();
     if(!wxStyledTextCtrl::Create(parent, id, pos, size, style | wxNO_BORDER, name)) {
@@ -63,10 +64,11 @@ ZoomText::ZoomText(wxWindow* parent, wxWindowID id, const wxPoint& pos, const wx
     clConfig conf("zoom-navigator.conf");
     conf.ReadItem(&data);
 
-    SetEditable(false);
     SetUseHorizontalScrollBar(false);
     SetUseVerticalScrollBar(data.IsUseScrollbar());
-    HideSelection(true);
+    SetCaretWidth(0);
+    UsePopUp(false);
+    SetDropTarget(NULL);
 
     SetMarginWidth(1, 0);
     SetMarginWidth(2, 0);
@@ -74,22 +76,24 @@ ZoomText::ZoomText(wxWindow* parent, wxWindowID id, const wxPoint& pos, const wx
 
     m_zoomFactor = data.GetZoomFactor();
     m_colour = data.GetHighlightColour();
-    MarkerSetBackground(1, m_colour);
     SetZoom(m_zoomFactor);
     EventNotifier::Get()->Connect(wxEVT_ZN_SETTINGS_UPDATED, wxCommandEventHandler(ZoomText::OnSettingsChanged), NULL,
                                   this);
     EventNotifier::Get()->Connect(wxEVT_CL_THEME_CHANGED, wxCommandEventHandler(ZoomText::OnThemeChanged), NULL, this);
-    MarkerDefine(1, wxSTC_MARK_BACKGROUND, m_colour, m_colour);
+
+    // The document is shared with the editor: read-only is a document property, so instead of
+    // marking it as read-only (which would affect the editor as well) we simply drop any editing input
+    Bind(wxEVT_KEY_DOWN, &ZoomText::OnBlockEdit, this);
+    Bind(wxEVT_CHAR, &ZoomText::OnBlockEdit, this);
+    Bind(wxEVT_MIDDLE_DOWN, &ZoomText::OnBlockEdit, this);
 
 #ifndef __WXMSW__
     SetTwoPhaseDraw(false);
     SetBufferedDraw(false);
-    SetLayoutCache(wxSTC_CACHE_DOCUMENT);
 #endif
-    MarkerSetAlpha(1, 10);
-
-    m_timer = new wxTimer(this);
-    Bind(wxEVT_TIMER, &ZoomText::OnTimer, this, m_timer->GetId());
+    // Only layout what is visible, the document can be huge
+    SetLayoutCache(wxSTC_CACHE_PAGE);
+    DoSetHighlightColour();
     Show();
 }
 
@@ -99,12 +103,9 @@ ZoomText::~ZoomText()
                                      NULL, this);
     EventNotifier::Get()->Disconnect(wxEVT_CL_THEME_CHANGED, wxCommandEventHandler(ZoomText::OnThemeChanged), NULL,
                                      this);
-    Unbind(wxEVT_TIMER, &ZoomText::OnTimer, this, m_timer->GetId());
-
-    if(m_timer->IsRunning()) {
-        m_timer->Stop();
-    }
-    wxDELETE(m_timer);
+    Unbind(wxEVT_KEY_DOWN, &ZoomText::OnBlockEdit, this);
+    Unbind(wxEVT_CHAR, &ZoomText::OnBlockEdit, this);
+    Unbind(wxEVT_MIDDLE_DOWN, &ZoomText::OnBlockEdit, this);
 }
 
 void ZoomText::UpdateLexer(IEditor* editor)
@@ -117,29 +118,43 @@ void ZoomText::UpdateLexer(IEditor* editor)
         return;
     }
 
+    // Re-attach to the editor document, this also re-applies the lexer
+    DoClear();
+    UpdateText(editor);
+}
+
+void ZoomText::DoApplyLexer(IEditor* editor)
+{
+    // This must be called while we are NOT sharing the editor document: the lexer
+    // is a document property and applying it to the shared document would reset
+    // the editor's own lexer state. The styles (colours and fonts) are kept by the view
+    wxASSERT(m_sharedDoc == NULL);
+
     znConfigItem data;
     clConfig conf("zoom-navigator.conf");
     conf.ReadItem(&data);
 
-    m_filename = editor->GetFileName().GetFullPath();
-    LexerConf::Ptr_t lexer = EditorConfigST::Get()->GetLexerForFile(m_filename);
+    LexerConf::Ptr_t lexer = EditorConfigST::Get()->GetLexerForFile(editor->GetFileName().GetFullPath());
     if(!lexer) {
         lexer = EditorConfigST::Get()->GetLexer("Text");
     }
     lexer->Apply(this, true);
 
-    if(lexer->IsDark()) {
-        MarkerSetAlpha(1, 10);
-    } else {
-        MarkerSetAlpha(1, 20);
-    }
-
     SetZoom(m_zoomFactor);
-    SetEditable(false);
     SetUseHorizontalScrollBar(false);
     SetUseVerticalScrollBar(data.IsUseScrollbar());
-    HideSelection(true);
-    MarkerSetBackground(1, m_colour);
+    SetCaretWidth(0);
+    DoSetHighlightColour();
+    SetSelAlpha(lexer->IsDark() ? 30 : 60);
+}
+
+void ZoomText::DoSetHighlightColour()
+{
+    // The highlighted lines are displayed using the selection of this view:
+    // unlike markers or indicators, the selection is not stored in the (shared) document
+    HideSelection(false);
+    SetSelBackground(true, m_colour);
+    SetSelEOLFilled(true);
 }
 
 void ZoomText::OnSettingsChanged(wxCommandEvent& e)
@@ -150,23 +165,32 @@ void ZoomText::OnSettingsChanged(wxCommandEvent& e)
     if(conf.ReadItem(&data)) {
         m_zoomFactor = data.GetZoomFactor();
         m_colour = data.GetHighlightColour();
-        MarkerSetBackground(1, m_colour);
+        DoSetHighlightColour();
         SetZoom(m_zoomFactor);
-        Colourise(0, wxSTC_INVALID_POSITION);
     }
 }
 
 void ZoomText::UpdateText(IEditor* editor)
 {
-    if(!editor) {
+    if(!editor || !editor->GetCtrl()) {
         DoClear();
+        return;
+    }
 
-    } else {
-        SetReadOnly(false);
-        SetText(editor->GetEditorText());
-        SetReadOnly(true);
-        SetCurrentPos(editor->GetCurrentPosition());
+    void* doc = editor->GetCtrl()->GetDocPointer();
+    if(doc == m_sharedDoc) {
+        // Already showing this document
+        return;
     }
+
+    // Switch to our own document before applying the lexer, then attach to the editor's one
+    DoClear();
+    DoApplyLexer(editor);
+
+    // SetDocPointer() increases the document reference count (and decreases it once we switch
+    // to another document) so the document stays valid even if the editor is closed meanwhile
+    SetDocPointer(doc);
+    m_sharedDoc = doc;
 }
 
 void ZoomText::HighlightLines(int start, int end)
@@ -179,10 +203,9 @@ void ZoomText::HighlightLines(int start, int end)
         if(start < 0) start = 0;
     }
 
-    MarkerDeleteAll(1);
-    for(int i = start; i <= end; ++i) {
-        MarkerAdd(i, 1);
-    }
+    // Use SetAnchor/SetCurrentPos and not SetSelection() which would also scroll the view
+    SetAnchor(PositionFromLine(start));
+    SetCurrentPos(GetLineEndPosition(end));
 }
 
 void ZoomText::OnThemeChanged(wxCommandEvent& e)
@@ -191,37 +214,18 @@ void ZoomText::OnThemeChanged(wxCommandEvent& e)
     UpdateLexer(NULL);
 }
 
-void ZoomText::OnTimer(wxTimerEvent& event)
+void ZoomText::OnBlockEdit(wxEvent& event)
 {
-    // sanity
-    if(!m_classes.IsEmpty() || IsEmpty()) {
-        m_timer->Start(1000, true);
-        return;
-    }
-
-    IEditor* editor = clGetManager()->GetActiveEditor();
-    if(!editor) {
-        m_timer->Start(1000, true);
-        return;
-    }
-
-    if(m_classes.IsEmpty() && !editor->GetKeywordClasses().IsEmpty() &&
-       (editor->GetFileName().GetFullPath() == m_filename)) {
-        // Sync between the keywords
-        SetKeyWords(1, editor->GetKeywordClasses()); // classes
-        SetKeyWords(3, editor->GetKeywordLocals());  // locals
-        Colourise(0, GetLength());
-    }
-    m_timer->Start(1000, true);
+    // Swallow the event
+    wxUnusedVar(event);
 }
 
 void ZoomText::DoClear()
 {
-    m_classes.clear();
-    m_locals.clear();
-    SetReadOnly(false);
-    SetText("");
-    SetReadOnly(true);
+    // Detach from the editor document. Passing NULL creates a new, empty, document for this view
+    // NB: never call SetText() here, as the document might be the editor's one
+    if(m_sharedDoc) {
+        SetDocPointer(NULL);
+        m_sharedDoc = NULL;
+    }
 }
-
-void ZoomText::Startup() { m_timer->Start(1000, true); }
@@ -40,16 +40,16 @@ class ZoomText : public wxStyledTextCtrl
 {
     int m_zoomFactor;
     wxColour m_colour;
-    wxString m_filename;
-    wxString m_classes;
-    wxString m_locals;
-    wxTimer* m_timer;
-    
+    // The editor document we are currently sharing (NULL when showing our own, empty, document)
+    void* m_sharedDoc;
+
 protected:
     void OnThemeChanged(wxCommandEvent& e);
-    void OnTimer(wxTimerEvent& event);
+    void OnBlockEdit(wxEvent& event);
     void DoClear();
-    
+    void DoApplyLexer(IEditor* editor);
+    void DoSetHighlightColour();
+
 public:
     ZoomText(wxWindow* parent,
              wxWindowID id = wxID_ANY,
@@ -60,10 +60,12 @@ public:
     virtual ~ZoomText();
     void UpdateLexer(IEditor* editor);
     void OnSettingsChanged(wxCommandEvent& e);
+    /**
+     * @brief display the editor content. The view shares the editor's Scintilla document,
+     * so no text is copied and the styling done by the editor is reused as-is
+     */
     void UpdateText(IEditor* editor);
     void HighlightLines(int start, int end);
-    
-    void Startup();
 };
 
 #endif // ZOOM_NAV_TEXT
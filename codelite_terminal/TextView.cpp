@@ -1,6 +1,7 @@
 #include "TextView.h"
 #include <wx/sizer.h>
 #include "wxTerminalOptions.h"
+#include <algorithm>
 #include <wx/wupdlock.h>
 
 TextView::TextView(wxWindow* parent, wxWindowID winid)
@@ -167,29 +168,6 @@ void TextView::SetCaretEnd()
 #endif
 }
 
-int TextView::Truncate()
-{
-    if(GetNumberOfLines() > 1000) {
-        // Start removing lines from the top
-        long linesToRemove = (GetNumberOfLines() - 1000);
-        long startPos = 0;
-        long endPos = XYToPosition(0, linesToRemove);
-        this->Remove(startPos, endPos);
-        return endPos - startPos;
-    }
-    return 0;
-}
-
-wxChar TextView::GetLastChar() const
-{
-#if USE_STC
-    return m_ctrl->GetCharAt(m_ctrl->GetLastPosition());
-#else
-    wxString text = m_ctrl->GetRange(m_ctrl->GetLastPosition() - 1, m_ctrl->GetLastPosition());
-    return text[0];
-#endif
-}
-
 int TextView::GetCurrentStyle()
 {
 #if USE_STC
@@ -213,15 +191,49 @@ int TextView::GetCurrentStyle()
 #endif
 }
 
-void TextView::Clear()
+void TextView::Clear() { m_colourHandler.GetScreen().ClearScrollback(); }
+
+bool TextView::Render()
 {
-#if USE_STC
-    m_ctrl->ClearAll();
-    m_ctrl->ClearDocumentStyle();
-#if wxCHECK_VERSION(3, 1, 1)
-    m_ctrl->StartStyling(0);
-#else
-    m_ctrl->StartStyling(0, 0x1f);
-#endif
-#endif
+    wxTerminalScreenBuffer& screen = m_colourHandler.GetScreen();
+    if(!screen.IsDirty()) { return false; }
+
+    // The control lines [0, m_renderedLines) display the screen lines starting from m_renderedFirstLine
+    size_t firstLine = screen.GetFirstLine();
+    size_t firstDirtyLine = std::max(screen.GetFirstDirtyLine(), firstLine);
+    size_t renderedEnd = m_renderedFirstLine + m_renderedLines;
+
+    // Remove the modified lines (and anything that follows them) from the bottom
+    size_t keepUntil = std::min(std::max(firstDirtyLine, m_renderedFirstLine), renderedEnd);
+    long from = XYToPosition(0, keepUntil - m_renderedFirstLine);
+    if(from == wxNOT_FOUND) { from = GetLastPosition(); }
+    if(from < GetLastPosition()) { Remove(from, GetLastPosition()); }
+    m_renderedLines = keepUntil - m_renderedFirstLine;
+
+    // Remove the lines that were dropped from the buffer from the top
+    if(firstLine > m_renderedFirstLine) {
+        size_t count = std::min(firstLine - m_renderedFirstLine, m_renderedLines);
+        long to = XYToPosition(0, count);
+        if(to == wxNOT_FOUND) { to = GetLastPosition(); }
+        if(to > 0) { Remove(0, to); }
+        m_renderedFirstLine += count;
+        m_renderedLines -= count;
+    }
+    if(m_renderedLines == 0) { m_renderedFirstLine = firstDirtyLine; }
+
+    // Append the modified lines
+    SetInsertionPointEnd();
+    for(size_t line = m_renderedFirstLine + m_renderedLines; line <= screen.GetLastLine(); ++line) {
+        for(const wxTerminalScreenBuffer::Run& run : screen.GetLine(line).runs) {
+            SetDefaultStyle(run.attr);
+            AppendText(run.text);
+        }
+        if(screen.IsLineComplete(line)) { AppendText("\n"); }
+        ++m_renderedLines;
+    }
+
+    // Text typed by the user uses the current style
+    SetDefaultStyle(m_colourHandler.GetCurrentStyle());
+    screen.ClearDirty();
+    return true;
 }
@@ -27,6 +27,9 @@ class WXDLLIMPEXP_SDK TextView : public wxWindow
     wxTextAttr m_defaultAttr;
     std::unordered_map<wxString, int> m_styles;
     int m_nextStyle = 0;
+    // the screen lines currently displayed by the control: [m_renderedFirstLine, m_renderedFirstLine + m_renderedLines)
+    size_t m_renderedFirstLine = 0;
+    size_t m_renderedLines = 0;
 
 protected:
     int GetCurrentStyle();
@@ -62,8 +65,16 @@ public:
     void ShowCommandLine();
     void SetCommand(long from, const wxString& command);
     void SetCaretEnd();
-    int Truncate();
-    wxChar GetLastChar() const;
+    /**
+     * @brief update the control from the screen buffer. Only the lines modified since the
+     * last call are written, lines dropped from the buffer are removed from the top of the control.
+     * Note that anything typed after the last line is removed as well.
+     * @return true if the control was modified
+     */
+    bool Render();
+    /**
+     * @brief clear the screen, only the current line is kept. The change is visible after the next Render()
+     */
     void Clear();
 };
 
@@ -55,73 +55,47 @@ wxTerminalColourHandler::~wxTerminalColourHandler() {}
 
 void wxTerminalColourHandler::Append(const wxString& buffer)
 {
-    if(buffer == "\n") {
-        // small optimization:
-        // this is usually the case where the user simply hit ENTER after typing a command
-        // No need to do fancy stuff here
-        m_ctrl->AppendText(buffer);
-        return;
-    }
+    // Printable text is written to the screen in spans and not one char at a time
+    wxString::const_iterator spanStart = buffer.end();
+    for(wxString::const_iterator iter = buffer.begin(); iter != buffer.end(); ++iter) {
+        const wxChar ch = *iter;
+        if(m_state == eColourHandlerState::kNormal && ch != 0x1B && ch != '\r' && ch != '\n') {
+            if(spanStart == buffer.end()) { spanStart = iter; }
+            continue;
+        }
 
-    wxString curline;
-    // we start were left (at the end of the buffer)
-    long lastPos = m_ctrl->GetLastPosition();
-    if(lastPos > 0) {
-        // test the last char
-        wxChar lastCh = m_ctrl->GetLastChar();
-        if(lastCh != '\n') {
-            // we dont have a complete line here
-            // read the last line into the buffer and clear the line
-            long x, y;
-            m_ctrl->PositionToXY(lastPos, &x, &y);
-            long newpos = m_ctrl->XYToPosition(0, y);
-            curline = m_ctrl->GetRange(newpos, lastPos);
-            m_ctrl->Remove(newpos, lastPos);
-            m_ctrl->SetInsertionPoint(newpos);
+        if(spanStart != buffer.end()) {
+            m_screen.Write(wxString(spanStart, iter), m_currentAttr);
+            spanStart = buffer.end();
         }
-    }
 
-    m_ctrl->SelectNone();
-    m_ctrl->SetInsertionPointEnd();
-    for(const wxChar& ch : buffer) {
         switch(m_state) {
         case eColourHandlerState::kFoundCR: {
             switch(ch) {
             case '\r':
                 // another CR, ignore it and remain in this state
-                curline.Clear();
+                m_screen.ClearCurrentLine();
                 break;
             case '\n':
                 // Windows style CRLF
-                curline << "\n";
-                FlushBuffer(curline);
+                m_screen.NewLine();
                 m_state = eColourHandlerState::kNormal;
                 break;
             default: {
                 // only CR was found, erase everything until the the first LF found or start of string
-                curline.Clear();
-                curline << ch;
+                m_screen.ClearCurrentLine();
                 m_state = eColourHandlerState::kNormal;
+                if(ch == 0x1B) {
+                    HandleControlChar(ch);
+                } else {
+                    spanStart = iter;
+                }
                 break;
             } // default
             } // switch
         } break;
         case eColourHandlerState::kNormal:
-            switch(ch) {
-            case 0x1B: // ESC
-                m_state = eColourHandlerState::kInEscape;
-                break;
-            case '\r':
-                m_state = eColourHandlerState::kFoundCR;
-                break;
-            case '\n':
-                curline << "\n";
-                FlushBuffer(curline);
-                break;
-            default:
-                curline << ch;
-                break;
-            }
+            HandleControlChar(ch);
             break;
         case eColourHandlerState::kInEscape:
             switch(ch) {
@@ -187,7 +161,6 @@ void wxTerminalColourHandler::Append(const wxString& buffer)
                 break;
             case 'm':
                 // update the style
-                FlushBuffer(curline);
                 SetStyleFromEscape(m_escapeSequence);
                 m_state = eColourHandlerState::kNormal;
                 break;
@@ -198,16 +171,32 @@ void wxTerminalColourHandler::Append(const wxString& buffer)
         }
     }
 
-    // Write whatever left in the buffer into the control
-    FlushBuffer(curline);
-    SetCaretEnd();
+    // Write whatever left in the buffer into the screen
+    if(spanStart != buffer.end()) { m_screen.Write(wxString(spanStart, buffer.end()), m_currentAttr); }
+}
+
+void wxTerminalColourHandler::HandleControlChar(wxChar ch)
+{
+    switch(ch) {
+    case 0x1B: // ESC
+        m_state = eColourHandlerState::kInEscape;
+        break;
+    case '\r':
+        m_state = eColourHandlerState::kFoundCR;
+        break;
+    case '\n':
+        m_screen.NewLine();
+        break;
+    default:
+        break;
+    }
 }
 
 void wxTerminalColourHandler::SetStyleFromEscape(const wxString& escape)
 {
     if(escape == "0") {
         // reset to normal
-        m_ctrl->SetDefaultStyle(m_defaultAttr);
+        m_currentAttr = m_defaultAttr;
     } else {
         // see: https://en.wikipedia.org/wiki/ANSI_escape_code#SGR_(Select_Graphic_Rendition)_parameters
         wxArrayString attrs = ::wxStringTokenize(escape, ";", wxTOKEN_RET_EMPTY);
@@ -244,7 +233,7 @@ void wxTerminalColourHandler::SetStyleFromEscape(const wxString& escape)
                 break;
             }
         }
-        m_ctrl->SetDefaultStyle(textAttr);
+        m_currentAttr = textAttr;
     }
 }
 
@@ -265,18 +254,11 @@ void wxTerminalColourHandler::SetCtrl(TextView* ctrl)
     Clear();
     m_ctrl = ctrl;
     m_defaultAttr = m_ctrl->GetDefaultStyle();
+    m_currentAttr = m_defaultAttr;
 }
 
 void wxTerminalColourHandler::Clear() { m_escapeSequence.Clear(); }
 
-void wxTerminalColourHandler::FlushBuffer(wxString& line)
-{
-    if(!line.empty()) {
-        m_ctrl->AppendText(line);
-        line.clear();
-    }
-}
-
 void wxTerminalColourHandler::SetDefaultStyle(const wxTextAttr& attr)
 {
     if(m_ctrl) {
@@ -290,14 +272,8 @@ void wxTerminalColourHandler::SetDefaultStyle(const wxTextAttr& attr)
             m_ctrl->SetForegroundColour(attr.GetTextColour());
         }
         if(attr.GetFont().IsOk()) { m_defaultAttr.SetFont(attr.GetFont()); }
+        m_currentAttr = m_defaultAttr;
         m_ctrl->SetDefaultStyle(m_defaultAttr);
         m_ctrl->Refresh();
     }
 }
-
-void wxTerminalColourHandler::SetCaretEnd()
-{
-    // And ensure that the last line is visible
-    m_ctrl->ShowCommandLine();
-    m_ctrl->CallAfter(&TextView::Focus);
-}
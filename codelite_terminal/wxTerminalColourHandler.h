@@ -1,6 +1,7 @@
 #ifndef WXTERMINALCOLOURHANDLER_H
 #define WXTERMINALCOLOURHANDLER_H
 
+#include "wxTerminalScreenBuffer.h"
 #include <wx/textctrl.h>
 #include <unordered_map>
 #include <map>
@@ -22,18 +23,19 @@ class wxTerminalColourHandler : public wxEvtHandler
     wxString m_escapeSequence;
     std::unordered_map<int, wxColour> m_colours;
     wxTextAttr m_defaultAttr;
+    wxTextAttr m_currentAttr;
     wxString m_title;
+    wxTerminalScreenBuffer m_screen;
 
 protected:
     eColourHandlerState m_state = eColourHandlerState::kNormal;
     wxColour GetColour(long colour_number);
-    void SetCaretEnd();
-    
+
 protected:
     void Append(const wxString& buffer);
     void SetStyleFromEscape(const wxString& escape);
     void Clear();
-    void FlushBuffer(wxString& line);
+    void HandleControlChar(wxChar ch);
 
 public:
     wxTerminalColourHandler();
@@ -42,6 +44,16 @@ public:
     wxTerminalColourHandler& operator<<(const wxString& buffer);
     void SetCtrl(TextView* ctrl);
     void SetDefaultStyle(const wxTextAttr& attr);
+
+    /**
+     * @brief the parsed output. The handler only updates the screen buffer,
+     * it is up to the view to render it
+     */
+    wxTerminalScreenBuffer& GetScreen() { return m_screen; }
+    /**
+     * @brief the style set by the last SGR escape sequence
+     */
+    const wxTextAttr& GetCurrentStyle() const { return m_currentAttr; }
 };
 
 #endif // WXTERMINALCOLOURHANDLER_H
@@ -21,6 +21,9 @@ wxDEFINE_EVENT(wxEVT_TERMINAL_CTRL_STDERR, clCommandEvent);
 wxDEFINE_EVENT(wxEVT_TERMINAL_CTRL_DONE, clCommandEvent);
 wxDEFINE_EVENT(wxEVT_TERMINAL_CTRL_SET_TITLE, clCommandEvent);
 
+// The view is rendered at most once per RENDER_INTERVAL_MS, no matter how much output arrives
+static const int RENDER_INTERVAL_MS = 16;
+
 ///---------------------------------------------------------------
 /// Helper methods
 ///---------------------------------------------------------------
@@ -58,12 +61,18 @@ wxTerminalCtrl::wxTerminalCtrl(wxWindow* parent, wxWindowID winid, const wxExecu
 
     // load the commands from the configurationk file
     m_history.SetCommands(wxTerminalOptions::Get().GetHistory());
-    Bind(wxEVT_IDLE, &wxTerminalCtrl::OnIdle, this);
+
+    m_renderTimer = new wxTimer(this);
+    Bind(wxEVT_TIMER, &wxTerminalCtrl::OnRenderTimer, this, m_renderTimer->GetId());
 }
 
 wxTerminalCtrl::~wxTerminalCtrl()
 {
-    Unbind(wxEVT_IDLE, &wxTerminalCtrl::OnIdle, this);
+    if(m_renderTimer) {
+        m_renderTimer->Stop();
+        Unbind(wxEVT_TIMER, &wxTerminalCtrl::OnRenderTimer, this, m_renderTimer->GetId());
+        wxDELETE(m_renderTimer);
+    }
     if(m_shell) {
         m_shell->Detach();
         wxDELETE(m_shell);
@@ -132,7 +141,11 @@ void wxTerminalCtrl::Run(const wxString& command)
             ++a;
         }
         m_shell->WriteRaw(command + "\n");
-        AppendText("\n");
+        // Move what the user typed from the input area to the screen buffer
+        wxString input = m_echoOff ? wxString() : GetShellCommand();
+        ClearLine();
+        AppendText(input + "\n");
+        Render();
         if(!m_echoOff && !command.empty() && (command != "exit")) { m_history.Add(command); }
     }
 }
@@ -176,7 +189,27 @@ void wxTerminalCtrl::AppendText(const wxString& text)
         m_log.Flush();
     }
     m_textCtrl->StyleAndAppend(text);
+    if(!m_renderTimer->IsRunning()) { m_renderTimer->StartOnce(RENDER_INTERVAL_MS); }
+}
+
+void wxTerminalCtrl::OnRenderTimer(wxTimerEvent& event)
+{
+    wxUnusedVar(event);
+    Render();
+}
+
+void wxTerminalCtrl::Render()
+{
+    m_renderTimer->Stop();
+
+    // The command being typed is not part of the screen buffer, keep it at the end of the view
+    wxString command = GetShellCommand();
+    if(!m_textCtrl->Render()) { return; }
+
     m_commandOffset = m_textCtrl->GetLastPosition();
+    if(m_echoOff) { m_textCtrl->SetDefaultStyle(m_echoOffAttr); }
+    if(!command.IsEmpty()) { m_textCtrl->AppendText(command); }
+    m_textCtrl->ShowCommandLine();
     CallAfter(&wxTerminalCtrl::SetFocus);
 }
 
@@ -270,22 +303,9 @@ void wxTerminalCtrl::GenerateCtrlC()
 void wxTerminalCtrl::ClearScreen()
 {
     wxWindowUpdateLocker locker(m_textCtrl);
-#if USE_STC
+    // Delete the entire content excluding the last line
     m_textCtrl->Clear();
-    m_commandOffset = 0;
-    Run("");
-#else
-    // Delete the entire content excluding the last list
-    if(m_textCtrl->GetNumberOfLines() < 1) { return; }
-    long x, y;
-    if(!m_textCtrl->PositionToXY(m_textCtrl->GetLastPosition(), &x, &y)) { return; }
-    long insertPos = m_textCtrl->GetInsertionPoint();
-    long lineStartPos = m_textCtrl->XYToPosition(0, y);
-    m_textCtrl->Remove(0, lineStartPos);
-    m_commandOffset -= lineStartPos;
-    insertPos -= lineStartPos;
-    m_textCtrl->SetInsertionPoint(insertPos);
-#endif
+    Render();
 }
 
 void wxTerminalCtrl::ClearLine() { m_textCtrl->Remove(m_commandOffset, m_textCtrl->GetLastPosition()); }
@@ -310,16 +330,18 @@ void wxTerminalCtrl::SetEchoOff()
         if(line.Contains("password:") || line.Contains("password for")) {
             m_echoOff = true;
             m_preEchoOffAttr = m_textCtrl->GetDefaultStyle();
-            wxTextAttr echoOffAttr = m_preEchoOffAttr;
-            echoOffAttr.SetFontSize(0);
-            echoOffAttr.SetTextColour(echoOffAttr.GetBackgroundColour());
-            m_textCtrl->SetDefaultStyle(echoOffAttr);
+            m_echoOffAttr = m_preEchoOffAttr;
+            m_echoOffAttr.SetFontSize(0);
+            m_echoOffAttr.SetTextColour(m_echoOffAttr.GetBackgroundColour());
+            m_textCtrl->SetDefaultStyle(m_echoOffAttr);
         }
     }
 }
 
 void wxTerminalCtrl::DoProcessTerminated()
 {
+    // Flush the pending output before the view becomes read only
+    Render();
     if(m_style & wxTERMINAL_CTRL_USE_EVENTS) {
         clCommandEvent outputEvent(wxEVT_TERMINAL_CTRL_DONE);
         outputEvent.SetEventObject(this);
@@ -356,15 +378,3 @@ void wxTerminalCtrl::CheckInsertionPoint()
 void wxTerminalCtrl::ReloadSettings() { m_textCtrl->ReloadSettings(); }
 
 void wxTerminalCtrl::Focus() { m_textCtrl->Focus(); }
-
-void wxTerminalCtrl::OnIdle(wxIdleEvent& event)
-{
-#if 0
-    int count = m_textCtrl->Truncate();
-    if(count) {
-        m_commandOffset -= count;
-        m_textCtrl->SetInsertionPointEnd();
-    }
-#endif
-}
-
@@ -10,6 +10,7 @@
 #include "codelite_exports.h"
 #include <wx/utils.h>
 #include <wx/ffile.h>
+#include <wx/timer.h>
 
 class TextView;
 struct WXDLLIMPEXP_SDK wxTerminalHistory {
@@ -91,6 +92,7 @@ protected:
     std::string m_pts;      // Unix only
     bool m_echoOff = false; // Not used atm
     wxTextAttr m_preEchoOffAttr;
+    wxTextAttr m_echoOffAttr;
     wxString m_workingDirectory;
     bool m_pauseOnExit = false;
     bool m_printTTY = false;
@@ -99,6 +101,7 @@ protected:
     wxString m_logfile;
     wxFFile m_log;
     wxString m_ttyfile;
+    wxTimer* m_renderTimer = nullptr;
 
 protected:
     void PostCreate();
@@ -106,8 +109,12 @@ protected:
     wxString GetShellCommand() const;
     void SetShellCommand(const wxString& command);
     void SetCaretAtEnd();
-    void OnIdle(wxIdleEvent& event);
-    
+    void OnRenderTimer(wxTimerEvent& event);
+    /**
+     * @brief update the view from the screen buffer
+     */
+    void Render();
+
 protected:
     void OnProcessOutput(clProcessEvent& event);
     void OnProcessStderr(clProcessEvent& event);
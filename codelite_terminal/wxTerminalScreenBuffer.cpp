@@ -0,0 +1,54 @@
+#include "wxTerminalScreenBuffer.h"
+
+wxTerminalScreenBuffer::wxTerminalScreenBuffer(size_t maxLines)
+{
+    m_lines.resize(maxLines ? maxLines : 1);
+}
+
+wxTerminalScreenBuffer::~wxTerminalScreenBuffer() {}
+
+void wxTerminalScreenBuffer::MarkDirty(size_t line)
+{
+    if(!m_dirty || line < m_firstDirtyLine) {
+        m_firstDirtyLine = line;
+        m_dirty = true;
+    }
+}
+
+void wxTerminalScreenBuffer::Write(const wxString& text, const wxTextAttr& attr)
+{
+    if(text.IsEmpty()) { return; }
+
+    Line& line = DoGetLine(m_lastLine);
+    if(!line.runs.empty() && line.runs.back().attr == attr) {
+        line.runs.back().text << text;
+    } else {
+        line.runs.push_back({ text, attr });
+    }
+    MarkDirty(m_lastLine);
+}
+
+void wxTerminalScreenBuffer::NewLine()
+{
+    MarkDirty(m_lastLine);
+    ++m_lastLine;
+    if((m_lastLine - m_firstLine) >= m_lines.size()) {
+        // the buffer is full, drop the oldest line. Its slot is reused for the new line
+        ++m_firstLine;
+    }
+    DoGetLine(m_lastLine).Clear();
+}
+
+void wxTerminalScreenBuffer::ClearCurrentLine()
+{
+    Line& line = DoGetLine(m_lastLine);
+    if(line.runs.empty()) { return; }
+    line.Clear();
+    MarkDirty(m_lastLine);
+}
+
+void wxTerminalScreenBuffer::ClearScrollback()
+{
+    m_firstLine = m_lastLine;
+    MarkDirty(m_lastLine);
+}
@@ -0,0 +1,74 @@
+#ifndef WXTERMINALSCREENBUFFER_H
+#define WXTERMINALSCREENBUFFER_H
+
+#include <vector>
+#include <wx/string.h>
+#include <wx/textctrl.h>
+
+/**
+ * @class wxTerminalScreenBuffer
+ * @brief the terminal output model. A fixed size ring buffer of lines where each line
+ * is a list of style runs. Once the buffer is full, the oldest lines are dropped.
+ * The view is rendered from the buffer (see TextView::Render)
+ */
+class wxTerminalScreenBuffer
+{
+public:
+    struct Run {
+        wxString text;
+        wxTextAttr attr;
+    };
+
+    struct Line {
+        std::vector<Run> runs;
+        void Clear() { runs.clear(); }
+    };
+
+protected:
+    std::vector<Line> m_lines;
+    // lines are identified by an ever increasing number, the buffer holds [m_firstLine, m_lastLine]
+    size_t m_firstLine = 0;
+    size_t m_lastLine = 0;
+    // the first line modified since the last call to ClearDirty()
+    size_t m_firstDirtyLine = 0;
+    bool m_dirty = false;
+
+protected:
+    Line& DoGetLine(size_t line) { return m_lines[line % m_lines.size()]; }
+    void MarkDirty(size_t line);
+
+public:
+    wxTerminalScreenBuffer(size_t maxLines = 5000);
+    virtual ~wxTerminalScreenBuffer();
+
+    /**
+     * @brief append text (that does not contain a line terminator) to the current line
+     */
+    void Write(const wxString& text, const wxTextAttr& attr);
+    /**
+     * @brief terminate the current line and start a new one
+     */
+    void NewLine();
+    /**
+     * @brief erase the content of the current line (e.g. after a carriage return)
+     */
+    void ClearCurrentLine();
+    /**
+     * @brief drop all the lines, except for the current one
+     */
+    void ClearScrollback();
+
+    size_t GetFirstLine() const { return m_firstLine; }
+    size_t GetLastLine() const { return m_lastLine; }
+    const Line& GetLine(size_t line) const { return m_lines[line % m_lines.size()]; }
+    /**
+     * @brief all the lines, except for the current one, end with a line terminator
+     */
+    bool IsLineComplete(size_t line) const { return line < m_lastLine; }
+
+    bool IsDirty() const { return m_dirty; }
+    size_t GetFirstDirtyLine() const { return m_firstDirtyLine; }
+    void ClearDirty() { m_dirty = false; }
+};
+
+#endif // WXTERMINALSCREENBUFFER_H
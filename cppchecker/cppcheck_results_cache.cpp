@@ -0,0 +1,120 @@
+#include "cppcheck_results_cache.h"
+#include "JSON.h"
+#include "file_logger.h"
+#include "wxmd5.h"
+#include <algorithm>
+#include <vector>
+
+// The number of files we keep reports for. The least recently used ones are dropped first
+#define CPPCHECK_CACHE_MAX_ENTRIES 10000
+
+CppCheckResultsCache::CppCheckResultsCache() {}
+
+CppCheckResultsCache::~CppCheckResultsCache() {}
+
+void CppCheckResultsCache::Load(const wxFileName& filename)
+{
+    m_entries.clear();
+    m_dirty = false;
+    m_useCounter = 0;
+    m_filename = filename;
+    if(!m_filename.FileExists()) { return; }
+
+    JSON root(m_filename);
+    if(!root.isOk()) { return; }
+
+    JSONItem files = root.toElement().namedObject("files");
+    int count = files.arraySize();
+    for(int i = 0; i < count; ++i) {
+        JSONItem item = files.arrayItem(i);
+        Entry entry;
+        wxString name = item.namedObject("file").toString();
+        entry.checksum = item.namedObject("checksum").toString();
+        entry.output = item.namedObject("output").toString();
+        entry.lastUsed = item.namedObject("used").toSize_t();
+        if(name.IsEmpty() || entry.checksum.IsEmpty()) { continue; }
+        m_useCounter = std::max(m_useCounter, entry.lastUsed);
+        m_entries.insert({ name, entry });
+    }
+    clDEBUG() << "CppCheck: loaded" << m_entries.size() << "cached reports from" << m_filename.GetFullPath();
+}
+
+void CppCheckResultsCache::Save()
+{
+    if(!m_dirty || !m_filename.IsOk()) { return; }
+    DoTrim();
+
+    JSON root(cJSON_Object);
+    JSONItem files = JSONItem::createArray("files");
+    for(const auto& vt : m_entries) {
+        JSONItem item = JSONItem::createObject();
+        item.addProperty("file", vt.first);
+        item.addProperty("checksum", vt.second.checksum);
+        item.addProperty("output", vt.second.output);
+        item.addProperty("used", vt.second.lastUsed);
+        files.arrayAppend(item);
+    }
+    root.toElement().append(files);
+    root.save(m_filename);
+    m_dirty = false;
+}
+
+void CppCheckResultsCache::Clear()
+{
+    m_entries.clear();
+    m_dirty = false;
+    m_useCounter = 0;
+    m_filename.Clear();
+}
+
+bool CppCheckResultsCache::Get(const wxString& filename, const wxString& checksum, wxString& output)
+{
+    auto iter = m_entries.find(filename);
+    if(iter == m_entries.end() || iter->second.checksum != checksum) { return false; }
+    output = iter->second.output;
+    iter->second.lastUsed = ++m_useCounter;
+    m_dirty = true;
+    return true;
+}
+
+void CppCheckResultsCache::Put(const wxString& filename, const wxString& checksum, const wxString& output)
+{
+    Entry& entry = m_entries[filename];
+    entry.checksum = checksum;
+    entry.output = output;
+    entry.lastUsed = ++m_useCounter;
+    m_dirty = true;
+}
+
+void CppCheckResultsCache::DoTrim()
+{
+    if(m_entries.size() <= CPPCHECK_CACHE_MAX_ENTRIES) { return; }
+
+    std::vector<size_t> used;
+    used.reserve(m_entries.size());
+    for(const auto& vt : m_entries) {
+        used.push_back(vt.second.lastUsed);
+    }
+    // Keep the CPPCHECK_CACHE_MAX_ENTRIES most recently used entries
+    std::nth_element(used.begin(), used.end() - CPPCHECK_CACHE_MAX_ENTRIES, used.end());
+    size_t threshold = *(used.end() - CPPCHECK_CACHE_MAX_ENTRIES);
+    for(auto iter = m_entries.begin(); iter != m_entries.end();) {
+        if(iter->second.lastUsed < threshold) {
+            iter = m_entries.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+void CppCheckResultsCache::Remove(const wxString& filename)
+{
+    if(m_entries.erase(filename)) { m_dirty = true; }
+}
+
+wxString CppCheckResultsCache::ComputeChecksum(const wxString& filename, const wxString& settingsDigest)
+{
+    if(!wxFileName::FileExists(filename)) { return wxEmptyString; }
+    wxString fileDigest = wxMD5::GetDigest(wxFileName(filename));
+    return wxMD5::GetDigest(fileDigest + settingsDigest);
+}
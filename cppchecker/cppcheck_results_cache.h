@@ -0,0 +1,75 @@
+#ifndef CPPCHECKRESULTSCACHE_H
+#define CPPCHECKRESULTSCACHE_H
+
+#include <unordered_map>
+#include <wx/filename.h>
+#include <wx/string.h>
+
+/**
+ * @class CppCheckResultsCache
+ * @brief a persistent cache of cppcheck reports, keyed by the file name.
+ * An entry is considered valid only if its checksum (file content + cppcheck settings)
+ * matches the one computed for the current run. Only the most recently used entries are kept
+ */
+class CppCheckResultsCache
+{
+    struct Entry {
+        wxString checksum;
+        wxString output;
+        size_t lastUsed = 0;
+    };
+    std::unordered_map<wxString, Entry> m_entries;
+    wxFileName m_filename;
+    bool m_dirty = false;
+    size_t m_useCounter = 0;
+
+    void DoTrim();
+
+public:
+    CppCheckResultsCache();
+    virtual ~CppCheckResultsCache();
+
+    /**
+     * @brief load the cache from the disk. Any previous content is discarded
+     */
+    void Load(const wxFileName& filename);
+
+    /**
+     * @brief was the cache loaded (and not cleared since)?
+     */
+    bool IsLoaded() const { return m_filename.IsOk(); }
+
+    /**
+     * @brief write the cache back to the disk (only if it was modified)
+     */
+    void Save();
+
+    /**
+     * @brief release the cache content from memory. The copy on the disk is kept for the next Load()
+     */
+    void Clear();
+
+    /**
+     * @brief return the cached report for 'filename' if its checksum matches 'checksum'
+     */
+    bool Get(const wxString& filename, const wxString& checksum, wxString& output);
+
+    /**
+     * @brief store the report for a given file
+     */
+    void Put(const wxString& filename, const wxString& checksum, const wxString& output);
+
+    /**
+     * @brief remove a file from the cache (e.g. it was deleted or removed from its project)
+     */
+    void Remove(const wxString& filename);
+
+    /**
+     * @brief compute the checksum for a given file using the settings digest
+     * @param filename the file to hash
+     * @param settingsDigest digest of the options passed to cppcheck (see CppCheckPlugin::DoGetOptions)
+     */
+    static wxString ComputeChecksum(const wxString& filename, const wxString& settingsDigest);
+};
+
+#endif // CPPCHECKRESULTSCACHE_H
@@ -173,7 +173,7 @@ void CppCheckSettings::RemoveSuppressedWarning(const wxString& key)
     m_SuppressedWarnings1.erase(key);
 }
 
-wxString CppCheckSettings::GetOptions() const
+wxString CppCheckSettings::GetOptions(bool withJobs) const
 {
     wxString options;
     if(GetStyle()) {
@@ -206,7 +206,7 @@ wxString CppCheckSettings::GetOptions() const
     if(GetForce()) {
         options << wxT("--force ");
     }
-    if(GetJobs() > 1) {
+    if(withJobs && GetJobs() > 1) {
         options << wxT("-j") << GetJobs() << " ";
     }
     if(GetCheckConfig()) {
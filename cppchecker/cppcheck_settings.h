@@ -118,7 +118,11 @@ public:
     virtual void Serialize(Archive& arch);
     virtual void DeSerialize(Archive& arch);
 
-    wxString GetOptions() const;
+    /**
+     * @brief return the cppcheck command line options
+     * @param withJobs pass -j to cppcheck. Multiple jobs interleave the output of different files
+     */
+    wxString GetOptions(bool withJobs = true) const;
     void LoadProjectSpecificSettings(ProjectPtr proj);
 };
 
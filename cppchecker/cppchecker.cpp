@@ -39,6 +39,7 @@
 #include "procutils.h"
 #include "project.h"
 #include "workspace.h"
+#include "wxmd5.h"
 #include <wx/app.h>
 #include <wx/dir.h>
 #include <wx/ffile.h>
@@ -47,8 +48,10 @@
 #include <wx/menu.h>
 #include <wx/msgdlg.h>
 #include <wx/process.h>
+#include <wx/regex.h>
 #include <wx/sstream.h>
 #include <wx/stdpaths.h>
+#include <wx/thread.h>
 #include <wx/tokenzr.h>
 #include <wx/xml/xml.h>
 #include <wx/xrc/xmlres.h>
@@ -76,7 +79,7 @@ CL_PLUGIN_API int GetPluginInterfaceVersion() { return PLUGIN_INTERFACE_VERSION;
 
 CppCheckPlugin::CppCheckPlugin(IManager* manager)
     : IPlugin(manager)
-    , m_cppcheckProcess(NULL)
+    , m_analysisStopped(false)
     , m_canRestart(true)
     , m_explorerSepItem(NULL)
     , m_workspaceSepItem(NULL)
@@ -122,6 +125,8 @@ CppCheckPlugin::CppCheckPlugin(IManager* manager)
                                   NULL, this);
 
     EventNotifier::Get()->Bind(wxEVT_CONTEXT_MENU_EDITOR, &CppCheckPlugin::OnEditorContextMenu, this);
+    EventNotifier::Get()->Bind(wxEVT_PROJ_FILE_REMOVED, &CppCheckPlugin::OnProjectFileRemoved, this);
+    EventNotifier::Get()->Bind(wxEVT_FILE_DELETED, &CppCheckPlugin::OnFileDeleted, this);
     m_view = new CppCheckReportPage(m_mgr->GetOutputPaneNotebook(), m_mgr, this);
 
     //	wxBookCtrlBase *book = m_mgr->GetOutputPaneNotebook();
@@ -191,6 +196,8 @@ void CppCheckPlugin::UnPlug()
                                    (wxEvtHandler*)this);
 
     EventNotifier::Get()->Unbind(wxEVT_CONTEXT_MENU_EDITOR, &CppCheckPlugin::OnEditorContextMenu, this);
+    EventNotifier::Get()->Unbind(wxEVT_PROJ_FILE_REMOVED, &CppCheckPlugin::OnProjectFileRemoved, this);
+    EventNotifier::Get()->Unbind(wxEVT_FILE_DELETED, &CppCheckPlugin::OnFileDeleted, this);
     EventNotifier::Get()->Disconnect(wxEVT_WORKSPACE_CLOSED, wxCommandEventHandler(CppCheckPlugin::OnWorkspaceClosed),
                                      NULL, this);
 
@@ -203,8 +210,12 @@ void CppCheckPlugin::UnPlug()
     }
     m_view->Destroy();
 
-    // terminate the cppcheck daemon
-    wxDELETE(m_cppcheckProcess);
+    // terminate the cppcheck daemons
+    for(auto& vt : m_processes) {
+        IProcess* process = vt.first;
+        wxDELETE(process);
+    }
+    m_processes.clear();
 }
 
 wxMenu* CppCheckPlugin::CreateFileExplorerPopMenu()
@@ -269,7 +280,7 @@ wxMenu* CppCheckPlugin::CreateWorkspacePopMenu()
 
 void CppCheckPlugin::OnCheckFileEditorItem(wxCommandEvent& e)
 {
-    if(m_cppcheckProcess) {
+    if(AnalysisInProgress()) {
         clLogMessage(_("CppCheckPlugin: CppCheck is currently busy please wait for it to complete the current check"));
         return;
     }
@@ -287,7 +298,7 @@ void CppCheckPlugin::OnCheckFileEditorItem(wxCommandEvent& e)
 
 void CppCheckPlugin::OnCheckFileExplorerItem(wxCommandEvent& e)
 {
-    if(m_cppcheckProcess) {
+    if(AnalysisInProgress()) {
         clLogMessage(_("CppCheckPlugin: CppCheck is currently busy please wait for it to complete the current check"));
         return;
     }
@@ -307,7 +318,7 @@ void CppCheckPlugin::OnCheckFileExplorerItem(wxCommandEvent& e)
 
 void CppCheckPlugin::OnCheckWorkspaceItem(wxCommandEvent& e)
 {
-    if(m_cppcheckProcess) {
+    if(AnalysisInProgress()) {
         clLogMessage(_("CppCheckPlugin: CppCheck is currently busy please wait for it to complete the current check"));
         return;
     }
@@ -357,7 +368,7 @@ ProjectPtr CppCheckPlugin::FindSelectedProject()
 
 void CppCheckPlugin::OnCheckProjectItem(wxCommandEvent& e)
 {
-    if(m_cppcheckProcess) {
+    if(AnalysisInProgress()) {
         clLogMessage(_("CppCheckPlugin: CppCheck is currently busy please wait for it to complete the current check"));
         return;
     }
@@ -382,8 +393,24 @@ void CppCheckPlugin::OnCheckProjectItem(wxCommandEvent& e)
 
 void CppCheckPlugin::OnCppCheckTerminated(clProcessEvent& e)
 {
+    IProcess* process = e.GetProcess();
+    auto iter = m_processes.find(process);
+    if(iter != m_processes.end()) {
+        Shard& shard = iter->second;
+        if(!shard.partialLine.IsEmpty()) { DoCollectReportLine(shard, shard.partialLine); }
+        // The last file reported by an interrupted process is incomplete, don't cache it
+        if(!m_analysisStopped) { DoCommitReport(shard); }
+        ::wxRemoveFile(shard.listFile);
+        m_processes.erase(iter);
+    }
+    wxDELETE(process);
+
+    // Wait for the remaining shards to complete
+    if(!m_processes.empty()) { return; }
+
+    m_cache.Save();
+    m_checksums.clear();
     m_filelist.Clear();
-    wxDELETE(m_cppcheckProcess);
 
     m_view->PrintStatusMessage();
     m_view->GotoFirstError();
@@ -448,29 +475,57 @@ void CppCheckPlugin::GetFileListFromDir(const wxString& root)
 
 void CppCheckPlugin::DoProcess(ProjectPtr proj)
 {
-    wxString command = DoGetCommand(proj);
-    m_view->AppendLine(wxString::Format(_("Starting cppcheck: %s\n"), command.c_str()));
+    // Split the files into shards, each shard is checked by its own codelite_cppcheck process
+    size_t shardsCount = DoGetShardsCount();
+    std::vector<wxArrayString> shards(shardsCount);
+    for(size_t i = 0; i < m_filelist.GetCount(); ++i) {
+        shards[i % shardsCount].Add(m_filelist.Item(i));
+    }
 
+    for(size_t i = 0; i < shards.size(); ++i) {
+        wxString fileList = DoGenerateFileList(shards[i], i);
+        if(fileList.IsEmpty()) { continue; }
+
+        wxString command = DoGetCommand(proj, fileList);
+        m_view->AppendLine(wxString::Format(_("Starting cppcheck: %s\n"), command.c_str()));
+
+        IProcess* process = NULL;
 #if defined(__WXMSW__)
-    // Under Windows, we set the working directory to the binary folder
-    // so the configurtion files can be found
-    CL_DEBUG("CppCheck: Working directory: %s", clStandardPaths::Get().GetBinFolder());
-    CL_DEBUG("CppCheck: Command: %s", command);
-    m_cppcheckProcess = CreateAsyncProcess(this, command, IProcessCreateDefault, clStandardPaths::Get().GetBinFolder());
+        // Under Windows, we set the working directory to the binary folder
+        // so the configurtion files can be found
+        CL_DEBUG("CppCheck: Working directory: %s", clStandardPaths::Get().GetBinFolder());
+        CL_DEBUG("CppCheck: Command: %s", command);
+        process = CreateAsyncProcess(this, command, IProcessCreateDefault, clStandardPaths::Get().GetBinFolder());
 #elif defined(__WXOSX__)
-    CL_DEBUG("CppCheck: Working directory: %s", clStandardPaths::Get().GetDataDir());
-    CL_DEBUG("CppCheck: Command: %s", command);
-    m_cppcheckProcess = CreateAsyncProcess(this, command, IProcessCreateDefault, clStandardPaths::Get().GetDataDir());
+        CL_DEBUG("CppCheck: Working directory: %s", clStandardPaths::Get().GetDataDir());
+        CL_DEBUG("CppCheck: Command: %s", command);
+        process = CreateAsyncProcess(this, command, IProcessCreateDefault, clStandardPaths::Get().GetDataDir());
 
 #else
-    m_cppcheckProcess = CreateAsyncProcess(this, command);
+        process = CreateAsyncProcess(this, command);
 #endif
-    if(!m_cppcheckProcess) {
-        wxMessageBox(_("Failed to launch codelite_cppcheck process!"), _("Warning"), wxOK | wxCENTER | wxICON_WARNING);
-        return;
+        if(!process) {
+            wxMessageBox(_("Failed to launch codelite_cppcheck process!"), _("Warning"),
+                         wxOK | wxCENTER | wxICON_WARNING);
+            break;
+        }
+
+        Shard shard;
+        shard.listFile = fileList;
+        m_processes.insert({ process, shard });
     }
 }
 
+size_t CppCheckPlugin::DoGetShardsCount() const
+{
+    // unusedFunction requires a whole program view, so it can not be split between processes
+    if(m_settings.GetUnusedFunctions()) { return 1; }
+
+    // The shards are checked without -j (see DoGetOptions) so use a process per CPU instead
+    size_t count = (size_t)wxMax(1, wxThread::GetCPUCount());
+    return wxMax((size_t)1, wxMin(count, m_filelist.GetCount()));
+}
+
 /**
  * Ensure that the CppCheck tab is visible
  */
@@ -507,10 +562,10 @@ void CppCheckPlugin::SetTabVisible(bool clearContent)
 
 void CppCheckPlugin::StopAnalysis()
 {
-    // Clear the files queue
-    if(m_cppcheckProcess) {
-        // terminate the m_cppcheckProcess
-        m_cppcheckProcess->Terminate();
+    // terminate all the running shards
+    m_analysisStopped = true;
+    for(auto& vt : m_processes) {
+        vt.first->Terminate();
     }
 }
 
@@ -540,9 +595,40 @@ void CppCheckPlugin::RemoveExcludedFiles()
 void CppCheckPlugin::OnWorkspaceClosed(wxCommandEvent& e)
 {
     m_view->Clear();
+    // The reports are kept on the disk, don't hold them in memory for the next workspace
+    m_cache.Save();
+    m_cache.Clear();
     e.Skip();
 }
 
+void CppCheckPlugin::OnProjectFileRemoved(clCommandEvent& e)
+{
+    e.Skip();
+    DoRemoveFromCache(e.GetStrings());
+}
+
+void CppCheckPlugin::OnFileDeleted(clFileSystemEvent& e)
+{
+    e.Skip();
+    DoRemoveFromCache(e.GetPaths());
+}
+
+wxFileName CppCheckPlugin::DoGetCacheFile() const
+{
+    return wxFileName(clCxxWorkspaceST::Get()->GetPrivateFolder(), "cppcheck.cache.json");
+}
+
+void CppCheckPlugin::DoRemoveFromCache(const wxArrayString& files)
+{
+    if(files.IsEmpty() || !clCxxWorkspaceST::Get()->IsOpen()) { return; }
+    if(!m_cache.IsLoaded()) { m_cache.Load(DoGetCacheFile()); }
+    for(size_t i = 0; i < files.size(); ++i) {
+        m_cache.Remove(files.Item(i));
+    }
+    // Save() is a no-op when none of the files was cached
+    m_cache.Save();
+}
+
 void CppCheckPlugin::DoStartTest(ProjectPtr proj /*=NULL*/)
 {
     RemoveExcludedFiles();
@@ -557,24 +643,78 @@ void CppCheckPlugin::DoStartTest(ProjectPtr proj /*=NULL*/)
     // We need to load any project-specific settings: definitions and undefines
     // (We couldn't do that with the rest of the settings as the workspace hadn't yet been loaded)
     m_settings.LoadProjectSpecificSettings(proj); // NB we still do this if !proj, as that will clear any stale settings
+    m_analysisStopped = false;
+
+    // Report the unchanged files from the cache
+    DoLoadResultsFromCache(proj);
+    if(m_filelist.IsEmpty()) {
+        m_view->PrintStatusMessage();
+        m_view->GotoFirstError();
+        return;
+    }
 
     // Start the test
     DoProcess(proj);
 }
 
-wxString CppCheckPlugin::DoGetCommand(ProjectPtr proj)
+void CppCheckPlugin::DoLoadResultsFromCache(ProjectPtr proj)
+{
+    m_checksums.clear();
+
+    // unusedFunction reports depend on the other files as well, so we can't cache them per file
+    if(m_settings.GetUnusedFunctions()) { return; }
+
+    m_cache.Load(DoGetCacheFile());
+    wxString settingsDigest = wxMD5::GetDigest(DoGetOptions(proj));
+
+    wxArrayString modifiedFiles;
+    size_t cachedCount = 0;
+    for(size_t i = 0; i < m_filelist.GetCount(); ++i) {
+        const wxString& filename = m_filelist.Item(i);
+        wxString checksum = CppCheckResultsCache::ComputeChecksum(filename, settingsDigest);
+        wxString output;
+        if(!checksum.IsEmpty() && m_cache.Get(filename, checksum, output)) {
+            if(!output.IsEmpty()) { m_view->AppendLine(output); }
+            ++cachedCount;
+        } else {
+            modifiedFiles.Add(filename);
+            if(!checksum.IsEmpty()) { m_checksums.insert({ filename, checksum }); }
+        }
+    }
+
+    if(cachedCount) {
+        m_view->AppendLine(wxString::Format(_("CppCheck: loaded %u unchanged files from the cache, %u files to check\n"),
+                                            (unsigned)cachedCount, (unsigned)modifiedFiles.GetCount()));
+    }
+    m_filelist.swap(modifiedFiles);
+}
+
+wxString CppCheckPlugin::DoGetCommand(ProjectPtr proj, const wxString& fileList)
 {
     // Linux / Mac way: spawn the process and execute the command
     wxString cmd, path;
     path = clStandardPaths::Get().GetBinaryFullPath("codelite_cppcheck");
     ::WrapWithQuotes(path);
 
-    wxString fileList = DoGenerateFileList();
-    if(fileList.IsEmpty()) return wxT("");
-
     // build the command
     cmd << path << " ";
-    cmd << m_settings.GetOptions();
+    cmd << DoGetOptions(proj);
+
+    wxString quotedFileList = fileList;
+    cmd << wxT(" --file-list=");
+    ::WrapWithQuotes(quotedFileList);
+    cmd << quotedFileList << " ";
+    CL_DEBUG("cppcheck command: %s", cmd);
+    ::WrapInShell(cmd);
+    return cmd;
+}
+
+wxString CppCheckPlugin::DoGetOptions(ProjectPtr proj)
+{
+    wxString cmd;
+    // With -j cppcheck interleaves the "Checking <file>" lines with the results of other files, which breaks the
+    // per file results cache. Only the single unusedFunction process (which is not cached) uses it
+    cmd << m_settings.GetOptions(m_settings.GetUnusedFunctions());
 
     // Append here project specifc search paths
     if(proj) {
@@ -591,19 +731,14 @@ wxString CppCheckPlugin::DoGetCommand(ProjectPtr proj)
             cmd << " -D" << projMacros.Item(i);
         }
     }
-
-    cmd << wxT(" --file-list=");
-    ::WrapWithQuotes(fileList);
-    cmd << fileList << " ";
-    CL_DEBUG("cppcheck command: %s", cmd);
-    ::WrapInShell(cmd);
     return cmd;
 }
 
-wxString CppCheckPlugin::DoGenerateFileList()
+wxString CppCheckPlugin::DoGenerateFileList(const wxArrayString& files, size_t shardIndex)
 {
     // create temporary file and save the file there
-    wxFileName fnFileList(clCxxWorkspaceST::Get()->GetPrivateFolder(), "cppcheck.list");
+    wxFileName fnFileList(clCxxWorkspaceST::Get()->GetPrivateFolder(),
+                          wxString::Format("cppcheck.%u.list", (unsigned)shardIndex));
 
     // create temporary file and save the file there
     wxFFile file(fnFileList.GetFullPath(), wxT("w+b"));
@@ -614,8 +749,8 @@ wxString CppCheckPlugin::DoGenerateFileList()
     }
 
     wxString content;
-    for(size_t i = 0; i < m_filelist.GetCount(); i++) {
-        content << m_filelist.Item(i) << wxT("\n");
+    for(size_t i = 0; i < files.GetCount(); i++) {
+        content << files.Item(i) << wxT("\n");
     }
 
     file.Write(content);
@@ -628,6 +763,60 @@ void CppCheckPlugin::OnCppCheckReadData(clProcessEvent& e)
 {
     e.Skip();
     m_view->AppendLine(e.GetOutput());
+
+    auto iter = m_processes.find(e.GetProcess());
+    if(iter != m_processes.end()) { DoCollectReport(iter->second, e.GetOutput()); }
+}
+
+void CppCheckPlugin::DoCollectReport(Shard& shard, const wxString& output)
+{
+    if(m_checksums.empty()) { return; }
+
+    // The output may be split in the middle of a line, keep the remainder for the next chunk
+    wxString buffer = shard.partialLine + output;
+    shard.partialLine.Clear();
+    size_t start = 0;
+    size_t where = buffer.find('\n');
+    while(where != wxString::npos) {
+        DoCollectReportLine(shard, buffer.Mid(start, where - start));
+        start = where + 1;
+        where = buffer.find('\n', start);
+    }
+    shard.partialLine = buffer.Mid(start);
+}
+
+void CppCheckPlugin::DoCollectReportLine(Shard& shard, const wxString& line)
+{
+    static wxRegEx reProgress(wxT("([0-9]+)/([0-9]+)( files checked )([0-9]+%)( done)"));
+
+    wxString tmpLine = line;
+    tmpLine.Trim();
+    if(tmpLine.IsEmpty() || reProgress.Matches(tmpLine)) { return; }
+
+    if(tmpLine.StartsWith("Checking ")) {
+        // "Checking <file> ..." or "Checking <file>: <configuration>..."
+        wxString filename = tmpLine.Mid(9);
+        if(filename.EndsWith("...")) { filename.RemoveLast(3); }
+        filename.Trim();
+        if(m_checksums.count(filename) == 0) { filename = filename.BeforeLast(':').Trim(); }
+        if(m_checksums.count(filename) && filename != shard.currentFile) {
+            // cppcheck moved to the next file
+            DoCommitReport(shard);
+            shard.currentFile = filename;
+        }
+        return;
+    }
+
+    if(!shard.currentFile.IsEmpty()) { shard.report << tmpLine << "\n"; }
+}
+
+void CppCheckPlugin::DoCommitReport(Shard& shard)
+{
+    if(!shard.currentFile.IsEmpty() && m_checksums.count(shard.currentFile)) {
+        m_cache.Put(shard.currentFile, m_checksums[shard.currentFile], shard.report);
+    }
+    shard.currentFile.Clear();
+    shard.report.Clear();
 }
 
 void CppCheckPlugin::OnEditorContextMenu(clContextMenuEvent& event)
@@ -30,14 +30,27 @@
 #include "asyncprocess.h"
 #include "cppcheck_settings.h"
 #include "clTabTogglerHelper.h"
+#include "cppcheck_results_cache.h"
+#include <unordered_map>
 
 class wxMenuItem;
 class CppCheckReportPage;
 
 class CppCheckPlugin : public IPlugin
 {
+    /// A single codelite_cppcheck process checking a subset of the files
+    struct Shard {
+        wxString listFile;
+        wxString partialLine;
+        wxString currentFile;
+        wxString report;
+    };
+
     wxString m_cppcheckPath;
-    IProcess* m_cppcheckProcess;
+    std::unordered_map<IProcess*, Shard> m_processes;
+    CppCheckResultsCache m_cache;
+    wxStringMap_t m_checksums;
+    bool m_analysisStopped;
     bool m_canRestart;
     wxArrayString m_filelist;
     wxMenuItem* m_explorerSepItem;
@@ -51,8 +64,32 @@ class CppCheckPlugin : public IPlugin
     clTabTogglerHelper::Ptr_t m_tabHelper;
 
 protected:
-    wxString DoGetCommand(ProjectPtr proj);
-    wxString DoGenerateFileList();
+    wxString DoGetCommand(ProjectPtr proj, const wxString& fileList);
+    wxString DoGetOptions(ProjectPtr proj);
+    wxString DoGenerateFileList(const wxArrayString& files, size_t shardIndex);
+    size_t DoGetShardsCount() const;
+
+    /**
+     * @brief report the unchanged files from the cache and remove them from the list of files to check
+     */
+    void DoLoadResultsFromCache(ProjectPtr proj);
+
+    /**
+     * @brief return the path of the workspace's cppcheck results cache
+     */
+    wxFileName DoGetCacheFile() const;
+
+    /**
+     * @brief drop the cached reports of files that are no longer part of the workspace
+     */
+    void DoRemoveFromCache(const wxArrayString& files);
+
+    /**
+     * @brief split the output of a shard into lines and associate them with the file being checked
+     */
+    void DoCollectReport(Shard& shard, const wxString& output);
+    void DoCollectReportLine(Shard& shard, const wxString& line);
+    void DoCommitReport(Shard& shard);
 
 protected:
     wxMenu* CreateEditorPopMenu();
@@ -111,6 +148,8 @@ protected:
      * @param e
      */
     void OnWorkspaceClosed(wxCommandEvent& e);
+    void OnProjectFileRemoved(clCommandEvent& e);
+    void OnFileDeleted(clFileSystemEvent& e);
     /**
      * @brief handle the settings item
      * @param e event
@@ -148,7 +187,7 @@ public:
     /**
      * @brief return true if analysis currently running
      */
-    bool AnalysisInProgress() const { return m_cppcheckProcess != NULL; }
+    bool AnalysisInProgress() const { return !m_processes.empty(); }
 
     /**
      * @brief return the progress
@@ -87,6 +87,7 @@ Cscope::Cscope(IManager* manager)
     m_tabHelper->SetOutputTabBmp(m_mgr->GetStdIcons()->LoadBitmap("cscope"));
 
     Connect(wxEVT_CSCOPE_THREAD_DONE, wxCommandEventHandler(Cscope::OnCScopeThreadEnded), NULL, this);
+    Connect(wxEVT_CSCOPE_THREAD_RESULTS, wxCommandEventHandler(Cscope::OnCScopeThreadEnded), NULL, this);
     Connect(wxEVT_CSCOPE_THREAD_UPDATE_STATUS, wxCommandEventHandler(Cscope::OnCScopeThreadUpdateStatus), NULL, this);
 
     // start the helper thread
@@ -570,8 +571,13 @@ wxString Cscope::GetCscopeExeName()
 
 void Cscope::OnCScopeThreadEnded(wxCommandEvent& e)
 {
+    // Called for every batch of results, and for the last one
     CScopeResultTable_t* result = (CScopeResultTable_t*)e.GetClientData();
-    m_cscopeWin->BuildTable(result);
+    if(e.GetInt()) {
+        m_cscopeWin->BuildTable(result);
+    } else {
+        m_cscopeWin->AppendTable(result);
+    }
 }
 
 void Cscope::OnCScopeThreadUpdateStatus(wxCommandEvent& e)
@@ -29,10 +29,191 @@
 #include "file_logger.h"
 #include "procutils.h"
 #include "wx/filefn.h"
+#include <string.h>
+#include <string>
+#include <vector>
+#include <wx/stopwatch.h>
+
+#ifndef __WXMSW__
+#include <errno.h>
+#include <stdio.h>
+#include <unistd.h>
+#endif
+
+// Send the results collected so far once we have this many entries...
+#define CSCOPE_BATCH_SIZE 1000
+// ... or when the oldest pending entry is older than this
+#define CSCOPE_BATCH_MS 250
+#define CSCOPE_READ_CHUNK_SIZE (64 * 1024)
 
 int wxEVT_CSCOPE_THREAD_DONE = wxNewId();
+int wxEVT_CSCOPE_THREAD_RESULTS = wxNewId();
 int wxEVT_CSCOPE_THREAD_UPDATE_STATUS = wxNewId();
 
+namespace
+{
+/**
+ * @brief parse cscope's output as it arrives. Each line has the format:
+ * <file> <scope> <line number> <pattern>
+ */
+class CscopeOutputParser
+{
+    CScopeResultTable_t* m_results;
+    size_t m_count;
+    std::string m_partialLine;
+    // The entries of a file are consecutive, so remember the last file instead of converting and looking it up
+    // for every line
+    std::string m_lastFile;
+    wxString m_lastFileName;
+    CScopeEntryDataVec_t* m_lastVec;
+
+    static wxString ToString(const char* start, const char* end)
+    {
+        wxString str = wxString::FromUTF8(start, end - start);
+        if(str.IsEmpty() && start != end) {
+            // Not a valid UTF-8 string
+            str = wxString::From8BitData(start, end - start);
+        }
+        return str;
+    }
+
+    static bool IsSpace(char ch) { return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n'; }
+
+    static const char* SkipSpaces(const char* ptr, const char* end)
+    {
+        while(ptr < end && IsSpace(*ptr)) {
+            ++ptr;
+        }
+        return ptr;
+    }
+
+    static const char* FindSpace(const char* ptr, const char* end)
+    {
+        while(ptr < end && *ptr != ' ') {
+            ++ptr;
+        }
+        return ptr;
+    }
+
+    void ParseLine(const char* start, const char* end)
+    {
+        start = SkipSpaces(start, end);
+        while(end > start && IsSpace(*(end - 1))) {
+            --end;
+        }
+        if(start == end) { return; }
+
+        // skip errors
+        static const char errPrefix[] = "cscope:";
+        if((size_t)(end - start) >= (sizeof(errPrefix) - 1) && memcmp(start, errPrefix, sizeof(errPrefix) - 1) == 0) {
+            return;
+        }
+
+        // first is the file name
+        const char* fileEnd = FindSpace(start, end);
+        if(!m_lastVec || m_lastFile.compare(0, std::string::npos, start, fileEnd - start) != 0) {
+            m_lastFile.assign(start, fileEnd - start);
+            m_lastFileName = ToString(start, fileEnd);
+            CScopeResultTable_t::iterator iter = m_results->find(m_lastFileName);
+            if(iter == m_results->end()) {
+                // The table is handed to the main thread: use c_str() to make sure we create a unique copy (the
+                // entries copy it as well, see CscopeEntryData::SetFile())
+                iter = m_results->insert({ wxString(m_lastFileName.c_str()), new CScopeEntryDataVec_t() }).first;
+            }
+            m_lastVec = iter->second;
+        }
+
+        // next is the scope
+        const char* ptr = SkipSpaces(fileEnd, end);
+        const char* scopeEnd = FindSpace(ptr, end);
+        CscopeEntryData data;
+        data.SetFile(m_lastFileName);
+        data.SetScope(ToString(ptr, scopeEnd));
+
+        // next is the line number
+        ptr = SkipSpaces(scopeEnd, end);
+        long lineNumber = 0;
+        while(ptr < end && *ptr >= '0' && *ptr <= '9') {
+            lineNumber = (lineNumber * 10) + (*ptr - '0');
+            ++ptr;
+        }
+        data.SetLine(lineNumber);
+
+        // the rest is the pattern
+        ptr = FindSpace(ptr, end);
+        if(ptr < end) { ++ptr; }
+        data.SetPattern(ToString(ptr, end));
+
+        m_lastVec->push_back(data);
+        ++m_count;
+    }
+
+public:
+    CscopeOutputParser()
+        : m_results(new CScopeResultTable_t())
+        , m_count(0)
+        , m_lastVec(NULL)
+    {
+    }
+
+    ~CscopeOutputParser()
+    {
+        for(CScopeResultTable_t::value_type& p : *m_results) {
+            delete p.second;
+        }
+        delete m_results;
+    }
+
+    void Feed(const char* data, size_t len)
+    {
+        const char* start = data;
+        const char* end = data + len;
+        while(start < end) {
+            const char* eol = (const char*)memchr(start, '\n', end - start);
+            if(!eol) {
+                m_partialLine.append(start, end - start);
+                break;
+            }
+            if(m_partialLine.empty()) {
+                // Parse the line directly from the input buffer
+                ParseLine(start, eol);
+            } else {
+                m_partialLine.append(start, eol - start);
+                ParseLine(m_partialLine.data(), m_partialLine.data() + m_partialLine.length());
+                m_partialLine.clear();
+            }
+            start = eol + 1;
+        }
+    }
+
+    /**
+     * @brief the output has ended, parse the last line
+     */
+    void Finish()
+    {
+        ParseLine(m_partialLine.data(), m_partialLine.data() + m_partialLine.length());
+        m_partialLine.clear();
+    }
+
+    /**
+     * @brief the number of entries collected since the last call to TakeResults()
+     */
+    size_t GetCount() const { return m_count; }
+
+    /**
+     * @brief return the entries collected so far. The caller takes ownership of the table
+     */
+    CScopeResultTable_t* TakeResults()
+    {
+        CScopeResultTable_t* results = m_results;
+        m_results = new CScopeResultTable_t();
+        m_count = 0;
+        m_lastVec = NULL;
+        return results;
+    }
+};
+} // namespace
+
 CscopeDbBuilderThread::CscopeDbBuilderThread() {}
 
 CscopeDbBuilderThread::~CscopeDbBuilderThread() {}
@@ -47,76 +228,73 @@ void CscopeDbBuilderThread::ProcessRequest(ThreadRequest* request)
     wxSetWorkingDirectory(req->GetWorkingDir());
     SendStatusEvent(_("Executing cscope..."), 10, req->GetFindWhat(), req->GetOwner());
 
-    // notify the database creation process as completed
-    wxArrayString output;
-
     // set environment variables required by cscope
     wxSetEnv(wxT("TMPDIR"), wxFileName::GetTempDir());
     clDEBUG() << "CScope:" << req->GetCmd() << clEndl;
+
+    // Parse the output as it arrives and pass the results to the UI in batches
+    CscopeOutputParser parser;
+    bool first = true;
+    size_t total = 0;
+    wxStopWatch sw, batchTimer;
+    auto SendBatch = [&]() {
+        total += parser.GetCount();
+        SendResultsEvent(wxEVT_CSCOPE_THREAD_RESULTS, parser.TakeResults(), first, req->GetOwner());
+        first = false;
+        batchTimer.Start();
+    };
+    auto OnOutput = [&](const char* data, size_t len) {
+        if(parser.GetCount() == 0) { batchTimer.Start(); }
+        parser.Feed(data, len);
+        if(parser.GetCount() >= CSCOPE_BATCH_SIZE || (parser.GetCount() && batchTimer.Time() >= CSCOPE_BATCH_MS)) {
+            SendBatch();
+        }
+    };
+
+#ifdef __WXMSW__
+    // No streaming here, parse the complete output
+    wxArrayString output;
     ProcUtils::SafeExecuteCommand(req->GetCmd(), output);
-    SendStatusEvent(_("Parsing results..."), 50, wxEmptyString, req->GetOwner());
-    clDEBUG1() << "CScope:\n" << output << clEndl;
-    CScopeResultTable_t* result = ParseResults(output);
+    for(const wxString& line : output) {
+        const wxCharBuffer cb = line.mb_str(wxConvUTF8);
+        OnOutput(cb.data(), cb.length());
+        OnOutput("\n", 1);
+    }
+#else
+    FILE* fp = popen(req->GetCmd().mb_str(wxConvUTF8).data(), "r");
+    if(fp) {
+        // read() returns as soon as some output is available, unlike fread()
+        std::vector<char> buffer(CSCOPE_READ_CHUNK_SIZE);
+        ssize_t bytes = 0;
+        while((bytes = ::read(fileno(fp), buffer.data(), buffer.size())) != 0) {
+            if(bytes < 0) {
+                if(errno == EINTR) { continue; }
+                break;
+            }
+            OnOutput(buffer.data(), (size_t)bytes);
+        }
+        pclose(fp);
+    }
+#endif
+    parser.Finish();
+    total += parser.GetCount();
+    clDEBUG() << "CScope:" << total << "entries in" << sw.Time() << "ms" << clEndl;
     SendStatusEvent(_("Done"), 100, wxEmptyString, req->GetOwner());
 
     // send status message
     SendStatusEvent(req->GetEndMsg(), 100, wxEmptyString, req->GetOwner());
 
-    // send the results
-    wxCommandEvent e(wxEVT_CSCOPE_THREAD_DONE);
-    e.SetClientData(result);
-    req->GetOwner()->AddPendingEvent(e);
+    // send the remaining results
+    SendResultsEvent(wxEVT_CSCOPE_THREAD_DONE, parser.TakeResults(), first, req->GetOwner());
 }
 
-CScopeResultTable_t* CscopeDbBuilderThread::ParseResults(const wxArrayString& output)
+void CscopeDbBuilderThread::SendResultsEvent(int eventType, CScopeResultTable_t* results, bool first,
+                                             wxEvtHandler* owner)
 {
-    CScopeResultTable_t* results = new CScopeResultTable_t();
-    for(size_t i = 0; i < output.GetCount(); i++) {
-        // parse each line
-        wxString line = output.Item(i);
-        CscopeEntryData data;
-
-        // first is the file name
-        line = line.Trim().Trim(false);
-        // skip errors
-        if(line.StartsWith(wxT("cscope:"))) { continue; }
-
-        wxString file = line.BeforeFirst(wxT(' '));
-        data.SetFile(file);
-        line = line.AfterFirst(wxT(' '));
-
-        // next is the scope
-        line = line.Trim().Trim(false);
-        wxString scope = line.BeforeFirst(wxT(' '));
-        line = line.AfterFirst(wxT(' '));
-        data.SetScope(scope);
-
-        // next is the line number
-        line = line.Trim().Trim(false);
-        long nn;
-        wxString line_number = line.BeforeFirst(wxT(' '));
-        line_number.ToLong(&nn);
-        data.SetLine(nn);
-        line = line.AfterFirst(wxT(' '));
-
-        // the rest is the pattern
-        wxString pattern = line;
-        data.SetPattern(pattern);
-
-        // insert the result
-        CScopeResultTable_t::const_iterator iter = results->find(data.GetFile());
-        std::vector<CscopeEntryData>* vec(NULL);
-        if(iter != results->end()) {
-            // this file already exist, append the result
-            vec = iter->second;
-        } else {
-            vec = new std::vector<CscopeEntryData>();
-            // add it to the map
-            (*results)[data.GetFile()] = vec;
-        }
-        vec->push_back(data);
-    }
-    return results;
+    wxCommandEvent e(eventType);
+    e.SetClientData(results);
+    e.SetInt(first ? 1 : 0);
+    owner->AddPendingEvent(e);
 }
 
 void CscopeDbBuilderThread::SendStatusEvent(const wxString& msg, int percent, const wxString& findWhat,
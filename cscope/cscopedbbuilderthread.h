@@ -36,6 +36,7 @@
 #include <wx/string.h>
 
 extern int wxEVT_CSCOPE_THREAD_DONE;
+extern int wxEVT_CSCOPE_THREAD_RESULTS;
 extern int wxEVT_CSCOPE_THREAD_UPDATE_STATUS;
 
 typedef std::vector<CscopeEntryData> CScopeEntryDataVec_t;
@@ -84,10 +85,14 @@ class CscopeDbBuilderThread : public WorkerThread
 
 protected:
     void ProcessRequest(ThreadRequest* req);
-    CScopeResultTable_t* ParseResults(const wxArrayString& output);
 
 protected:
     void SendStatusEvent(const wxString& msg, int percent, const wxString& findWhat, wxEvtHandler* owner);
+    /**
+     * @brief send a batch of results to the owner. The owner takes ownership of the table.
+     * The first batch of a query replaces the results of the previous one
+     */
+    void SendResultsEvent(int eventType, CScopeResultTable_t* results, bool first, wxEvtHandler* owner);
 
 public:
     CscopeDbBuilderThread();
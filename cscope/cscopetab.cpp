@@ -78,7 +78,8 @@ void CscopeTab::Clear()
     m_stc->SetEditable(true);
     m_stc->ClearAll();
     m_stc->SetEditable(false);
-    m_matchesInStc.clear();
+    m_fileMatches.clear();
+    m_insertedItems.clear();
 }
 
 void CscopeTab::BuildTable(CScopeResultTable_t* table)
@@ -87,38 +88,104 @@ void CscopeTab::BuildTable(CScopeResultTable_t* table)
     // Free the old table
     FreeTable();
 
-    m_table = table;
     ClearText();
-    m_matchesInStc.clear();
+    m_fileMatches.clear();
+    m_insertedItems.clear();
     m_styler->SetStyles(m_stc);
+    AppendTable(table);
+}
+
+void CscopeTab::AppendTable(CScopeResultTable_t* table)
+{
+    CHECK_PTR_RET(table);
+    FreeTable();
+    m_table = table;
+
+    // Merge the batch into the view, keeping the files sorted. Both the batch and the view are sorted, so
+    // we walk them together. 'line' is the first line of the section of 'existing'
+    int line = 0;
+    std::map<wxString, std::vector<CscopeEntryData> >::iterator existing = m_fileMatches.begin();
+
+    // Text that goes into the same place is inserted at once
+    wxString text;
+    int textLine = 0;
+    int textLinesCount = 0;
 
-    wxStringSet_t insertedItems;
+    m_stc->SetEditable(true);
     CScopeResultTable_t::iterator iter = m_table->begin();
     for(; iter != m_table->end(); ++iter) {
-        wxString file = iter->first;
+        const wxString& file = iter->first;
+        while(existing != m_fileMatches.end() && existing->first < file) {
+            line += 1 + existing->second.size();
+            ++existing;
+        }
 
-        // Add line for the file
-        AddFile(file);
+        bool isNewFile = (existing == m_fileMatches.end() || existing->first != file);
+        std::vector<CscopeEntryData> matches;
+        wxString fileText;
+
+        // Add line for the file, unless the view already has it
+        if(isNewFile) { fileText << file << "\n"; }
 
         // Add the entries for this file
         CScopeEntryDataVec_t* vec = iter->second;
         for(size_t i = 0; i < vec->size(); ++i) {
-            CscopeEntryData entry = vec->at(i);
+            const CscopeEntryData& entry = vec->at(i);
             // Dont insert duplicate entries to the match view
             wxString display_string;
             display_string << _("Line: ") << entry.GetLine() << wxT(", ") << entry.GetScope() << wxT(", ")
                            << entry.GetPattern();
-            if(insertedItems.count(display_string) == 0) {
-                insertedItems.insert(display_string);
-                int lineno = m_stc->GetLineCount() - 1; // STC line number *before* we add the result
-                AddMatch(entry.GetLine(), entry.GetPattern());
-                m_matchesInStc.insert(std::make_pair(lineno, entry));
+            if(m_insertedItems.insert(display_string).second) {
+                fileText << wxString::Format(wxT(" %5d: "), entry.GetLine()) << entry.GetPattern() << "\n";
+                matches.push_back(entry);
             }
         }
+        if(matches.empty()) { continue; }
+
+        // A new file goes before 'existing', new matches of a known file go at the end of its section
+        int insertLine = isNewFile ? line : (line + 1 + existing->second.size());
+        int linesCount = matches.size() + (isNewFile ? 1 : 0);
+        if(isNewFile) {
+            m_fileMatches.insert({ file, matches });
+            line += linesCount;
+        } else {
+            existing->second.insert(existing->second.end(), matches.begin(), matches.end());
+        }
+
+        if(!text.IsEmpty() && insertLine != textLine + textLinesCount) {
+            m_stc->InsertText(m_stc->PositionFromLine(textLine), text);
+            text.clear();
+        }
+        if(text.IsEmpty()) {
+            textLine = insertLine;
+            textLinesCount = 0;
+        }
+        text << fileText;
+        textLinesCount += linesCount;
     }
+
+    if(!text.IsEmpty()) { m_stc->InsertText(m_stc->PositionFromLine(textLine), text); }
+    m_stc->SetEditable(false);
     FreeTable();
 }
 
+bool CscopeTab::GetEntryAtLine(int line, CscopeEntryData& entry) const
+{
+    int start = 0;
+    std::map<wxString, std::vector<CscopeEntryData> >::const_iterator iter = m_fileMatches.begin();
+    for(; iter != m_fileMatches.end(); ++iter) {
+        int end = start + 1 + iter->second.size();
+        if(line < end) {
+            // The first line of a section is the file name
+            if(line == start) { return false; }
+            entry = iter->second.at(line - start - 1);
+            return true;
+        }
+        start = end;
+    }
+    return false;
+}
+
 void CscopeTab::FreeTable()
 {
     if(m_table) {
@@ -190,21 +257,6 @@ void CscopeTab::ClearText()
     m_stc->SetEditable(false);
 }
 
-void CscopeTab::AddMatch(int line, const wxString& pattern)
-{
-    m_stc->SetEditable(true);
-    wxString linenum = wxString::Format(wxT(" %5d: "), line);
-    m_stc->AppendText(linenum + pattern + "\n");
-    m_stc->SetEditable(false);
-}
-
-void CscopeTab::AddFile(const wxString& filename)
-{
-    m_stc->SetEditable(true);
-    m_stc->AppendText(filename + "\n");
-    m_stc->SetEditable(false);
-}
-
 void CscopeTab::OnHotspotClicked(wxStyledTextEvent& e)
 {
     if(!IsWorkspaceOpen()) { return; }
@@ -216,20 +268,20 @@ void CscopeTab::OnHotspotClicked(wxStyledTextEvent& e)
         m_stc->ToggleFold(clickedLine);
     } else {
         // Open the match
-        std::map<int, CscopeEntryData>::const_iterator iter = m_matchesInStc.find(clickedLine);
-        if(iter != m_matchesInStc.end()) {
+        CscopeEntryData entry;
+        if(GetEntryAtLine(clickedLine, entry)) {
             wxString wsp_path = GetWorkingDirectory();
-            wxFileName fn(iter->second.GetFile());
+            wxFileName fn(entry.GetFile());
             if(!fn.MakeAbsolute(wsp_path)) {
                 clLogMessage(wxT("CScope: failed to convert file to absolute path"));
                 return;
             }
-            m_mgr->OpenFile(fn.GetFullPath(), "", iter->second.GetLine() - 1);
+            m_mgr->OpenFile(fn.GetFullPath(), "", entry.GetLine() - 1);
 
             // In theory this isn't needed as it happened in OpenFile()
             // In practice there's a timing issue: if the file needs to be loaded,
             // the CenterLine() call arrives too soon. So repeat it here, delayed.
-            CallAfter(&CscopeTab::CenterEditorLine, iter->second.GetLine() - 1);
+            CallAfter(&CscopeTab::CenterEditorLine, entry.GetLine() - 1);
         }
     }
 }
@@ -63,7 +63,10 @@ class CscopeTab : public CscopeTabBase
     StringManager m_stringManager;
     wxFont m_font;
     clFindResultsStyler::Ptr_t m_styler;
-    std::map<int, CscopeEntryData> m_matchesInStc;
+    // The matches shown for each file, in the order of the view. Each file takes one
+    // line for its name followed by one line per match
+    std::map<wxString, std::vector<CscopeEntryData> > m_fileMatches;
+    wxStringSet_t m_insertedItems;
 
 protected:
     void FreeTable();
@@ -75,9 +78,8 @@ protected:
     void OnThemeChanged(wxCommandEvent& e);
     void OnHotspotClicked(wxStyledTextEvent& e);
     void ClearText();
-    void AddMatch(int line, const wxString& pattern);
-    void AddFile(const wxString& filename);
     void CenterEditorLine(int lineno);
+    bool GetEntryAtLine(int line, CscopeEntryData& entry) const;
     wxString GetWorkingDirectory() const;
     bool IsWorkspaceOpen() const;
 
@@ -86,7 +88,14 @@ public:
     CscopeTab(wxWindow* parent, IManager* mgr);
     virtual ~CscopeTab();
 
+    /**
+     * @brief replace the displayed results with 'table'. Takes ownership of the table
+     */
     void BuildTable(CScopeResultTable_t* table);
+    /**
+     * @brief add more results of the current query. Takes ownership of the table
+     */
+    void AppendTable(CScopeResultTable_t* table);
     void Clear();
     void SetMessage(const wxString& msg, int percent);
 
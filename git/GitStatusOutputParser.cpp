@@ -0,0 +1,101 @@
+#include "GitStatusOutputParser.h"
+#include <wx/filename.h>
+#include <wx/tokenzr.h>
+
+GitStatusOutputParser::GitStatusOutputParser() {}
+
+GitStatusOutputParser::~GitStatusOutputParser() {}
+
+void GitStatusOutputParser::ParseStatus(const wxString& output, const wxString& repoDir, wxStringSet_t& modified,
+                                        wxStringSet_t& conflicted) const
+{
+    // The porcelain v2 format:
+    // 1 <XY> <sub> <mH> <mI> <mW> <hH> <hI> <path>
+    // 2 <XY> <sub> <mH> <mI> <mW> <hH> <hI> <X><score> <path><TAB><origPath>
+    // u <XY> <sub> <m1> <m2> <m3> <mW> <h1> <h2> <h3> <path>
+    // ? <path>
+    // The number of fields before the path depends on the entry type
+    wxArrayString lines = wxStringTokenize(output, "\n", wxTOKEN_STRTOK);
+    for(size_t i = 0; i < lines.size(); ++i) {
+        const wxString& line = lines.Item(i);
+        if(line.length() < 2 || line[1] != ' ') { continue; }
+
+        size_t fieldsCount = 0;
+        switch((wxChar)line[0]) {
+        case '1':
+            fieldsCount = 8;
+            break;
+        case '2':
+            fieldsCount = 9;
+            break;
+        case 'u':
+            fieldsCount = 10;
+            break;
+        default:
+            // untracked / ignored / headers
+            continue;
+        }
+
+        size_t pos = 0;
+        for(size_t field = 0; field < fieldsCount && pos != wxString::npos; ++field) {
+            pos = line.find(' ', pos);
+            if(pos != wxString::npos) { ++pos; }
+        }
+        if(pos == wxString::npos || pos >= line.length()) { continue; }
+
+        wxString path = line.Mid(pos);
+        // Renamed entries: keep the new name only
+        if(line[0] == '2') { path = path.BeforeFirst('\t'); }
+
+        path = MakeAbsolute(Unquote(path), repoDir);
+        if(line[0] == 'u') {
+            conflicted.insert(path);
+        } else {
+            modified.insert(path);
+        }
+    }
+}
+
+void GitStatusOutputParser::ParseFileList(const wxString& output, const wxString& repoDir, wxStringSet_t& files) const
+{
+    wxArrayString lines = wxStringTokenize(output, "\n", wxTOKEN_STRTOK);
+    files.reserve(lines.size());
+    for(size_t i = 0; i < lines.size(); ++i) {
+        files.insert(MakeAbsolute(Unquote(lines.Item(i)), repoDir));
+    }
+}
+
+wxString GitStatusOutputParser::MakeAbsolute(const wxString& path, const wxString& repoDir) const
+{
+    wxFileName fn(path);
+    fn.MakeAbsolute(repoDir);
+    return fn.GetFullPath();
+}
+
+wxString GitStatusOutputParser::Unquote(const wxString& path) const
+{
+    // git quotes paths with "unusual" characters C-style. Non ASCII characters
+    // are not escaped since we run git with core.quotepath=false
+    if(path.length() < 2 || !path.StartsWith("\"") || !path.EndsWith("\"")) { return path; }
+
+    wxString unquoted;
+    unquoted.reserve(path.length());
+    for(size_t i = 1; i < path.length() - 1; ++i) {
+        wxChar ch = path[i];
+        if(ch == '\\' && (i + 1) < (path.length() - 1)) {
+            ch = path[++i];
+            switch(ch) {
+            case 't':
+                ch = '\t';
+                break;
+            case 'n':
+                ch = '\n';
+                break;
+            default:
+                break;
+            }
+        }
+        unquoted << ch;
+    }
+    return unquoted;
+}
@@ -0,0 +1,34 @@
+#ifndef GITSTATUSOUTPUTPARSER_H
+#define GITSTATUSOUTPUTPARSER_H
+
+#include "macros.h"
+#include <wx/string.h>
+
+class GitStatusOutputParser
+{
+public:
+    GitStatusOutputParser();
+    virtual ~GitStatusOutputParser();
+
+    /**
+     * @brief parse the output of 'git status --porcelain=v2' and collect the
+     * changed files (full paths)
+     * @param output the command output
+     * @param repoDir the repository directory, used to make the paths absolute
+     * @param modified [output] files that are added, modified, deleted or renamed
+     * @param conflicted [output] files with merge conflicts
+     */
+    void ParseStatus(const wxString& output, const wxString& repoDir, wxStringSet_t& modified,
+                     wxStringSet_t& conflicted) const;
+
+    /**
+     * @brief parse the output of 'git ls-files' and return the files (full paths)
+     */
+    void ParseFileList(const wxString& output, const wxString& repoDir, wxStringSet_t& files) const;
+
+protected:
+    wxString MakeAbsolute(const wxString& path, const wxString& repoDir) const;
+    wxString Unquote(const wxString& path) const;
+};
+
+#endif // GITSTATUSOUTPUTPARSER_H
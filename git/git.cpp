@@ -48,6 +48,7 @@
 #include "DiffSideBySidePanel.h"
 #include "GitApplyPatchDlg.h"
 #include "GitConsole.h"
+#include "GitStatusOutputParser.h"
 #include "GitLocator.h"
 #include "GitUserEmailDialog.h"
 #include "bitmap_loader.h"
@@ -126,6 +127,8 @@ GitPlugin::GitPlugin(IManager* manager)
     , m_commitListDlg(NULL)
     , m_commandProcessor(NULL)
     , m_gitBlameDlg(NULL)
+    , m_listThread(NULL)
+    , m_listGeneration(0)
 {
     m_longName = _("GIT plugin");
     m_shortName = wxT("Git");
@@ -153,6 +156,7 @@ GitPlugin::GitPlugin(IManager* manager)
     EventNotifier::Get()->Bind(wxEVT_ACTIVE_PROJECT_CHANGED, &GitPlugin::OnActiveProjectChanged, this);
     EventNotifier::Get()->Bind(wxEVT_CODELITE_MAINFRAME_GOT_FOCUS, &GitPlugin::OnAppActivated, this);
     EventNotifier::Get()->Bind(wxEVT_FILES_MODIFIED_REPLACE_IN_FILES, &GitPlugin::OnReplaceInFiles, this);
+    m_mgr->GetWorkspaceTree()->Bind(wxEVT_TREE_ITEM_EXPANDED, &GitPlugin::OnWorkspaceTreeItemExpanded, this);
 
     wxTheApp->Bind(wxEVT_MENU, &GitPlugin::OnFolderPullRebase, this, XRCID("git_pull_rebase_folder"));
     wxTheApp->Bind(wxEVT_MENU, &GitPlugin::OnFolderCommit, this, XRCID("git_commit_folder"));
@@ -423,6 +427,8 @@ void GitPlugin::UnPlug()
     EventNotifier::Get()->Unbind(wxEVT_ACTIVE_PROJECT_CHANGED, &GitPlugin::OnActiveProjectChanged, this);
     EventNotifier::Get()->Unbind(wxEVT_CODELITE_MAINFRAME_GOT_FOCUS, &GitPlugin::OnAppActivated, this);
     EventNotifier::Get()->Unbind(wxEVT_FILES_MODIFIED_REPLACE_IN_FILES, &GitPlugin::OnReplaceInFiles, this);
+    m_mgr->GetWorkspaceTree()->Unbind(wxEVT_TREE_ITEM_EXPANDED, &GitPlugin::OnWorkspaceTreeItemExpanded, this);
+    StopListThread();
 
     /*Context Menu*/
     m_eventHandler->Disconnect(XRCID("git_add_file"), wxEVT_COMMAND_MENU_SELECTED,
@@ -847,24 +853,19 @@ void GitPlugin::OnListModified(wxCommandEvent& e)
 {
     wxUnusedVar(e);
     wxArrayString choices;
-    std::map<wxString, wxTreeItemId>::const_iterator it;
-
-    // First get a map of the filepaths/treeitemids of modified files
-    std::map<wxString, wxTreeItemId> modifiedIDs;
-    CreateFilesTreeIDsMap(modifiedIDs, true);
-
-    for(it = modifiedIDs.begin(); it != modifiedIDs.end(); ++it) {
-        if(it->second.IsOk()) choices.Add(it->first);
+    for(const wxString& filename : m_modifiedFiles) {
+        if(!m_mgr->GetWorkspaceTreeFileItems(filename).IsEmpty()) { choices.Add(filename); }
     }
 
     if(choices.GetCount() == 0) return;
+    choices.Sort();
 
     wxString choice = wxGetSingleChoice(_("Jump to modified file"), _("Modified files"), choices, m_topWindow);
     if(!choice.IsEmpty()) {
-        wxTreeItemId id = modifiedIDs[choice];
-        if(id.IsOk()) {
-            m_mgr->GetWorkspaceTree()->EnsureVisible(id);
-            m_mgr->GetWorkspaceTree()->SelectItem(id);
+        wxArrayTreeItemIds items = m_mgr->GetWorkspaceTreeFileItems(choice);
+        if(!items.IsEmpty()) {
+            m_mgr->GetWorkspaceTree()->EnsureVisible(items.Item(0));
+            m_mgr->GetWorkspaceTree()->SelectItem(items.Item(0));
         }
     }
 }
@@ -961,21 +962,14 @@ void GitPlugin::OnBisectReset(wxCommandEvent& e)
 void GitPlugin::OnFileSaved(clCommandEvent& e)
 {
     e.Skip();
-    std::map<wxString, wxTreeItemId>::const_iterator it;
-
-    // First get an up to date map of the filepaths/treeitemids of modified files
-    // (Trying to cache these results in segfaults when the tree has been modified)
-    std::map<wxString, wxTreeItemId> modifiedIDs;
-    CreateFilesTreeIDsMap(modifiedIDs, true);
 
-    for(it = modifiedIDs.begin(); it != modifiedIDs.end(); ++it) {
-        if(!it->second.IsOk()) {
-            GIT_MESSAGE(wxT("Stored item not found in tree, rebuilding item IDs"));
-            gitAction ga(gitListAll, wxT(""));
-            m_gitActionQueue.push_back(ga);
-            break;
+    // Mark the saved file as modified right away, 'git status' will tell us if it really is
+    const wxString& filename = e.GetString();
+    if(m_trackedFiles.count(filename) && !m_modifiedFiles.count(filename)) {
+        wxArrayTreeItemIds items = m_mgr->GetWorkspaceTreeFileItems(filename);
+        for(size_t i = 0; i < items.size(); ++i) {
+            DoSetTreeItemImage(m_mgr->GetWorkspaceTree(), items.Item(i), OverlayTool::Bmp_Modified);
         }
-        DoSetTreeItemImage(m_mgr->GetWorkspaceTree(), it->second, OverlayTool::Bmp_Modified);
     }
 
     gitAction ga(gitListModified, wxT(""));
@@ -1088,13 +1082,13 @@ void GitPlugin::ProcessGitActionQueue()
 
     case gitListAll:
         GIT_MESSAGE1(wxT("Listing files in git repository"));
-        command << wxT(" --no-pager ls-files");
+        command << wxT(" --no-pager -c core.quotepath=false ls-files");
         GIT_MESSAGE1(wxT("%s. Repo path: %s"), command.c_str(), m_repositoryDirectory.c_str());
         break;
 
     case gitListModified:
         GIT_MESSAGE1(wxT("Listing modified files in git repository"));
-        command << wxT(" --no-pager ls-files -m");
+        command << wxT(" --no-pager -c core.quotepath=false status --porcelain=v2 --untracked-files=no");
         GIT_MESSAGE1(wxT("%s. Repo path: %s"), command.c_str(), m_repositoryDirectory.c_str());
         break;
 
@@ -1302,58 +1296,124 @@ void GitPlugin::ProcessGitActionQueue()
 /*******************************************************************************/
 void GitPlugin::FinishGitListAction(const gitAction& ga)
 {
+    if(ga.action != gitListAll && ga.action != gitListModified) return;
+
     clConfig conf("git.conf");
     GitEntry data;
     conf.ReadItem(&data);
 
     if(!(data.GetFlags() & GitEntry::Git_Colour_Tree_View)) return;
 
-    wxArrayString tmpArray = wxStringTokenize(m_commandOutput, wxT("\n"), wxTOKEN_STRTOK);
-
-    // Convert path to absolute
-    for(unsigned i = 0; i < tmpArray.GetCount(); ++i) {
-        wxFileName fname(tmpArray[i]);
-        fname.MakeAbsolute(m_repositoryDirectory);
-        tmpArray[i] = fname.GetFullPath();
-    }
-
-    // convert the array to set for performance
-    wxStringSet_t gitFileSet;
-    gitFileSet.insert(tmpArray.begin(), tmpArray.end());
-
-    if(ga.action == gitListAll) {
-        m_mgr->SetStatusMessage(_("Colouring tracked git files..."), 0);
-        ColourFileTree(m_mgr->GetWorkspaceTree(), gitFileSet, OverlayTool::Bmp_OK);
-        m_trackedFiles.swap(gitFileSet);
-
-    } else if(ga.action == gitListModified) {
-        m_mgr->SetStatusMessage(_("Colouring modified git files..."), 0);
-        // Reset modified files
-        ColourFileTree(m_mgr->GetWorkspaceTree(), m_modifiedFiles, OverlayTool::Bmp_OK);
-        // First get an up to date map of the filepaths/treeitemids
-        // (Trying to cache these results in segfaults when the tree has been modified)
-        std::map<wxString, wxTreeItemId> IDs;
-        CreateFilesTreeIDsMap(IDs);
-
-        // Now filter using the list of modified files, gitFileList, to find which IDs to colour differently
-        wxStringSet_t toColour;
-        wxStringSet_t::const_iterator iter = gitFileSet.begin();
-        for(; iter != gitFileSet.end(); ++iter) {
-            wxTreeItemId id = IDs[(*iter)];
-            if(id.IsOk()) {
-                DoSetTreeItemImage(m_mgr->GetWorkspaceTree(), id, OverlayTool::Bmp_Modified);
+    // Parse the output on a worker thread, the results are applied in OnGitListParsed()
+    StopListThread();
+    size_t generation = m_listGeneration;
+    int action = ga.action;
+    wxString output = m_commandOutput;
+    wxString repoDir = m_repositoryDirectory;
+    m_listThread = new std::thread([=]() {
+        GitStatusOutputParser parser;
+        GitListResult result;
+        result.generation = generation;
+        result.action = action;
+        if(action == gitListAll) {
+            parser.ParseFileList(output, repoDir, result.files);
+        } else {
+            parser.ParseStatus(output, repoDir, result.files, result.conflicted);
+        }
+        CallAfter(&GitPlugin::OnGitListParsed, result);
+    });
+}
+
+void GitPlugin::OnGitListParsed(const GitListResult& result)
+{
+    // The repository was changed / closed since this list was requested
+    if(result.generation != m_listGeneration) return;
 
-            } else {
-                toColour.insert(*iter);
-            }
+    const wxStringSet_t& files = result.files;
+    const wxStringSet_t& conflicted = result.conflicted;
+    if(result.action == gitListAll) {
+        // Only files that are now tracked need a new overlay
+        wxStringSet_t newFiles;
+        for(const wxString& filename : files) {
+            if(!m_trackedFiles.count(filename) && !m_modifiedFiles.count(filename)) { newFiles.insert(filename); }
+        }
+        m_trackedFiles = files;
+        DoSetFilesImage(newFiles, OverlayTool::Bmp_OK);
+
+    } else {
+        // Diff the new status against the previous one and update only the files that changed
+        wxStringSet_t reverted;
+        wxStringSet_t modified;
+        wxStringSet_t conflicts;
+        for(const wxString& filename : m_modifiedFiles) {
+            if(!files.count(filename) && !conflicted.count(filename)) { reverted.insert(filename); }
+        }
+        for(const wxString& filename : files) {
+            if(!m_modifiedFiles.count(filename) || m_conflictedFiles.count(filename)) { modified.insert(filename); }
         }
+        for(const wxString& filename : conflicted) {
+            if(!m_conflictedFiles.count(filename)) { conflicts.insert(filename); }
+        }
+
+        // Cache the modified-files list: it's used in other functions
+        m_modifiedFiles = files;
+        m_modifiedFiles.insert(conflicted.begin(), conflicted.end());
+        m_conflictedFiles = conflicted;
+
+        DoSetFilesImage(reverted, OverlayTool::Bmp_OK);
+        DoSetFilesImage(modified, OverlayTool::Bmp_Modified);
+        DoSetFilesImage(conflicts, OverlayTool::Bmp_Conflict);
+    }
+}
+
+void GitPlugin::DoSetFilesImage(const wxStringSet_t& files, OverlayTool::BmpType bmpType) const
+{
+    for(const wxString& filename : files) {
+        wxArrayTreeItemIds items = m_mgr->GetWorkspaceTreeFileItems(filename);
+        for(size_t i = 0; i < items.size(); ++i) {
+            DoSetTreeItemImage(m_mgr->GetWorkspaceTree(), items.Item(i), bmpType);
+        }
+    }
+}
 
-        if(!toColour.empty()) { ColourFileTree(m_mgr->GetWorkspaceTree(), toColour, OverlayTool::Bmp_Modified); }
+OverlayTool::BmpType GitPlugin::DoGetFileBmpType(const wxString& filename) const
+{
+    if(m_conflictedFiles.count(filename)) {
+        return OverlayTool::Bmp_Conflict;
+    } else if(m_modifiedFiles.count(filename)) {
+        return OverlayTool::Bmp_Modified;
+    } else if(m_trackedFiles.count(filename)) {
+        return OverlayTool::Bmp_OK;
+    }
+    return OverlayTool::Bmp_NoChange;
+}
 
-        // Finally, cache the modified-files list: it's used in other functions
-        m_modifiedFiles.swap(gitFileSet);
+void GitPlugin::StopListThread()
+{
+    // The thread only parses a string, joining it is cheap
+    if(m_listThread) {
+        m_listThread->join();
+        wxDELETE(m_listThread);
+    }
+}
+
+void GitPlugin::OnWorkspaceTreeItemExpanded(wxTreeEvent& e)
+{
+    e.Skip();
+    if(m_repositoryDirectory.IsEmpty()) return;
+
+    // The file view creates the children of a folder when it is expanded, set their overlays now
+    clTreeCtrl* tree = m_mgr->GetWorkspaceTree();
+    wxTreeItemIdValue cookie;
+    wxTreeItemId child = tree->GetFirstChild(e.GetItem(), cookie);
+    while(child.IsOk()) {
+        FilewViewTreeItemData* data = static_cast<FilewViewTreeItemData*>(tree->GetItemData(child));
+        if(data && data->GetData().IsFile()) {
+            OverlayTool::BmpType bmpType = DoGetFileBmpType(data->GetData().GetFile());
+            if(bmpType != OverlayTool::Bmp_NoChange) { DoSetTreeItemImage(tree, child, bmpType); }
+        }
+        child = tree->GetNextChild(e.GetItem(), cookie);
     }
-    m_mgr->SetStatusMessage("", 0);
 }
 
 /*******************************************************************************/
@@ -1876,71 +1936,6 @@ void GitPlugin::AddDefaultActions()
     m_gitActionQueue.push_back(ga);
 }
 
-/*******************************************************************************/
-void GitPlugin::ColourFileTree(clTreeCtrl* tree, const wxStringSet_t& files, OverlayTool::BmpType bmpType) const
-{
-    clConfig conf("git.conf");
-    GitEntry data;
-    conf.ReadItem(&data);
-
-    if(!(data.GetFlags() & GitEntry::Git_Colour_Tree_View)) return;
-
-    std::stack<wxTreeItemId> items;
-    if(tree->GetRootItem().IsOk()) items.push(tree->GetRootItem());
-
-    while(!items.empty()) {
-        wxTreeItemId next = items.top();
-        items.pop();
-
-        if(next != tree->GetRootItem()) {
-            FilewViewTreeItemData* data = static_cast<FilewViewTreeItemData*>(tree->GetItemData(next));
-            const wxString& path = data->GetData().GetFile();
-            if(!path.IsEmpty() && files.count(path)) { DoSetTreeItemImage(tree, next, bmpType); }
-        }
-
-        wxTreeItemIdValue cookie;
-        wxTreeItemId nextChild = tree->GetFirstChild(next, cookie);
-        while(nextChild.IsOk()) {
-            items.push(nextChild);
-            nextChild = tree->GetNextSibling(nextChild);
-        }
-    }
-}
-
-/*******************************************************************************/
-
-void GitPlugin::CreateFilesTreeIDsMap(std::map<wxString, wxTreeItemId>& IDs, bool ifmodified /*=false*/) const
-{
-    clTreeCtrl* tree = m_mgr->GetWorkspaceTree();
-    if(!tree) { return; }
-
-    IDs.clear();
-
-    std::stack<wxTreeItemId> items;
-    if(tree->GetRootItem().IsOk()) items.push(tree->GetRootItem());
-
-    while(!items.empty()) {
-        wxTreeItemId next = items.top();
-        items.pop();
-
-        if(next != tree->GetRootItem()) {
-            FilewViewTreeItemData* data = static_cast<FilewViewTreeItemData*>(tree->GetItemData(next));
-            const wxString& path = data->GetData().GetFile();
-            if(!path.IsEmpty()) {
-                // If m_modifiedFiles has already been filled, only include files listed there
-                if(!ifmodified || m_modifiedFiles.count(path)) { IDs[path] = next; }
-            }
-        }
-
-        wxTreeItemIdValue cookie;
-        wxTreeItemId nextChild = tree->GetFirstChild(next, cookie);
-        while(nextChild.IsOk()) {
-            items.push(nextChild);
-            nextChild = tree->GetNextSibling(nextChild);
-        }
-    }
-}
-
 /*******************************************************************************/
 void GitPlugin::OnProgressTimer(wxTimerEvent& Event)
 {
@@ -1985,7 +1980,11 @@ void GitPlugin::DoCleanup()
     m_remoteBranchList.Clear();
     m_trackedFiles.clear();
     m_modifiedFiles.clear();
+    m_conflictedFiles.clear();
     m_addedFiles = false;
+    // Drop any list results that are still on their way
+    ++m_listGeneration;
+    StopListThread();
     m_progressMessage.Clear();
     m_commandOutput.Clear();
     m_bActionRequiresTreUpdate = false;
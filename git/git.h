@@ -50,6 +50,8 @@
 #include "gitui.h"
 #include <vector>
 #include "clTabTogglerHelper.h"
+#include <thread>
+#include <wx/treebase.h>
 
 class clTreeCtrl;
 class clCommandProcessor;
@@ -103,6 +105,14 @@ class GitPlugin : public IPlugin
     friend class GitCommitDlg;
 
     typedef std::map<int, int> IntMap_t;
+
+    // The parsed output of gitListAll / gitListModified
+    struct GitListResult {
+        size_t generation = 0;
+        int action = 0;
+        wxStringSet_t files;
+        wxStringSet_t conflicted;
+    };
     enum {
         gitNone = 0,
         gitUpdateRemotes,
@@ -145,6 +155,7 @@ class GitPlugin : public IPlugin
     wxArrayString m_remoteBranchList;
     wxStringSet_t m_trackedFiles;
     wxStringSet_t m_modifiedFiles;
+    wxStringSet_t m_conflictedFiles;
     bool m_addedFiles;
     wxArrayString m_remotes;
     wxColour m_colourTrackedFile;
@@ -173,6 +184,8 @@ class GitPlugin : public IPlugin
     clCommandProcessor* m_commandProcessor;
     clTabTogglerHelper::Ptr_t m_tabToggler;
     GitBlameDlg* m_gitBlameDlg;
+    std::thread* m_listThread;
+    size_t m_listGeneration;
 
 private:
     void DoCreateTreeImages();
@@ -185,8 +198,9 @@ private:
     void AddDefaultActions();
     void LoadDefaultGitCommands(GitEntry& data, bool overwrite = false);
     void ProcessGitActionQueue();
-    void ColourFileTree(clTreeCtrl* tree, const wxStringSet_t& files, OverlayTool::BmpType bmpType) const;
-    void CreateFilesTreeIDsMap(std::map<wxString, wxTreeItemId>& IDs, bool ifmodified = false) const;
+    void DoSetFilesImage(const wxStringSet_t& files, OverlayTool::BmpType bmpType) const;
+    OverlayTool::BmpType DoGetFileBmpType(const wxString& filename) const;
+    void StopListThread();
     void DoShowCommitDialog(const wxString& diff, wxString& commitArgs);
     void DoRefreshView(bool ensureVisible);
 
@@ -196,6 +210,7 @@ private:
     wxFileName GetWorkspaceFileName() const;
 
     void FinishGitListAction(const gitAction& ga);
+    void OnGitListParsed(const GitListResult& result);
     void ListBranchAction(const gitAction& ga);
     void GetCurrentBranchAction(const gitAction& ga);
     void UpdateFileTree();
@@ -223,6 +238,7 @@ private:
     void OnFileCreated(clFileSystemEvent& event);
     void OnReplaceInFiles(clFileSystemEvent& event);
     void OnFileSaved(clCommandEvent& e);
+    void OnWorkspaceTreeItemExpanded(wxTreeEvent& e);
     void OnFilesAddedToProject(clCommandEvent& e);
     void OnFilesRemovedFromProject(clCommandEvent& e);
     void OnWorkspaceLoaded(wxCommandEvent& e);